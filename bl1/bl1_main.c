@@ -10,6 +10,7 @@
 #include <auth_mod.h>
 #include <bl1.h>
 #include <bl_common.h>
+#include <boot_profile.h>
 #include <console.h>
 #include <debug.h>
 #include <errata_report.h>
@@ -80,6 +81,9 @@ void bl1_main(void)
 {
 	unsigned int image_id;
 
+	boot_profile_init();
+	BOOT_PROFILE_MARK("bl1_main");
+
 	/* Announce our arrival */
 	NOTICE(FIRMWARE_WELCOME_STR);
 	NOTICE("BL1: %s\n", version_string);
@@ -120,15 +124,21 @@ void bl1_main(void)
 #endif /* ENABLE_ASSERTIONS */
 
 	/* Perform remaining generic architectural setup from EL3 */
+	BOOT_PROFILE_BEGIN("arch_setup", 0);
 	bl1_arch_setup();
+	BOOT_PROFILE_END("arch_setup", 0);
 
 #if TRUSTED_BOARD_BOOT
 	/* Initialize authentication module */
+	BOOT_PROFILE_BEGIN("auth_mod_init", 0);
 	auth_mod_init();
+	BOOT_PROFILE_END("auth_mod_init", 0);
 #endif /* TRUSTED_BOARD_BOOT */
 
 	/* Perform platform setup in BL1. */
+	BOOT_PROFILE_BEGIN("platform_setup", 0);
 	bl1_platform_setup();
+	BOOT_PROFILE_END("platform_setup", 0);
 
 	/* Get the image id of next image to load and run. */
 	image_id = bl1_plat_get_next_image_id();
@@ -137,14 +147,19 @@ void bl1_main(void)
 	 * We currently interpret any image id other than
 	 * BL2_IMAGE_ID as the start of firmware update.
 	 */
-	if (image_id == BL2_IMAGE_ID)
+	if (image_id == BL2_IMAGE_ID) {
+		BOOT_PROFILE_BEGIN("load_bl2", BL2_IMAGE_ID);
 		bl1_load_bl2();
-	else
+		BOOT_PROFILE_END("load_bl2", BL2_IMAGE_ID);
+	} else {
 		NOTICE("BL1-FWU: *******FWU Process Started*******\n");
+	}
 
 	bl1_prepare_next_image(image_id);
 
 	console_flush();
+
+	BOOT_PROFILE_MARK("bl1_exit");
 }
 
 /*******************************************************************************
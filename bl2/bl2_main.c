@@ -8,6 +8,7 @@
 #include <auth_mod.h>
 #include <bl1.h>
 #include <bl_common.h>
+#include <boot_profile.h>
 #include <console.h>
 #include <debug.h>
 #include <platform.h>
@@ -23,22 +24,35 @@ void bl2_main(void)
 {
 	entry_point_info_t *next_bl_ep_info;
 
+	boot_profile_init();
+	BOOT_PROFILE_MARK("bl2_main");
+
 	NOTICE("BL2: %s\n", version_string);
 	NOTICE("BL2: %s\n", build_message);
 
 	/* Perform remaining generic architectural setup in S-EL1 */
+	BOOT_PROFILE_BEGIN("arch_setup", 0);
 	bl2_arch_setup();
+	BOOT_PROFILE_END("arch_setup", 0);
 
 #if TRUSTED_BOARD_BOOT
 	/* Initialize authentication module */
+	BOOT_PROFILE_BEGIN("auth_mod_init", 0);
 	auth_mod_init();
+	BOOT_PROFILE_END("auth_mod_init", 0);
 #endif /* TRUSTED_BOARD_BOOT */
 
 	/* initialize boot source */
+	BOOT_PROFILE_BEGIN("preload_setup", 0);
 	bl2_plat_preload_setup();
+	BOOT_PROFILE_END("preload_setup", 0);
 
 	/* Load the subsequent bootloader images. */
+	BOOT_PROFILE_BEGIN("load_images", 0);
 	next_bl_ep_info = bl2_load_images();
+	BOOT_PROFILE_END("load_images", 0);
+
+	BOOT_PROFILE_MARK("bl2_exit");
 
 #ifdef AARCH32
 	/*
@@ -21,6 +21,18 @@ ifeq (${ENABLE_PMF}, 1)
 BL31_SOURCES		+=	lib/pmf/pmf_main.c
 endif
 
+ifeq (${ENABLE_PMU_INSTRUMENTATION}, 1)
+BL31_SOURCES		+=	lib/pmu_instr/pmu_instr.c
+endif
+
+ifeq (${EL3_IPI}, 1)
+BL31_SOURCES		+=	bl31/el3_ipi.c
+endif
+
+ifeq (${EL3_TIMER}, 1)
+BL31_SOURCES		+=	bl31/el3_timer.c
+endif
+
 BL31_LINKERFILE		:=	bl31/bl31.ld.S
 
 # Flag used to indicate if Crash reporting via console should be included
@@ -9,9 +9,12 @@
 #include <assert.h>
 #include <bl31.h>
 #include <bl_common.h>
+#include <boot_profile.h>
 #include <console.h>
 #include <context_mgmt.h>
 #include <debug.h>
+#include <el3_ipi.h>
+#include <el3_timer.h>
 #include <platform.h>
 #include <pmf.h>
 #include <runtime_instr.h>
@@ -70,18 +73,35 @@ void bl31_lib_init(void)
  ******************************************************************************/
 void bl31_main(void)
 {
+	boot_profile_init();
+	BOOT_PROFILE_MARK("bl31_main");
+
 	NOTICE("BL31: %s\n", version_string);
 	NOTICE("BL31: %s\n", build_message);
 
 	/* Perform platform setup in BL31 */
+	BOOT_PROFILE_BEGIN("platform_setup", 0);
 	bl31_platform_setup();
+	BOOT_PROFILE_END("platform_setup", 0);
+
+#if EL3_IPI
+	/* Handle the inter-processor calls now that the GIC is set up */
+	el3_ipi_init();
+#endif
+
+#if EL3_TIMER
+	/* Handle the secure physical timer interrupt */
+	el3_timer_init();
+#endif
 
 	/* Initialise helper libraries */
 	bl31_lib_init();
 
 	/* Initialize the runtime services e.g. psci. */
 	INFO("BL31: Initializing runtime services\n");
+	BOOT_PROFILE_BEGIN("runtime_svc_init", 0);
 	runtime_svc_init();
+	BOOT_PROFILE_END("runtime_svc_init", 0);
 
 	/*
 	 * All the cold boot actions on the primary cpu are done. We now need to
@@ -98,7 +118,9 @@ void bl31_main(void)
 	 */
 	if (bl32_init) {
 		INFO("BL31: Initializing BL32\n");
+		BOOT_PROFILE_BEGIN("bl32_init", 0);
 		(*bl32_init)();
+		BOOT_PROFILE_END("bl32_init", 0);
 	}
 	/*
 	 * We are ready to enter the next EL. Prepare entry into the image
@@ -113,6 +135,8 @@ void bl31_main(void)
 	 * from BL31
 	 */
 	bl31_plat_runtime_setup();
+
+	BOOT_PROFILE_MARK("bl31_exit");
 }
 
 /*******************************************************************************
@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <arch_helpers.h>
+#include <assert.h>
+#include <bl_common.h>
+#include <cassert.h>
+#include <cpu_data.h>
+#include <debug.h>
+#include <el3_ipi.h>
+#include <errno.h>
+#include <interrupt_mgmt.h>
+#include <platform.h>
+#include <platform_def.h>
+#include <psci.h>
+
+/* CPUs are designated by bits in a 64-bit mask */
+CASSERT(PLATFORM_CORE_COUNT <= 64, assert_el3_ipi_core_count);
+
+#define EL3_IPI_ALL_CPUS	((PLATFORM_CORE_COUNT == 64) ? ~0ULL : \
+				 ((1ULL << PLATFORM_CORE_COUNT) - 1))
+
+/*******************************************************************************
+ * Call posted by a CPU to other CPUs. It is only written by the sending CPU,
+ * once the call it posted previously has completed on all its targets.
+ *
+ * 'targets' : Mask of the CPUs the call was posted to.
+ ******************************************************************************/
+typedef struct el3_ipi_req {
+	el3_ipi_func_t func;
+	void *arg;
+	uint64_t targets;
+} __aligned(CACHE_WRITEBACK_GRANULE) el3_ipi_req_t;
+
+/*******************************************************************************
+ * Mailbox of a CPU. 'pending[n]' is set by CPU n once it has posted a call to
+ * this CPU, and cleared by this CPU once the call has returned. Each flag only
+ * has one writer at a time, so no lock is needed.
+ *
+ * 'busy' is set while this CPU runs a call, to reject nested calls.
+ ******************************************************************************/
+typedef struct el3_ipi_mbox {
+	volatile uint8_t pending[PLATFORM_CORE_COUNT];
+	uint8_t busy;
+} __aligned(CACHE_WRITEBACK_GRANULE) el3_ipi_mbox_t;
+
+static el3_ipi_req_t el3_ipi_reqs[PLATFORM_CORE_COUNT];
+static el3_ipi_mbox_t el3_ipi_mboxes[PLATFORM_CORE_COUNT];
+
+/*******************************************************************************
+ * This function runs the calls pending in the mailbox of the calling CPU.
+ ******************************************************************************/
+static void el3_ipi_process(unsigned int my_idx)
+{
+	el3_ipi_mbox_t *mbox = &el3_ipi_mboxes[my_idx];
+	el3_ipi_req_t *req;
+	unsigned int idx;
+
+	for (idx = 0; idx < PLATFORM_CORE_COUNT; idx++) {
+		if (!mbox->pending[idx])
+			continue;
+
+		/* Read the request only after its pending flag */
+		dmbish();
+		req = &el3_ipi_reqs[idx];
+
+		mbox->busy = 1;
+		req->func(req->arg);
+		mbox->busy = 0;
+
+		/* Make the effects of the call visible before completing it */
+		dmbish();
+		mbox->pending[idx] = 0;
+	}
+}
+
+/*******************************************************************************
+ * This function waits until the call last posted by the calling CPU has
+ * completed on all its targets. As interrupts are masked in EL3, it runs the
+ * calls posted to the calling CPU meanwhile, so that two CPUs calling each
+ * other can't deadlock.
+ ******************************************************************************/
+static void el3_ipi_wait(unsigned int my_idx)
+{
+	uint64_t targets = el3_ipi_reqs[my_idx].targets;
+	unsigned int idx;
+
+	for (idx = 0; targets != 0; idx++, targets >>= 1) {
+		if (!(targets & 1))
+			continue;
+
+		while (el3_ipi_mboxes[idx].pending[my_idx])
+			el3_ipi_process(my_idx);
+	}
+
+	/* Observe the effects of the calls after their completion */
+	dmbish();
+}
+
+/*******************************************************************************
+ * Handler of the SGI used to signal a CPU that calls are pending for it.
+ ******************************************************************************/
+static uint64_t el3_ipi_handler(uint32_t id,
+				uint32_t flags,
+				void *handle,
+				void *cookie)
+{
+	assert(id == PLAT_EL3_IPI_SGI);
+
+	el3_ipi_process(plat_my_core_pos());
+
+	return 0;
+}
+
+/*******************************************************************************
+ * This function calls 'func' with 'arg' on each CPU of 'cpu_mask', which is a
+ * mask of linear CPU indices. The calling CPU runs the function directly if it
+ * is in the mask. The other CPUs are signalled with the SGI PLAT_EL3_IPI_SGI
+ * and run it from EL3 interrupt context. They must be on and stay on until
+ * they have run the function.
+ *
+ * If 'flags' contains EL3_IPI_WAIT, this function returns once all the target
+ * CPUs have run the function. Otherwise it returns once the function has been
+ * posted. The next call made by the same CPU waits for it to complete, so
+ * 'arg' only needs to remain valid until then.
+ *
+ * The function is called with interrupts masked and must not make calls
+ * itself. Returns 0 on success, -EINVAL for invalid parameters or a target
+ * CPU which is not on, and -EBUSY if called from a called function.
+ ******************************************************************************/
+int el3_ipi_call_mask(uint64_t cpu_mask, el3_ipi_func_t func, void *arg,
+		      unsigned int flags)
+{
+	unsigned int my_idx = plat_my_core_pos();
+	el3_ipi_req_t *req = &el3_ipi_reqs[my_idx];
+	uint64_t targets, mask;
+	unsigned int idx;
+
+	if (!func || !cpu_mask || (cpu_mask & ~EL3_IPI_ALL_CPUS) ||
+			(flags & ~EL3_IPI_WAIT))
+		return -EINVAL;
+
+	if (el3_ipi_mboxes[my_idx].busy)
+		return -EBUSY;
+
+	targets = cpu_mask & ~(1ULL << my_idx);
+	for (idx = 0, mask = targets; mask != 0; idx++, mask >>= 1) {
+		if (!(mask & 1))
+			continue;
+
+		if ((psci_get_cpu_mpidr_by_index(idx) == PSCI_INVALID_MPIDR) ||
+				(get_cpu_data_by_index(idx,
+					psci_svc_cpu_data.aff_info_state) !=
+					AFF_STATE_ON))
+			return -EINVAL;
+	}
+
+	/* The request can only be reused once the previous call completed */
+	el3_ipi_wait(my_idx);
+
+	req->func = func;
+	req->arg = arg;
+	req->targets = targets;
+
+	/* Publish the request before posting it to the targets */
+	dmbish();
+	for (idx = 0, mask = targets; mask != 0; idx++, mask >>= 1) {
+		if (mask & 1)
+			el3_ipi_mboxes[idx].pending[my_idx] = 1;
+	}
+
+	/* Raising the SGI orders the mailbox writes before the signal */
+	for (idx = 0, mask = targets; mask != 0; idx++, mask >>= 1) {
+		if (mask & 1)
+			plat_ic_raise_el3_sgi(PLAT_EL3_IPI_SGI,
+					psci_get_cpu_mpidr_by_index(idx));
+	}
+
+	if (cpu_mask & (1ULL << my_idx)) {
+		el3_ipi_mboxes[my_idx].busy = 1;
+		func(arg);
+		el3_ipi_mboxes[my_idx].busy = 0;
+	}
+
+	if (flags & EL3_IPI_WAIT)
+		el3_ipi_wait(my_idx);
+
+	return 0;
+}
+
+/*******************************************************************************
+ * This function calls 'func' with 'arg' on the CPU with linear index
+ * 'cpu_idx'. See el3_ipi_call_mask().
+ ******************************************************************************/
+int el3_ipi_call(unsigned int cpu_idx, el3_ipi_func_t func, void *arg,
+		 unsigned int flags)
+{
+	if (cpu_idx >= PLATFORM_CORE_COUNT)
+		return -EINVAL;
+
+	return el3_ipi_call_mask(1ULL << cpu_idx, func, arg, flags);
+}
+
+/*******************************************************************************
+ * This function registers the handler of the SGI used by the EL3
+ * inter-processor calls. The platform must have configured PLAT_EL3_IPI_SGI as
+ * an EL3 interrupt. It is routed to EL3 from both security states.
+ ******************************************************************************/
+void el3_ipi_init(void)
+{
+	uint32_t flags = 0;
+	int32_t rc;
+
+	set_interrupt_rm_flag(flags, SECURE);
+	set_interrupt_rm_flag(flags, NON_SECURE);
+
+	rc = register_el3_interrupt_handler(PLAT_EL3_IPI_SGI, el3_ipi_handler,
+					    flags);
+	if (rc) {
+		ERROR("Failed to register the EL3 IPI handler (%d)\n", rc);
+		panic();
+	}
+}
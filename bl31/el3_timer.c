@@ -0,0 +1,317 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <arch_helpers.h>
+#include <assert.h>
+#include <bl_common.h>
+#include <cassert.h>
+#include <debug.h>
+#include <el3_timer.h>
+#include <interrupt_mgmt.h>
+#include <platform.h>
+#include <platform_def.h>
+
+/* Non-empty slots are tracked in a 64-bit mask */
+CASSERT((PLAT_EL3_TIMER_WHEEL_SLOTS <= 64) &&
+	((PLAT_EL3_TIMER_WHEEL_SLOTS & (PLAT_EL3_TIMER_WHEEL_SLOTS - 1)) == 0),
+	assert_el3_timer_wheel_slots);
+
+#define SLOT_MASK		(PLAT_EL3_TIMER_WHEEL_SLOTS - 1)
+#define TICK(cnt)		((cnt) >> PLAT_EL3_TIMER_SLOT_SHIFT)
+#define NO_DEADLINE		(~0ULL)
+
+/*******************************************************************************
+ * Hashed timer wheel of a CPU, multiplexing the timers started on that CPU over
+ * its secure physical timer. A timer expiring at tick 't' of the wheel is kept
+ * in slot 't' modulo the number of slots, so a slot may hold timers due in
+ * later revolutions of the wheel. The wheel is only accessed by its CPU, with
+ * interrupts masked, so no lock is needed.
+ *
+ * 'slots'    : List of timers of each slot.
+ * 'busy'     : Mask of the non-empty slots.
+ * 'tick'     : Tick up to which the expired timers have been processed.
+ * 'next'     : Deadline programmed in the secure physical timer.
+ ******************************************************************************/
+typedef struct el3_timer_wheel {
+	el3_timer_t *slots[PLAT_EL3_TIMER_WHEEL_SLOTS];
+	uint64_t busy;
+	uint64_t tick;
+	uint64_t next;
+} __aligned(CACHE_WRITEBACK_GRANULE) el3_timer_wheel_t;
+
+static el3_timer_wheel_t el3_timer_wheels[PLATFORM_CORE_COUNT];
+
+/*******************************************************************************
+ * Helpers to add a timer to the head of a list, and to remove a timer from the
+ * list it is in. Both are constant time.
+ ******************************************************************************/
+static void el3_timer_link(el3_timer_t **head, el3_timer_t *timer)
+{
+	timer->next = *head;
+	if (timer->next)
+		timer->next->pprev = &timer->next;
+	*head = timer;
+	timer->pprev = head;
+}
+
+static void el3_timer_unlink(el3_timer_t *timer)
+{
+	*timer->pprev = timer->next;
+	if (timer->next)
+		timer->next->pprev = timer->pprev;
+	timer->next = NULL;
+	timer->pprev = NULL;
+}
+
+/*******************************************************************************
+ * Helpers to add a timer to the slot of the wheel where it belongs, and to
+ * remove it. Timers whose deadline is already past go in the slot processed
+ * next.
+ ******************************************************************************/
+static void el3_timer_insert(el3_timer_wheel_t *wheel, el3_timer_t *timer)
+{
+	uint64_t tick = TICK(timer->deadline);
+
+	if (tick < wheel->tick)
+		tick = wheel->tick;
+
+	timer->slot = tick & SLOT_MASK;
+	el3_timer_link(&wheel->slots[timer->slot], timer);
+	wheel->busy |= 1ULL << timer->slot;
+}
+
+static void el3_timer_remove(el3_timer_wheel_t *wheel, el3_timer_t *timer)
+{
+	el3_timer_unlink(timer);
+	if (!wheel->slots[timer->slot])
+		wheel->busy &= ~(1ULL << timer->slot);
+}
+
+/*******************************************************************************
+ * This function programs the secure physical timer of the calling CPU to
+ * expire at 'deadline', or disables it.
+ ******************************************************************************/
+static void el3_timer_program(el3_timer_wheel_t *wheel, uint64_t deadline)
+{
+	uint32_t ctl = 0;
+
+	wheel->next = deadline;
+	if (deadline == NO_DEADLINE) {
+		write_cntps_ctl_el1(0);
+	} else {
+		write_cntps_cval_el1(deadline);
+		set_cntp_ctl_enable(ctl);
+		write_cntps_ctl_el1(ctl);
+	}
+	isb();
+}
+
+/*******************************************************************************
+ * This function returns the earliest deadline of the timers of the wheel. The
+ * slots are visited in the order of the ticks following the last processed
+ * one, so the first slot holding a timer due in the current revolution of the
+ * wheel holds the earliest deadline. Otherwise all the timers are due in later
+ * revolutions and the earliest of them is returned.
+ ******************************************************************************/
+static uint64_t el3_timer_next_deadline(const el3_timer_wheel_t *wheel)
+{
+	uint64_t min = NO_DEADLINE;
+	const el3_timer_t *timer;
+	unsigned int offset, slot;
+	int due = 0;
+
+	for (offset = 0; offset < PLAT_EL3_TIMER_WHEEL_SLOTS; offset++) {
+		slot = (wheel->tick + offset) & SLOT_MASK;
+		if (!(wheel->busy & (1ULL << slot)))
+			continue;
+
+		for (timer = wheel->slots[slot]; timer; timer = timer->next) {
+			if (timer->deadline < min)
+				min = timer->deadline;
+			if (TICK(timer->deadline) <= wheel->tick + offset)
+				due = 1;
+		}
+
+		if (due)
+			break;
+	}
+
+	return min;
+}
+
+/*******************************************************************************
+ * This function moves the timers of the wheel which have expired at 'now' to
+ * the 'expired' list. Only the slots of the ticks elapsed since the last call
+ * are visited, or all of them once a revolution of the wheel has elapsed.
+ ******************************************************************************/
+static void el3_timer_collect(el3_timer_wheel_t *wheel, uint64_t now,
+			      el3_timer_t **expired)
+{
+	uint64_t tick, last = TICK(now);
+	el3_timer_t *timer, *next;
+	unsigned int slot;
+
+	tick = wheel->tick;
+	if (last - tick >= PLAT_EL3_TIMER_WHEEL_SLOTS)
+		tick = last - SLOT_MASK;
+
+	for (; tick <= last; tick++) {
+		slot = tick & SLOT_MASK;
+		if (!(wheel->busy & (1ULL << slot)))
+			continue;
+
+		for (timer = wheel->slots[slot]; timer; timer = next) {
+			next = timer->next;
+			if (timer->deadline <= now) {
+				el3_timer_remove(wheel, timer);
+				el3_timer_link(expired, timer);
+			}
+		}
+	}
+
+	wheel->tick = last;
+}
+
+/*******************************************************************************
+ * Handler of the secure physical timer interrupt. It calls the functions of
+ * the expired timers, restarts the periodic ones and programs the next
+ * deadline. The functions may start or cancel timers, including the expired
+ * ones which haven't been processed yet.
+ ******************************************************************************/
+static uint64_t el3_timer_handler(uint32_t id,
+				  uint32_t flags,
+				  void *handle,
+				  void *cookie)
+{
+	el3_timer_wheel_t *wheel = &el3_timer_wheels[plat_my_core_pos()];
+	el3_timer_t *expired = NULL, *timer;
+	uint64_t now;
+
+	assert(id == PLAT_EL3_TIMER_IRQ);
+
+	/* Deassert the interrupt */
+	write_cntps_ctl_el1(0);
+	isb();
+
+	now = read_cntpct_el0();
+	el3_timer_collect(wheel, now, &expired);
+
+	while (expired) {
+		timer = expired;
+		el3_timer_unlink(timer);
+
+		/* Restart a periodic timer from its next period after 'now' */
+		if (timer->period) {
+			timer->deadline += ((now - timer->deadline) /
+					timer->period + 1) * timer->period;
+			el3_timer_insert(wheel, timer);
+		}
+
+		timer->func(timer, timer->arg);
+	}
+
+	el3_timer_program(wheel, el3_timer_next_deadline(wheel));
+
+	return 0;
+}
+
+/*******************************************************************************
+ * This function prepares 'timer' to call 'func' with 'arg' when it expires.
+ ******************************************************************************/
+void el3_timer_setup(el3_timer_t *timer, el3_timer_func_t func, void *arg)
+{
+	assert(timer && func);
+
+	timer->next = NULL;
+	timer->pprev = NULL;
+	timer->deadline = 0;
+	timer->period = 0;
+	timer->func = func;
+	timer->arg = arg;
+}
+
+/*******************************************************************************
+ * This function starts 'timer' on the calling CPU, to expire when the system
+ * counter reaches 'deadline', and then every 'period' ticks if 'period' isn't
+ * 0. A pending timer is restarted. The secure physical timer is only
+ * reprogrammed when the deadline is earlier than the programmed one.
+ ******************************************************************************/
+void el3_timer_start(el3_timer_t *timer, uint64_t deadline, uint64_t period)
+{
+	unsigned int cpu = plat_my_core_pos();
+	el3_timer_wheel_t *wheel = &el3_timer_wheels[cpu];
+
+	assert(timer && timer->func);
+
+	if (timer->pprev)
+		el3_timer_cancel(timer);
+
+	timer->deadline = deadline;
+	timer->period = period;
+	timer->cpu = cpu;
+	el3_timer_insert(wheel, timer);
+
+	if (deadline < wheel->next)
+		el3_timer_program(wheel, deadline);
+}
+
+/*******************************************************************************
+ * This function cancels 'timer' if it is pending. It must be called on the CPU
+ * the timer was started on. The secure physical timer is left programmed, and
+ * the deadline is recomputed if it fires without any timer to expire.
+ ******************************************************************************/
+void el3_timer_cancel(el3_timer_t *timer)
+{
+	assert(timer);
+
+	if (!timer->pprev)
+		return;
+
+	assert(timer->cpu == plat_my_core_pos());
+	el3_timer_remove(&el3_timer_wheels[timer->cpu], timer);
+}
+
+int el3_timer_is_pending(const el3_timer_t *timer)
+{
+	return timer->pprev != NULL;
+}
+
+/*******************************************************************************
+ * This function programs the secure physical timer of the calling CPU with the
+ * earliest deadline of its timers. It is called by the PSCI warm boot path
+ * when a CPU resumes from a power down state, as the timer state is lost.
+ ******************************************************************************/
+void el3_timer_resume(void)
+{
+	el3_timer_wheel_t *wheel = &el3_timer_wheels[plat_my_core_pos()];
+
+	el3_timer_program(wheel, el3_timer_next_deadline(wheel));
+}
+
+/*******************************************************************************
+ * This function registers the handler of the secure physical timer interrupt.
+ * The platform must have configured PLAT_EL3_TIMER_IRQ as an EL3 interrupt. It
+ * is routed to EL3 from both security states.
+ ******************************************************************************/
+void el3_timer_init(void)
+{
+	uint32_t flags = 0;
+	unsigned int i;
+	int32_t rc;
+
+	for (i = 0; i < PLATFORM_CORE_COUNT; i++)
+		el3_timer_wheels[i].next = NO_DEADLINE;
+
+	set_interrupt_rm_flag(flags, SECURE);
+	set_interrupt_rm_flag(flags, NON_SECURE);
+
+	rc = register_el3_interrupt_handler(PLAT_EL3_TIMER_IRQ,
+					    el3_timer_handler, flags);
+	if (rc) {
+		ERROR("Failed to register the EL3 timer handler (%d)\n", rc);
+		panic();
+	}
+}
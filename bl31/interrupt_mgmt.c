@@ -7,10 +7,12 @@
 #include <assert.h>
 #include <bl_common.h>
 #include <context_mgmt.h>
+#include <debug.h>
 #include <errno.h>
 #include <interrupt_mgmt.h>
 #include <platform.h>
 #include <stdio.h>
+#include <string.h>
 
 /*******************************************************************************
  * Local structure and corresponding array to keep track of the state of the
@@ -42,6 +44,28 @@ typedef struct intr_type_desc {
 
 static intr_type_desc_t intr_type_descs[MAX_INTR_TYPES];
 
+/*******************************************************************************
+ * Local structure and corresponding array to keep track of the handlers
+ * registered for individual EL3 interrupts. The array is kept sorted by
+ * interrupt id. All the EL3 interrupts are dispatched to these handlers by a
+ * single handler registered for the EL3 interrupt type.
+ ******************************************************************************/
+typedef struct el3_intr_desc {
+	uint32_t id;
+	interrupt_type_handler_t handler;
+} el3_intr_desc_t;
+
+static el3_intr_desc_t el3_intr_descs[PLAT_MAX_EL3_INTR_HANDLERS];
+static unsigned int el3_intr_descs_num;
+
+/*
+ * Mask to extract the interrupt id from the value returned by the interrupt
+ * controller when acknowledging an interrupt, and the highest interrupt id
+ * which is not reserved for special purposes.
+ */
+#define EL3_INTR_ID_MASK		U(0x3ff)
+#define EL3_INTR_ID_MAX			U(1019)
+
 /*******************************************************************************
  * This function validates the interrupt type.
  ******************************************************************************/
@@ -211,6 +235,106 @@ int32_t register_interrupt_type_handler(uint32_t type,
 	return 0;
 }
 
+/*******************************************************************************
+ * This function is the handler registered for the EL3 interrupt type once a
+ * handler has been registered for an individual EL3 interrupt. It acknowledges
+ * the highest priority pending interrupt, calls the handler registered for its
+ * id and signals the end of the interrupt. The handler is passed the id of the
+ * interrupt instead of INTR_ID_UNAVAILABLE.
+ ******************************************************************************/
+static uint64_t el3_interrupt_dispatcher(uint32_t id,
+					 uint32_t flags,
+					 void *handle,
+					 void *cookie)
+{
+	interrupt_type_handler_t handler = NULL;
+	uint32_t raw_id;
+	uint64_t rc = 0;
+	unsigned int i;
+
+	raw_id = plat_ic_acknowledge_interrupt();
+	id = raw_id & EL3_INTR_ID_MASK;
+
+	/* The interrupt might have been deasserted since it was signalled */
+	if (id > EL3_INTR_ID_MAX)
+		return 0;
+
+	for (i = 0; i < el3_intr_descs_num; i++) {
+		if (el3_intr_descs[i].id >= id) {
+			if (el3_intr_descs[i].id == id)
+				handler = el3_intr_descs[i].handler;
+			break;
+		}
+	}
+
+	if (handler) {
+		rc = handler(id, flags, handle, cookie);
+	} else {
+		/* Stop an interrupt nobody handles from firing again */
+		WARN("No handler for EL3 interrupt %u\n", id);
+		plat_ic_disable_interrupt(id);
+	}
+
+	plat_ic_end_of_interrupt(raw_id);
+
+	return rc;
+}
+
+/*******************************************************************************
+ * This function registers a handler for the EL3 interrupt identified by 'id'.
+ * The first registration also registers the EL3 interrupt type handler that
+ * dispatches the interrupts, with the routing model specified in the 'flags'.
+ * Later registrations must specify the same routing model. Registration is
+ * expected to happen during boot, on a single CPU.
+ ******************************************************************************/
+int32_t register_el3_interrupt_handler(uint32_t id,
+				       interrupt_type_handler_t handler,
+				       uint32_t flags)
+{
+	int32_t rc;
+	unsigned int i;
+
+	/* Validate the 'id' and 'handler' parameters */
+	if ((id > EL3_INTR_ID_MAX) || !handler)
+		return -EINVAL;
+
+	if (plat_ic_get_interrupt_type(id) != INTR_TYPE_EL3)
+		return -EINVAL;
+
+	/* Find where the handler goes and check it isn't registered yet */
+	for (i = 0; i < el3_intr_descs_num; i++) {
+		if (el3_intr_descs[i].id == id)
+			return -EALREADY;
+		if (el3_intr_descs[i].id > id)
+			break;
+	}
+
+	if (el3_intr_descs_num == PLAT_MAX_EL3_INTR_HANDLERS)
+		return -ENOMEM;
+
+	if (!intr_type_descs[INTR_TYPE_EL3].handler) {
+		rc = register_interrupt_type_handler(INTR_TYPE_EL3,
+				el3_interrupt_dispatcher, flags);
+		if (rc)
+			return rc;
+	} else if (intr_type_descs[INTR_TYPE_EL3].handler !=
+			el3_interrupt_dispatcher) {
+		/* The EL3 interrupts are already handled as a whole */
+		return -EALREADY;
+	} else if (intr_type_descs[INTR_TYPE_EL3].flags != flags) {
+		return -EINVAL;
+	}
+
+	/* Insert the handler, keeping the array sorted */
+	memmove(&el3_intr_descs[i + 1], &el3_intr_descs[i],
+		(el3_intr_descs_num - i) * sizeof(el3_intr_desc_t));
+	el3_intr_descs[i].id = id;
+	el3_intr_descs[i].handler = handler;
+	el3_intr_descs_num++;
+
+	return 0;
+}
+
 /*******************************************************************************
  * This function is called when an interrupt is generated and returns the
  * handler for the interrupt type (if registered). It returns NULL if the
@@ -9,6 +9,7 @@
 #include <assert.h>
 #include <auth_mod.h>
 #include <bl_common.h>
+#include <boot_profile.h>
 #include <debug.h>
 #include <errno.h>
 #include <io_storage.h>
@@ -260,7 +261,9 @@ int load_image(unsigned int image_id, image_info_t *image_data)
 
 	/* We have enough space so load the image now */
 	/* TODO: Consider whether to try to recover/retry a partially successful read */
+	BOOT_PROFILE_BEGIN("io_read", image_id);
 	io_result = io_read(image_handle, image_base, image_size, &bytes_read);
+	BOOT_PROFILE_END("io_read", image_id);
 	if ((io_result != 0) || (bytes_read < image_size)) {
 		WARN("Failed to load image id=%u (%i)\n", image_id, io_result);
 		goto exit;
@@ -318,9 +321,11 @@ static int load_auth_image_internal(unsigned int image_id,
 
 #if TRUSTED_BOARD_BOOT
 	/* Authenticate it */
+	BOOT_PROFILE_BEGIN("auth_verify", image_id);
 	rc = auth_mod_verify_img(image_id,
 				 (void *)image_data->image_base,
 				 image_data->image_size);
+	BOOT_PROFILE_END("auth_verify", image_id);
 	if (rc != 0) {
 		/* Authentication error, zero memory and flush it right away. */
 		zero_normalmem((void *)image_data->image_base,
@@ -356,9 +361,11 @@ int load_auth_image(unsigned int image_id, image_info_t *image_data)
 {
 	int err;
 
+	BOOT_PROFILE_BEGIN("load_auth_image", image_id);
 	do {
 		err = load_auth_image_internal(image_id, image_data, 0);
 	} while (err != 0 && plat_try_next_boot_source());
+	BOOT_PROFILE_END("load_auth_image", image_id);
 
 	return err;
 }
@@ -438,7 +445,9 @@ int load_image(meminfo_t *mem_layout,
 
 	/* We have enough space so load the image now */
 	/* TODO: Consider whether to try to recover/retry a partially successful read */
+	BOOT_PROFILE_BEGIN("io_read", image_id);
 	io_result = io_read(image_handle, image_base, image_size, &bytes_read);
+	BOOT_PROFILE_END("io_read", image_id);
 	if ((io_result != 0) || (bytes_read < image_size)) {
 		WARN("Failed to load image id=%u (%i)\n", image_id, io_result);
 		goto exit;
@@ -520,9 +529,11 @@ static int load_auth_image_internal(meminfo_t *mem_layout,
 
 #if TRUSTED_BOARD_BOOT
 	/* Authenticate it */
+	BOOT_PROFILE_BEGIN("auth_verify", image_id);
 	rc = auth_mod_verify_img(image_id,
 				 (void *)image_data->image_base,
 				 image_data->image_size);
+	BOOT_PROFILE_END("auth_verify", image_id);
 	if (rc != 0) {
 		/* Authentication error, zero memory and flush it right away. */
 		zero_normalmem((void *)image_data->image_base,
@@ -561,10 +572,12 @@ int load_auth_image(meminfo_t *mem_layout,
 {
 	int err;
 
+	BOOT_PROFILE_BEGIN("load_auth_image", image_id);
 	do {
 		err = load_auth_image_internal(mem_layout, image_id, image_base,
 					       image_data, entry_point_info, 0);
 	} while (err != 0 && plat_try_next_boot_source());
+	BOOT_PROFILE_END("load_auth_image", image_id);
 
 	return err;
 }
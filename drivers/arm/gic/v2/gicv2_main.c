@@ -11,6 +11,8 @@
 #include <gic_common.h>
 #include <gicv2.h>
 #include <interrupt_props.h>
+#include <platform.h>
+#include <platform_def.h>
 #include <spinlock.h>
 #include "../common/gic_common_private.h"
 #include "gicv2_private.h"
@@ -24,6 +26,53 @@ static const gicv2_driver_data_t *driver_data;
  */
 spinlock_t gic_lock;
 
+#if WARMBOOT_FAST_RESUME
+/*
+ * Snapshot of the banked SGI/PPI configuration of the distributor. Each cpu
+ * takes it once gicv2_pcpu_distif_init() has configured the interrupts for the
+ * first time, and restores it with a single write per register on the
+ * following warm boots.
+ */
+typedef struct gicv2_pcpu_snapshot {
+	unsigned int igroupr0;
+	unsigned int isenabler0;
+	unsigned int ipriorityr[MIN_SPI_ID >> 2];
+	unsigned int icfgr1;
+	unsigned int valid;
+} gicv2_pcpu_snapshot_t;
+
+static gicv2_pcpu_snapshot_t gicv2_pcpu_snapshots[PLATFORM_CORE_COUNT];
+
+static void gicv2_pcpu_save(uintptr_t gicd_base, gicv2_pcpu_snapshot_t *snap)
+{
+	unsigned int i;
+
+	for (i = 0; i < MIN_SPI_ID; i += 4)
+		snap->ipriorityr[i >> 2] = gicd_read_ipriorityr(gicd_base, i);
+
+	snap->icfgr1 = gicd_read_icfgr(gicd_base, MIN_PPI_ID);
+	snap->igroupr0 = gicd_read_igroupr(gicd_base, 0);
+	snap->isenabler0 = gicd_read_isenabler(gicd_base, 0);
+	snap->valid = 1;
+}
+
+static void gicv2_pcpu_restore(uintptr_t gicd_base,
+			       const gicv2_pcpu_snapshot_t *snap)
+{
+	unsigned int i;
+
+	/* Disable all SGIs (imp. def.)/PPIs before configuring them */
+	gicd_write_icenabler(gicd_base, 0, ~0);
+
+	for (i = 0; i < MIN_SPI_ID; i += 4)
+		gicd_write_ipriorityr(gicd_base, i, snap->ipriorityr[i >> 2]);
+
+	gicd_write_icfgr(gicd_base, MIN_PPI_ID, snap->icfgr1);
+	gicd_write_igroupr(gicd_base, 0, snap->igroupr0);
+	gicd_write_isenabler(gicd_base, 0, snap->isenabler0);
+}
+#endif /* WARMBOOT_FAST_RESUME */
+
 /*******************************************************************************
  * Enable secure interrupts and use FIQs to route them. Disable legacy bypass
  * and set the priority mask register to allow all interrupts to trickle in.
@@ -72,9 +121,21 @@ void gicv2_cpuif_disable(void)
  ******************************************************************************/
 void gicv2_pcpu_distif_init(void)
 {
+#if WARMBOOT_FAST_RESUME
+	gicv2_pcpu_snapshot_t *snap;
+#endif
+
 	assert(driver_data);
 	assert(driver_data->gicd_base);
 
+#if WARMBOOT_FAST_RESUME
+	snap = &gicv2_pcpu_snapshots[plat_my_core_pos()];
+	if (snap->valid) {
+		gicv2_pcpu_restore(driver_data->gicd_base, snap);
+		return;
+	}
+#endif
+
 #if !ERROR_DEPRECATED
 	if (driver_data->interrupt_props != NULL) {
 #endif
@@ -89,6 +150,10 @@ void gicv2_pcpu_distif_init(void)
 				driver_data->g0_interrupt_array);
 	}
 #endif
+
+#if WARMBOOT_FAST_RESUME
+	gicv2_pcpu_save(driver_data->gicd_base, snap);
+#endif
 }
 
 /*******************************************************************************
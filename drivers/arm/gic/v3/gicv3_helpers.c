@@ -10,6 +10,7 @@
 #include <debug.h>
 #include <gic_common.h>
 #include <interrupt_props.h>
+#include <string.h>
 #include "../common/gic_common_private.h"
 #include "gicv3_private.h"
 
@@ -232,12 +233,13 @@ void gicr_set_ipriorityr(uintptr_t base, unsigned int id, unsigned int pri)
  */
 void gicr_set_icfgr0(uintptr_t base, unsigned int id, unsigned int cfg)
 {
-	unsigned bit_num = id & ((1 << ICFGR_SHIFT) - 1);
+	/* Interrupt configuration is a 2-bit field */
+	unsigned bit_shift = (id & ((1 << ICFGR_SHIFT) - 1)) << 1;
 	uint32_t reg_val = gicr_read_icfgr0(base);
 
 	/* Clear the field, and insert required configuration */
-	reg_val &= ~(GIC_CFG_MASK << bit_num);
-	reg_val |= ((cfg & GIC_CFG_MASK) << bit_num);
+	reg_val &= ~(GIC_CFG_MASK << bit_shift);
+	reg_val |= GIC_CFG_FIELD(cfg) << bit_shift;
 
 	gicr_write_icfgr0(base, reg_val);
 }
@@ -248,12 +250,13 @@ void gicr_set_icfgr0(uintptr_t base, unsigned int id, unsigned int cfg)
  */
 void gicr_set_icfgr1(uintptr_t base, unsigned int id, unsigned int cfg)
 {
-	unsigned bit_num = id & ((1 << ICFGR_SHIFT) - 1);
+	/* Interrupt configuration is a 2-bit field */
+	unsigned bit_shift = (id & ((1 << ICFGR_SHIFT) - 1)) << 1;
 	uint32_t reg_val = gicr_read_icfgr1(base);
 
 	/* Clear the field, and insert required configuration */
-	reg_val &= ~(GIC_CFG_MASK << bit_num);
-	reg_val |= ((cfg & GIC_CFG_MASK) << bit_num);
+	reg_val &= ~(GIC_CFG_MASK << bit_shift);
+	reg_val |= GIC_CFG_FIELD(cfg) << bit_shift;
 
 	gicr_write_icfgr1(base, reg_val);
 }
@@ -414,57 +417,176 @@ void gicv3_secure_spis_configure(uintptr_t gicd_base,
 }
 #endif
 
+/*
+ * Image of the configuration of a block of 32 interrupts, built from the
+ * platform interrupt properties so that each register word of the block is
+ * accessed at most once.
+ */
+typedef struct gicv3_intr_block {
+	/* Interrupts of the block which are configured as secure */
+	unsigned int sec_mask;
+	/* Secure interrupts of the block which are in Group 1 Secure */
+	unsigned int g1s_mask;
+	/* ICFGR words covering the block, 16 interrupts per word */
+	unsigned int cfg_val[2];
+	unsigned int cfg_mask[2];
+	/* IPRIORITYR words covering the block, 4 interrupts per word */
+	unsigned int pri_val[8];
+	unsigned int pri_mask[8];
+} gicv3_intr_block_t;
+
 /*******************************************************************************
- * Helper function to configure properties of secure SPIs
+ * Helper function to build the configuration image of the block of 32
+ * interrupts starting at `base_id` from the interrupt properties. Later entries
+ * override earlier ones for the same interrupt. Returns the GICD_CTLR group
+ * enable bits required by the secure interrupts of the block.
  ******************************************************************************/
-unsigned int gicv3_secure_spis_configure_props(uintptr_t gicd_base,
+static unsigned int gicv3_intr_block_build(gicv3_intr_block_t *block,
+		unsigned int base_id,
 		const interrupt_prop_t *interrupt_props,
 		unsigned int interrupt_props_num)
 {
-	unsigned int i;
+	unsigned int i, bit, word, shift;
 	const interrupt_prop_t *current_prop;
-	unsigned long long gic_affinity_val;
 	unsigned int ctlr_enable = 0;
 
-	/* Make sure there's a valid property array */
-	assert(interrupt_props != NULL);
-	assert(interrupt_props_num > 0);
+	memset(block, 0, sizeof(*block));
 
 	for (i = 0; i < interrupt_props_num; i++) {
 		current_prop = &interrupt_props[i];
 
-		if (current_prop->intr_num < MIN_SPI_ID)
+		if ((current_prop->intr_num < base_id) ||
+				(current_prop->intr_num >= base_id + 32))
 			continue;
 
+		bit = current_prop->intr_num - base_id;
+
 		/* Configure this interrupt as a secure interrupt */
-		gicd_clr_igroupr(gicd_base, current_prop->intr_num);
+		block->sec_mask |= 1U << bit;
 
 		/* Configure this interrupt as G0 or a G1S interrupt */
 		assert((current_prop->intr_grp == INTR_GROUP0) ||
 				(current_prop->intr_grp == INTR_GROUP1S));
 		if (current_prop->intr_grp == INTR_GROUP1S) {
-			gicd_set_igrpmodr(gicd_base, current_prop->intr_num);
+			block->g1s_mask |= 1U << bit;
 			ctlr_enable |= CTLR_ENABLE_G1S_BIT;
 		} else {
-			gicd_clr_igrpmodr(gicd_base, current_prop->intr_num);
+			block->g1s_mask &= ~(1U << bit);
 			ctlr_enable |= CTLR_ENABLE_G0_BIT;
 		}
 
-		/* Set interrupt configuration */
-		gicd_set_icfgr(gicd_base, current_prop->intr_num,
-				current_prop->intr_cfg);
+		/* Set interrupt configuration, a 2-bit field */
+		word = bit >> ICFGR_SHIFT;
+		shift = (bit & ((1 << ICFGR_SHIFT) - 1)) << 1;
+		block->cfg_mask[word] |= (unsigned int)GIC_CFG_MASK << shift;
+		block->cfg_val[word] &= ~((unsigned int)GIC_CFG_MASK << shift);
+		block->cfg_val[word] |=
+			(unsigned int)GIC_CFG_FIELD(current_prop->intr_cfg)
+				<< shift;
 
 		/* Set the priority of this interrupt */
-		gicd_set_ipriorityr(gicd_base, current_prop->intr_num,
-				current_prop->intr_pri);
+		word = bit >> IPRIORITYR_SHIFT;
+		shift = (bit & ((1 << IPRIORITYR_SHIFT) - 1)) << 3;
+		block->pri_mask[word] |= (unsigned int)GIC_PRI_MASK << shift;
+		block->pri_val[word] &= ~((unsigned int)GIC_PRI_MASK << shift);
+		block->pri_val[word] |= (current_prop->intr_pri & GIC_PRI_MASK)
+				<< shift;
+	}
+
+	return ctlr_enable;
+}
+
+/*
+ * Return the register word `val` merged with the bits of `old` outside `mask`.
+ * `val` must not have bits set outside `mask`.
+ */
+static inline unsigned int gicv3_merge_word(unsigned int old, unsigned int val,
+		unsigned int mask)
+{
+	return (old & ~mask) | val;
+}
+
+/*******************************************************************************
+ * Helper function to configure properties of secure SPIs. The properties are
+ * applied a block of 32 SPIs at a time, with a single access per register word
+ * instead of a read-modify-write per interrupt.
+ ******************************************************************************/
+unsigned int gicv3_secure_spis_configure_props(uintptr_t gicd_base,
+		const interrupt_prop_t *interrupt_props,
+		unsigned int interrupt_props_num)
+{
+	unsigned int i, base_id, word, id, val, mask, blocks = 0;
+	unsigned long long gic_affinity_val;
+	unsigned int ctlr_enable = 0;
+	gicv3_intr_block_t block;
 
-		/* Target SPIs to the primary CPU */
-		gic_affinity_val = gicd_irouter_val_from_mpidr(read_mpidr(), 0);
-		gicd_write_irouter(gicd_base, current_prop->intr_num,
-				gic_affinity_val);
+	/* Make sure there's a valid property array */
+	assert(interrupt_props != NULL);
+	assert(interrupt_props_num > 0);
 
-		/* Enable this interrupt */
-		gicd_set_isenabler(gicd_base, current_prop->intr_num);
+	/* Find the blocks of 32 SPIs with secure interrupts */
+	for (i = 0; i < interrupt_props_num; i++) {
+		if (interrupt_props[i].intr_num < MIN_SPI_ID)
+			continue;
+
+		assert(interrupt_props[i].intr_num <= MAX_SPI_ID);
+		blocks |= 1U << (interrupt_props[i].intr_num >> IGROUPR_SHIFT);
+	}
+
+	/* Target SPIs to the primary CPU */
+	gic_affinity_val = gicd_irouter_val_from_mpidr(read_mpidr(), 0);
+
+	while (blocks != 0U) {
+		base_id = __builtin_ctz(blocks) << IGROUPR_SHIFT;
+		blocks &= blocks - 1U;
+
+		ctlr_enable |= gicv3_intr_block_build(&block, base_id,
+				interrupt_props, interrupt_props_num);
+
+		/* Configure the interrupts as secure, G0 or G1S */
+		val = gicd_read_igroupr(gicd_base, base_id);
+		gicd_write_igroupr(gicd_base, base_id, val & ~block.sec_mask);
+		gicd_write_igrpmodr(gicd_base, base_id,
+			gicv3_merge_word(gicd_read_igrpmodr(gicd_base, base_id),
+				block.g1s_mask, block.sec_mask));
+
+		/* Set interrupt configuration */
+		for (word = 0; word < 2; word++) {
+			mask = block.cfg_mask[word];
+			if (mask == 0U)
+				continue;
+
+			id = base_id + (word << ICFGR_SHIFT);
+			val = block.cfg_val[word];
+			if (mask != ~0U)
+				val = gicv3_merge_word(
+					gicd_read_icfgr(gicd_base, id),
+					val, mask);
+			gicd_write_icfgr(gicd_base, id, val);
+		}
+
+		/* Set the priorities, skipping the read of full words */
+		for (word = 0; word < 8; word++) {
+			mask = block.pri_mask[word];
+			if (mask == 0U)
+				continue;
+
+			id = base_id + (word << IPRIORITYR_SHIFT);
+			val = block.pri_val[word];
+			if (mask != ~0U)
+				val = gicv3_merge_word(
+					gicd_read_ipriorityr(gicd_base, id),
+					val, mask);
+			gicd_write_ipriorityr(gicd_base, id, val);
+		}
+
+		for (i = block.sec_mask; i != 0U; i &= i - 1U) {
+			id = base_id + __builtin_ctz(i);
+			gicd_write_irouter(gicd_base, id, gic_affinity_val);
+		}
+
+		/* Enable the interrupts */
+		gicd_write_isenabler(gicd_base, base_id, block.sec_mask);
 	}
 
 	return ctlr_enable;
@@ -540,50 +662,59 @@ void gicv3_secure_ppi_sgi_configure(uintptr_t gicr_base,
 
 /*******************************************************************************
  * Helper function to configure properties of secure G0 and G1S PPIs and SGIs.
+ * All of them belong to the same block of 32 interrupts, so each Redistributor
+ * register word is accessed at most once.
  ******************************************************************************/
 void gicv3_secure_ppi_sgi_configure_props(uintptr_t gicr_base,
 		const interrupt_prop_t *interrupt_props,
 		unsigned int interrupt_props_num)
 {
-	unsigned int i;
-	const interrupt_prop_t *current_prop;
+	unsigned int word, id, val, mask;
+	gicv3_intr_block_t block;
 
 	/* Make sure there's a valid property array */
 	assert(interrupt_props != NULL);
 	assert(interrupt_props_num > 0);
 
-	for (i = 0; i < interrupt_props_num; i++) {
-		current_prop = &interrupt_props[i];
-
-		if (current_prop->intr_num >= MIN_SPI_ID)
+	gicv3_intr_block_build(&block, MIN_SGI_ID, interrupt_props,
+			interrupt_props_num);
+	if (block.sec_mask == 0U)
+		return;
+
+	/* Configure the interrupts as secure, G0 or G1S */
+	gicr_write_igroupr0(gicr_base,
+			gicr_read_igroupr0(gicr_base) & ~block.sec_mask);
+	gicr_write_igrpmodr0(gicr_base,
+			gicv3_merge_word(gicr_read_igrpmodr0(gicr_base),
+				block.g1s_mask, block.sec_mask));
+
+	/* Set the priorities, skipping the read of full words */
+	for (word = 0; word < 8; word++) {
+		mask = block.pri_mask[word];
+		if (mask == 0U)
 			continue;
 
-		/* Configure this interrupt as a secure interrupt */
-		gicr_clr_igroupr0(gicr_base, current_prop->intr_num);
-
-		/* Configure this interrupt as G0 or a G1S interrupt */
-		assert((current_prop->intr_grp == INTR_GROUP0) ||
-				(current_prop->intr_grp == INTR_GROUP1S));
-		if (current_prop->intr_grp == INTR_GROUP1S)
-			gicr_set_igrpmodr0(gicr_base, current_prop->intr_num);
-		else
-			gicr_clr_igrpmodr0(gicr_base, current_prop->intr_num);
-
-		/* Set the priority of this interrupt */
-		gicr_set_ipriorityr(gicr_base, current_prop->intr_num,
-				current_prop->intr_pri);
-
-		/*
-		 * Set interrupt configuration for PPIs. Configuration for SGIs
-		 * are ignored.
-		 */
-		if ((current_prop->intr_num >= MIN_PPI_ID) &&
-				(current_prop->intr_num < MIN_SPI_ID)) {
-			gicr_set_icfgr1(gicr_base, current_prop->intr_num,
-					current_prop->intr_cfg);
-		}
+		id = MIN_SGI_ID + (word << IPRIORITYR_SHIFT);
+		val = block.pri_val[word];
+		if (mask != ~0U)
+			val = gicv3_merge_word(
+				gicr_read_ipriorityr(gicr_base, id), val, mask);
+		gicr_write_ipriorityr(gicr_base, id, val);
+	}
 
-		/* Enable this interrupt */
-		gicr_set_isenabler0(gicr_base, current_prop->intr_num);
+	/*
+	 * Set interrupt configuration for PPIs. Configuration for SGIs
+	 * are ignored.
+	 */
+	mask = block.cfg_mask[1];
+	if (mask != 0U) {
+		val = block.cfg_val[1];
+		if (mask != ~0U)
+			val = gicv3_merge_word(gicr_read_icfgr1(gicr_base),
+					val, mask);
+		gicr_write_icfgr1(gicr_base, val);
 	}
+
+	/* Enable the interrupts */
+	gicr_write_isenabler0(gicr_base, block.sec_mask);
 }
@@ -10,9 +10,20 @@
 #include <debug.h>
 #include <gicv3.h>
 #include <interrupt_props.h>
+#include <platform_def.h>
 #include <spinlock.h>
 #include "gicv3_private.h"
 
+/* The per-CPU record lives in cpu_data, which only the runtime images have */
+#if GICV3_PCPU_CACHE && \
+	(defined(IMAGE_BL31) || (defined(AARCH32) && defined(IMAGE_BL32)))
+#define GICV3_USE_PCPU_CACHE	1
+#include <cpu_data.h>
+#include <platform.h>
+#else
+#define GICV3_USE_PCPU_CACHE	0
+#endif
+
 const gicv3_driver_data_t *gicv3_driver_data;
 static unsigned int gicv2_compat;
 
@@ -23,6 +34,71 @@ static unsigned int gicv2_compat;
  */
 spinlock_t gic_lock;
 
+#if WARMBOOT_FAST_RESUME
+/*
+ * Snapshot of the SGI/PPI configuration of a Redistributor. It is taken once
+ * gicv3_rdistif_init() has configured the interrupts of the Redistributor for
+ * the first time, and restored with a single write per register on the
+ * following warm boots.
+ */
+typedef struct gicv3_rdist_snapshot {
+	unsigned int igroupr0;
+	unsigned int igrpmodr0;
+	unsigned int ipriorityr[TOTAL_PCPU_INTR_NUM >> IPRIORITYR_SHIFT];
+	unsigned int icfgr0;
+	unsigned int icfgr1;
+	unsigned int isenabler0;
+	unsigned int valid;
+} gicv3_rdist_snapshot_t;
+
+static gicv3_rdist_snapshot_t gicv3_rdist_snapshots[PLATFORM_CORE_COUNT];
+
+static void gicv3_rdist_save(uintptr_t gicr_base, gicv3_rdist_snapshot_t *snap)
+{
+	unsigned int int_id;
+
+	for (int_id = MIN_SGI_ID; int_id < TOTAL_PCPU_INTR_NUM;
+			int_id += (1 << IPRIORITYR_SHIFT))
+		snap->ipriorityr[(int_id - MIN_SGI_ID) >> IPRIORITYR_SHIFT] =
+				gicr_read_ipriorityr(gicr_base, int_id);
+
+	snap->igroupr0 = gicr_read_igroupr0(gicr_base);
+	snap->igrpmodr0 = gicr_read_igrpmodr0(gicr_base);
+	snap->icfgr0 = gicr_read_icfgr0(gicr_base);
+	snap->icfgr1 = gicr_read_icfgr1(gicr_base);
+	snap->isenabler0 = gicr_read_isenabler0(gicr_base);
+	snap->valid = 1;
+}
+
+static void gicv3_rdist_restore(uintptr_t gicr_base,
+				const gicv3_rdist_snapshot_t *snap)
+{
+	unsigned int int_id;
+
+	/* Disable all SGIs (imp. def.)/PPIs before configuring them */
+	gicr_write_icenabler0(gicr_base, ~0);
+	gicr_wait_for_pending_write(gicr_base);
+
+	gicr_write_igroupr0(gicr_base, snap->igroupr0);
+
+	for (int_id = MIN_SGI_ID; int_id < TOTAL_PCPU_INTR_NUM;
+			int_id += (1 << IPRIORITYR_SHIFT))
+		gicr_write_ipriorityr(gicr_base, int_id,
+			snap->ipriorityr[(int_id - MIN_SGI_ID) >> IPRIORITYR_SHIFT]);
+
+	gicr_write_icfgr0(gicr_base, snap->icfgr0);
+	gicr_write_icfgr1(gicr_base, snap->icfgr1);
+	gicr_write_igrpmodr0(gicr_base, snap->igrpmodr0);
+
+	/*
+	 * Wait for all writes to the Distributor to complete before enabling
+	 * the SGI and PPIs.
+	 */
+	gicr_wait_for_upstream_pending_write(gicr_base);
+	gicr_write_isenabler0(gicr_base, snap->isenabler0);
+}
+#endif /* WARMBOOT_FAST_RESUME */
+
 /*
  * Redistributor power operations are weakly bound so that they can be
  * overridden
@@ -50,6 +126,114 @@ spinlock_t gic_lock;
 		}							\
 	} while (0)
 
+#if GICV3_SPARSE_SAVE_RESTORE
+/*
+ * Writing zero to a set-register has no effect, so the GICD_IS* registers only
+ * need to be written back for blocks of interrupts with at least one bit set.
+ */
+#define RESTORE_GICD_SET_REGS(base, ctx, intr_num, reg, REG)		\
+	do {								\
+		for (unsigned int int_id = MIN_SPI_ID; int_id < intr_num; \
+				int_id += (1 << REG##_SHIFT)) {		\
+			unsigned int val =				\
+				ctx->gicd_##reg[(int_id - MIN_SPI_ID) >> REG##_SHIFT]; \
+			if (val != 0U)					\
+				gicd_write_##reg(base, int_id, val);	\
+		}							\
+	} while (0)
+
+/* Bit tracking the block of 32 SPIs which 'id' belongs to */
+#define GICD_SPI_BLOCK_BIT(id)	(1U << (((id) - MIN_SPI_ID) >> IGROUPR_SHIFT))
+
+/*
+ * Save the registers of a Secure-only class for the blocks of 32 SPIs marked
+ * in the 'dirty' bitmap.
+ */
+#define SAVE_DIRTY_GICD_REGS(base, ctx, intr_num, reg, REG, dirty)	\
+	do {								\
+		for (unsigned int int_id = MIN_SPI_ID; int_id < intr_num; \
+				int_id += (1 << REG##_SHIFT)) {		\
+			if (((dirty) & GICD_SPI_BLOCK_BIT(int_id)) == 0U) \
+				continue;				\
+			ctx->gicd_##reg[(int_id - MIN_SPI_ID) >> REG##_SHIFT] =\
+					gicd_read_##reg(base, int_id);	\
+		}							\
+	} while (0)
+
+/*
+ * GICD_IGROUPR, GICD_IGRPMODR and GICD_NSACR are only writable by the Secure
+ * world, so any change to them goes through this driver. Each bit of
+ * 'gicd_secure_regs_dirty' tracks a block of 32 SPIs whose registers of these
+ * classes may differ from the copy held in the last context saved or restored,
+ * 'gicd_secure_regs_ctx'. Clean blocks are not read back on the next save.
+ */
+static unsigned int gicd_secure_regs_dirty = ~0U;
+static const gicv3_dist_ctx_t *gicd_secure_regs_ctx;
+#else
+#define RESTORE_GICD_SET_REGS(base, ctx, intr_num, reg, REG)		\
+	RESTORE_GICD_REGS(base, ctx, intr_num, reg, REG)
+#endif /* GICV3_SPARSE_SAVE_RESTORE */
+
+
+#if GICV3_USE_PCPU_CACHE
+/*******************************************************************************
+ * This function fills in the GICv3 record in the cpu_data of each CPU which has
+ * a Redistributor frame, using the affinity reported by the frame.
+ ******************************************************************************/
+static void gicv3_pcpu_cache_init(const gicv3_driver_data_t *driver_data)
+{
+	unsigned int i, aff0;
+	int core_pos;
+	u_register_t mpidr;
+	uintptr_t gicr_base;
+	gicv3_cpu_data_t *gic_cpu_data;
+
+	for (i = 0; i < driver_data->rdistif_num; i++) {
+		gicr_base = driver_data->rdistif_base_addrs[i];
+		if (gicr_base == 0U)
+			continue;
+
+		mpidr = mpidr_from_gicr_typer(gicr_read_typer(gicr_base));
+		core_pos = plat_core_pos_by_mpidr(mpidr);
+		if (core_pos < 0)
+			continue;
+
+		gic_cpu_data = &_cpu_data_by_index(core_pos)->gicv3_cpu_data;
+		gic_cpu_data->rdist_base = gicr_base;
+
+		/* A PE with an Aff0 above 15 can't be targeted by an SGI */
+		aff0 = MPIDR_AFFLVL0_VAL(mpidr);
+		gic_cpu_data->sgi_target = (aff0 < GICV3_MAX_SGI_TARGETS) ?
+			GICV3_SGIR_VALUE(MPIDR_AFFLVL3_VAL(mpidr),
+					MPIDR_AFFLVL2_VAL(mpidr),
+					MPIDR_AFFLVL1_VAL(mpidr), 0,
+					SGIR_IRM_TO_AFF, BIT(aff0)) : 0;
+
+		gic_cpu_data->irouter_val =
+			gicd_irouter_val_from_mpidr(mpidr, GICV3_IRM_PE);
+
+		/* Secondary CPUs read their record with the caches disabled */
+		flush_cpu_data_by_index(core_pos, gicv3_cpu_data);
+	}
+}
+
+/*******************************************************************************
+ * This function returns the Redistributor base address of the calling CPU,
+ * identified by the 'proc_num' parameter, from its cpu_data.
+ ******************************************************************************/
+static inline uintptr_t gicv3_my_rdist_base(unsigned int proc_num)
+{
+	uintptr_t gicr_base = get_cpu_data(gicv3_cpu_data.rdist_base);
+
+	assert(gicr_base == gicv3_driver_data->rdistif_base_addrs[proc_num]);
+	return gicr_base;
+}
+#else
+static inline uintptr_t gicv3_my_rdist_base(unsigned int proc_num)
+{
+	return gicv3_driver_data->rdistif_base_addrs[proc_num];
+}
+#endif /* GICV3_USE_PCPU_CACHE */
 
 /*******************************************************************************
  * This function initialises the ARM GICv3 driver in EL3 with provided platform
@@ -128,6 +312,10 @@ void gicv3_driver_init(const gicv3_driver_data_t *plat_driver_data)
 					   plat_driver_data->gicr_base,
 					   plat_driver_data->mpidr_to_core_pos);
 
+#if GICV3_USE_PCPU_CACHE
+	gicv3_pcpu_cache_init(plat_driver_data);
+#endif
+
 	gicv3_driver_data = plat_driver_data;
 
 	/*
@@ -214,6 +402,10 @@ void gicv3_distif_init(void)
 
 	/* Enable the secure SPIs now that they have been configured */
 	gicd_set_ctlr(gicv3_driver_data->gicd_base, bitmap, RWP_TRUE);
+
+#if GICV3_SPARSE_SAVE_RESTORE
+	gicd_secure_regs_dirty = ~0U;
+#endif
 }
 
 /*******************************************************************************
@@ -224,6 +416,9 @@ void gicv3_distif_init(void)
 void gicv3_rdistif_init(unsigned int proc_num)
 {
 	uintptr_t gicr_base;
+#if WARMBOOT_FAST_RESUME
+	gicv3_rdist_snapshot_t *snap;
+#endif
 
 	assert(gicv3_driver_data);
 	assert(proc_num < gicv3_driver_data->rdistif_num);
@@ -236,7 +431,16 @@ void gicv3_rdistif_init(unsigned int proc_num)
 	/* Power on redistributor */
 	gicv3_rdistif_on(proc_num);
 
-	gicr_base = gicv3_driver_data->rdistif_base_addrs[proc_num];
+	gicr_base = gicv3_my_rdist_base(proc_num);
+
+#if WARMBOOT_FAST_RESUME
+	assert(proc_num < PLATFORM_CORE_COUNT);
+	snap = &gicv3_rdist_snapshots[proc_num];
+	if (snap->valid) {
+		gicv3_rdist_restore(gicr_base, snap);
+		return;
+	}
+#endif
 
 	/* Set the default attribute of all SGIs and PPIs */
 	gicv3_ppi_sgi_configure_defaults(gicr_base);
@@ -269,6 +473,10 @@ void gicv3_rdistif_init(unsigned int proc_num)
 		}
 	}
 #endif
+
+#if WARMBOOT_FAST_RESUME
+	gicv3_rdist_save(gicr_base, snap);
+#endif
 }
 
 /*******************************************************************************
@@ -300,7 +508,7 @@ void gicv3_cpuif_enable(unsigned int proc_num)
 	assert(IS_IN_EL3());
 
 	/* Mark the connected core as awake */
-	gicr_base = gicv3_driver_data->rdistif_base_addrs[proc_num];
+	gicr_base = gicv3_my_rdist_base(proc_num);
 	gicv3_rdistif_mark_core_awake(gicr_base);
 
 	/* Disable the legacy interrupt bypass */
@@ -377,7 +585,7 @@ void gicv3_cpuif_disable(unsigned int proc_num)
 	isb();
 
 	/* Mark the connected core as asleep */
-	gicr_base = gicv3_driver_data->rdistif_base_addrs[proc_num];
+	gicr_base = gicv3_my_rdist_base(proc_num);
 	gicv3_rdistif_mark_core_asleep(gicr_base);
 }
 
@@ -702,8 +910,21 @@ void gicv3_distif_save(gicv3_dist_ctx_t * const dist_ctx)
 	/* Save the GICD_CTLR */
 	dist_ctx->gicd_ctlr = gicd_read_ctlr(gicd_base);
 
+#if GICV3_SPARSE_SAVE_RESTORE
+	/*
+	 * A context other than the one last saved or restored holds no valid
+	 * copy of the Secure-only registers.
+	 */
+	if (dist_ctx != gicd_secure_regs_ctx)
+		gicd_secure_regs_dirty = ~0U;
+
+	/* Save GICD_IGROUPR for the modified blocks of INTIDs 32 - 1020 */
+	SAVE_DIRTY_GICD_REGS(gicd_base, dist_ctx, num_ints, igroupr, IGROUPR,
+			gicd_secure_regs_dirty);
+#else
 	/* Save GICD_IGROUPR for INTIDs 32 - 1020 */
 	SAVE_GICD_REGS(gicd_base, dist_ctx, num_ints, igroupr, IGROUPR);
+#endif
 
 	/* Save GICD_ISENABLER for INT_IDs 32 - 1020 */
 	SAVE_GICD_REGS(gicd_base, dist_ctx, num_ints, isenabler, ISENABLER);
@@ -720,11 +941,24 @@ void gicv3_distif_save(gicv3_dist_ctx_t * const dist_ctx)
 	/* Save GICD_ICFGR for INTIDs 32 - 1020 */
 	SAVE_GICD_REGS(gicd_base, dist_ctx, num_ints, icfgr, ICFGR);
 
+#if GICV3_SPARSE_SAVE_RESTORE
+	/* Save GICD_IGRPMODR for the modified blocks of INTIDs 32 - 1020 */
+	SAVE_DIRTY_GICD_REGS(gicd_base, dist_ctx, num_ints, igrpmodr, IGRPMODR,
+			gicd_secure_regs_dirty);
+
+	/* Save GICD_NSACR for the modified blocks of INTIDs 32 - 1020 */
+	SAVE_DIRTY_GICD_REGS(gicd_base, dist_ctx, num_ints, nsacr, NSACR,
+			gicd_secure_regs_dirty);
+
+	gicd_secure_regs_ctx = dist_ctx;
+	gicd_secure_regs_dirty = 0U;
+#else
 	/* Save GICD_IGRPMODR for INTIDs 32 - 1020 */
 	SAVE_GICD_REGS(gicd_base, dist_ctx, num_ints, igrpmodr, IGRPMODR);
 
 	/* Save GICD_NSACR for INTIDs 32 - 1020 */
 	SAVE_GICD_REGS(gicd_base, dist_ctx, num_ints, nsacr, NSACR);
+#endif
 
 	/* Save GICD_IROUTER for INTIDs 32 - 1024 */
 	SAVE_GICD_REGS(gicd_base, dist_ctx, num_ints, irouter, IROUTER);
@@ -792,19 +1026,25 @@ void gicv3_distif_init_restore(const gicv3_dist_ctx_t * const dist_ctx)
 	/* Restore GICD_IROUTER for INTIDs 32 - 1020 */
 	RESTORE_GICD_REGS(gicd_base, dist_ctx, num_ints, irouter, IROUTER);
 
+#if GICV3_SPARSE_SAVE_RESTORE
+	/* The Secure-only registers now match the restored context */
+	gicd_secure_regs_ctx = dist_ctx;
+	gicd_secure_regs_dirty = 0U;
+#endif
+
 	/*
 	 * Restore ISENABLER, ISPENDR and ISACTIVER after the interrupts are
 	 * configured.
 	 */
 
 	/* Restore GICD_ISENABLER for INT_IDs 32 - 1020 */
-	RESTORE_GICD_REGS(gicd_base, dist_ctx, num_ints, isenabler, ISENABLER);
+	RESTORE_GICD_SET_REGS(gicd_base, dist_ctx, num_ints, isenabler, ISENABLER);
 
 	/* Restore GICD_ISPENDR for INTIDs 32 - 1020 */
-	RESTORE_GICD_REGS(gicd_base, dist_ctx, num_ints, ispendr, ISPENDR);
+	RESTORE_GICD_SET_REGS(gicd_base, dist_ctx, num_ints, ispendr, ISPENDR);
 
 	/* Restore GICD_ISACTIVER for INTIDs 32 - 1020 */
-	RESTORE_GICD_REGS(gicd_base, dist_ctx, num_ints, isactiver, ISACTIVER);
+	RESTORE_GICD_SET_REGS(gicd_base, dist_ctx, num_ints, isactiver, ISACTIVER);
 
 	/* Restore the GICD_CTLR */
 	gicd_write_ctlr(gicd_base, dist_ctx->gicd_ctlr);
@@ -991,6 +1231,9 @@ void gicv3_set_interrupt_type(unsigned int id, unsigned int proc_num,
 			gicd_set_igrpmodr(gicv3_driver_data->gicd_base, id);
 		else
 			gicd_clr_igrpmodr(gicv3_driver_data->gicd_base, id);
+#if GICV3_SPARSE_SAVE_RESTORE
+		gicd_secure_regs_dirty |= GICD_SPI_BLOCK_BIT(id);
+#endif
 		spin_unlock(&gic_lock);
 	}
 }
@@ -1034,6 +1277,51 @@ void gicv3_raise_secure_g0_sgi(int sgi_num, u_register_t target)
 	isb();
 }
 
+#if GICV3_USE_PCPU_CACHE
+/*******************************************************************************
+ * This function raises the specified Secure Group 0 SGI on the CPU identified
+ * by its linear index, using the target fields cached in its cpu_data.
+ ******************************************************************************/
+void gicv3_raise_secure_g0_sgi_by_index(int sgi_num, unsigned int core_pos)
+{
+	uint64_t sgi_val;
+
+	/* Verify interrupt number is in the SGI range */
+	assert((sgi_num >= MIN_SGI_ID) && (sgi_num < MIN_PPI_ID));
+	assert(core_pos < PLATFORM_CORE_COUNT);
+
+	sgi_val = get_cpu_data_by_index(core_pos, gicv3_cpu_data.sgi_target);
+
+	/* Ensure that GICv3 SGI can target this PE */
+	assert(sgi_val != 0U);
+	sgi_val |= (uint64_t)(sgi_num & SGIR_INTID_MASK) << SGIR_INTID_SHIFT;
+
+	/*
+	 * Ensure that any shared variable updates depending on out of band
+	 * interrupt trigger are observed before raising SGI.
+	 */
+	dsbishst();
+	write_icc_sgi0r_el1(sgi_val);
+	isb();
+}
+
+/*******************************************************************************
+ * This function routes the given SPI interrupt id to the CPU identified by its
+ * linear index, using the routing value cached in its cpu_data.
+ ******************************************************************************/
+void gicv3_set_spi_routing_by_index(unsigned int id, unsigned int core_pos)
+{
+	assert(gicv3_driver_data);
+	assert(gicv3_driver_data->gicd_base);
+
+	assert(id >= MIN_SPI_ID && id <= MAX_SPI_ID);
+	assert(core_pos < PLATFORM_CORE_COUNT);
+
+	gicd_write_irouter(gicv3_driver_data->gicd_base, id,
+		get_cpu_data_by_index(core_pos, gicv3_cpu_data.irouter_val));
+}
+#endif /* GICV3_USE_PCPU_CACHE */
+
 /*******************************************************************************
  * This function sets the interrupt routing for the given SPI interrupt id.
  * The interrupt routing is specified in routing mode and mpidr.
@@ -4,15 +4,44 @@
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
+#include <arch.h>
+#include <arch_helpers.h>
 #include <assert.h>
+#include <debug.h>
 #include <delay_timer.h>
+#include <errno.h>
 #include <platform_def.h>
 
+#define NSEC_PER_SEC		1000000000ULL
+
+/* Length of the delay measured by delay_timer_calibrate() */
+#define CALIB_DELAY_US		100
+
+/* Length of the delay over which delay_counter_init() checks the counter */
+#define CNT_CHECK_DELAY_US	10
+
 /***********************************************************
  * The delay timer implementation
  ***********************************************************/
 static const timer_ops_t *ops;
 
+/***********************************************************
+ * State of the system counter, set up by delay_counter_init()
+ *
+ * 'cnt_freq'    : Frequency of the counter in Hz, or 0 if the
+ *                 counter can't be used.
+ * 'evnt_bit'    : Counter bit whose transitions generate the
+ *                 event stream while waiting. An event occurs
+ *                 every 2^(evnt_bit + 1) ticks, which is at
+ *                 most a microsecond if the counter runs at
+ *                 2 MHz or more.
+ * 'wait_ticks'  : Ticks spent in ndelay() besides waiting,
+ *                 measured by delay_timer_calibrate().
+ ***********************************************************/
+static uint64_t cnt_freq;
+static unsigned int evnt_bit;
+static uint64_t wait_ticks;
+
 /***********************************************************
  * Delay for the given number of microseconds. The driver must
  * be initialized before calling this function.
@@ -64,3 +93,170 @@ void timer_init(const timer_ops_t *ops_ptr)
 
 	ops = ops_ptr;
 }
+
+/***********************************************************
+ * Set up the deadline API for a system counter running at
+ * 'freq' Hz. This is done once, when the platform sets up its
+ * delay timer, before any deadline is computed or waited for.
+ *
+ * If a timer was given to timer_init() beforehand, the counter
+ * is checked to progress across a delay on that timer. When
+ * it doesn't, or when 'freq' is 0, the deadline API is left
+ * unusable, which delay_counter_freq() reports.
+ ***********************************************************/
+void delay_counter_init(unsigned int freq)
+{
+	uint64_t ticks_per_us, start;
+
+	cnt_freq = 0;
+	if (freq == 0) {
+		WARN("Delay timer: the system counter frequency is unknown\n");
+		return;
+	}
+
+	if (ops != NULL) {
+		start = read_cntpct_el0();
+		udelay(CNT_CHECK_DELAY_US);
+		if (read_cntpct_el0() == start) {
+			WARN("Delay timer: the system counter isn't running\n");
+			return;
+		}
+	}
+
+	cnt_freq = freq;
+
+	ticks_per_us = cnt_freq / 1000000;
+	evnt_bit = 0;
+	while ((evnt_bit < EVNTI_MASK) && ((4ULL << evnt_bit) <= ticks_per_us))
+		evnt_bit++;
+}
+
+/***********************************************************
+ * Return the frequency of the system counter in Hz, or 0 if
+ * the deadline API can't be used.
+ ***********************************************************/
+unsigned int delay_counter_freq(void)
+{
+	return (unsigned int)cnt_freq;
+}
+
+/***********************************************************
+ * Return the counter value 'nsec' nanoseconds from now,
+ * rounded up to the next counter tick.
+ ***********************************************************/
+uint64_t delay_deadline_ns(uint64_t nsec)
+{
+	uint64_t ticks;
+
+	assert(cnt_freq != 0);
+
+	ticks = (nsec / NSEC_PER_SEC) * cnt_freq;
+	ticks += ((nsec % NSEC_PER_SEC) * cnt_freq + NSEC_PER_SEC - 1) /
+		NSEC_PER_SEC;
+
+	return read_cntpct_el0() + ticks;
+}
+
+/***********************************************************
+ * Return 1 if the counter has reached 'deadline', 0 otherwise.
+ ***********************************************************/
+int delay_expired(uint64_t deadline)
+{
+	return read_cntpct_el0() >= deadline;
+}
+
+/***********************************************************
+ * Wait until the counter reaches 'deadline'. While more than
+ * one event stream period remains, the core waits in WFE and
+ * is woken up by the event stream. The remainder is polled,
+ * so the wait doesn't end later than a tight loop would.
+ *
+ * The event stream is controlled by CNTKCTL, which belongs to
+ * the lower exception levels when running at EL3, so its
+ * value is restored afterwards.
+ ***********************************************************/
+void delay_wait_until(uint64_t deadline)
+{
+	u_register_t cntkctl;
+	uint64_t period;
+
+	assert(cnt_freq != 0);
+	period = 2ULL << evnt_bit;
+
+	if (read_cntpct_el0() + period < deadline) {
+		cntkctl = read_cntkctl_el1();
+		write_cntkctl_el1((cntkctl & ~(EVNTDIR_BIT |
+				(EVNTI_MASK << EVNTI_SHIFT))) |
+				(evnt_bit << EVNTI_SHIFT) | EVNTEN_BIT);
+		isb();
+
+		/* An event is generated at least once per period */
+		while (read_cntpct_el0() + period < deadline)
+			wfe();
+
+		write_cntkctl_el1(cntkctl);
+		isb();
+	}
+
+	while (read_cntpct_el0() < deadline)
+		;
+}
+
+/***********************************************************
+ * Delay for the given number of nanoseconds. The fixed cost
+ * of the call is deducted once delay_timer_calibrate() has
+ * measured it. This doesn't need timer_init(), only
+ * delay_counter_init().
+ ***********************************************************/
+void ndelay(uint64_t nsec)
+{
+	uint64_t deadline = delay_deadline_ns(nsec);
+
+	if (deadline - wait_ticks > read_cntpct_el0())
+		deadline -= wait_ticks;
+
+	delay_wait_until(deadline);
+}
+
+/***********************************************************
+ * Measure the fixed cost of ndelay() on the system counter,
+ * and check the timer given to timer_init() if any against
+ * the counter with a delay of CALIB_DELAY_US microseconds.
+ * Returns 0 on success, -ENODEV if the counter can't be used,
+ * or -ERANGE if the delay measured on the counter differs from
+ * the expected one by more than 1/16th.
+ ***********************************************************/
+int delay_timer_calibrate(void)
+{
+	uint64_t start, elapsed, expected;
+
+	if (cnt_freq == 0)
+		return -ENODEV;
+
+	wait_ticks = 0;
+	start = read_cntpct_el0();
+	ndelay(0);
+	wait_ticks = read_cntpct_el0() - start;
+
+	if (ops == NULL)
+		return 0;
+
+	expected = (CALIB_DELAY_US * cnt_freq) / 1000000;
+	start = read_cntpct_el0();
+	udelay(CALIB_DELAY_US);
+	elapsed = read_cntpct_el0() - start;
+
+	VERBOSE("Delay timer: %u us took %llu counter ticks (%llu expected)\n",
+		CALIB_DELAY_US, (unsigned long long)elapsed,
+		(unsigned long long)expected);
+
+	if ((elapsed < expected - expected / 16) ||
+	    (elapsed > expected + expected / 16)) {
+		WARN("Delay timer: %u us took %llu counter ticks, not %llu\n",
+		     CALIB_DELAY_US, (unsigned long long)elapsed,
+		     (unsigned long long)expected);
+		return -ERANGE;
+	}
+
+	return 0;
+}
@@ -35,6 +35,9 @@ void generic_delay_timer_init_args(uint32_t mult, uint32_t div)
 	ops.clk_div		= div;
 
 	timer_init(&ops);
+#if DELAY_TIMER_CALIBRATE
+	delay_timer_calibrate();
+#endif
 
 	VERBOSE("Generic delay timer configured with mult=%u and div=%u\n",
 		mult, div);
@@ -48,6 +51,9 @@ void generic_delay_timer_init(void)
 	/* Value in ticks per second (Hz) */
 	unsigned int div  = plat_get_syscnt_freq2();
 
+	/* The deadline API runs on the same counter */
+	delay_counter_init(div);
+
 	/* Reduce multiplier and divider by dividing them repeatedly by 10 */
 	while ((mult % 10 == 0) && (div % 10 == 0)) {
 		mult /= 10;
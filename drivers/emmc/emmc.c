@@ -11,54 +11,151 @@
 #include <debug.h>
 #include <emmc.h>
 #include <errno.h>
+#include <mmio_poll.h>
 #include <string.h>
 #include <utils.h>
 
+/*
+ * Large reads are split into transfers of this size, or of the largest
+ * transfer of the host controller if smaller, so the host controller can set
+ * up the next transfer while the current one is in flight.
+ */
+#define EMMC_READ_CHUNK_SIZE		(1 << 20)
+
+/* Timeouts of the waits on the device, in microseconds */
+#define EMMC_OCR_TIMEOUT_US		1000000
+#define EMMC_BUSY_TIMEOUT_US		1000000
+#define EMMC_ERASE_TIMEOUT_US		60000000
+
 static const emmc_ops_t *ops;
 static unsigned int emmc_ocr_value;
 static emmc_csd_t emmc_csd;
 static unsigned int emmc_flags;
+static emmc_stats_t emmc_stats;
+static size_t emmc_read_chunk;
+static unsigned char emmc_ext_csd[EMMC_BLOCK_SIZE] __aligned(EMMC_BLOCK_SIZE);
+
+MMIO_POLL_STATS(emmc_ready_poll);
+MMIO_POLL_STATS(emmc_switch_poll);
+MMIO_POLL_STATS(emmc_ocr_poll);
+MMIO_POLL_STATS(emmc_enum_tran_poll);
+MMIO_POLL_STATS(emmc_erase_tran_poll);
+
+static int emmc_send_cmd(emmc_cmd_t *cmd)
+{
+	emmc_stats.cmds++;
+	return ops->send_cmd(cmd);
+}
 
 static int is_cmd23_enabled(void)
 {
 	return (!!(emmc_flags & EMMC_FLAG_CMD23));
 }
 
-static int emmc_device_state(void)
+static int emmc_send_status(unsigned int *status)
 {
 	emmc_cmd_t cmd;
 	int ret;
 
-	do {
-		zeromem(&cmd, sizeof(emmc_cmd_t));
-		cmd.cmd_idx = EMMC_CMD13;
-		cmd.cmd_arg = EMMC_FIX_RCA << RCA_SHIFT_OFFSET;
-		cmd.resp_type = EMMC_RESPONSE_R1;
-		ret = ops->send_cmd(&cmd);
-		assert(ret == 0);
-		assert((cmd.resp_data[0] & STATUS_SWITCH_ERROR) == 0);
-		/* Ignore improbable errors in release builds */
-		(void)ret;
-	} while ((cmd.resp_data[0] & STATUS_READY_FOR_DATA) == 0);
-	return EMMC_GET_STATE(cmd.resp_data[0]);
+	zeromem(&cmd, sizeof(emmc_cmd_t));
+	cmd.cmd_idx = EMMC_CMD13;
+	cmd.cmd_arg = EMMC_FIX_RCA << RCA_SHIFT_OFFSET;
+	cmd.resp_type = EMMC_RESPONSE_R1;
+	ret = emmc_send_cmd(&cmd);
+	*status = cmd.resp_data[0];
+	return ret;
 }
 
-static void emmc_set_ext_csd(unsigned int ext_cmd, unsigned int value)
+/*
+ * Wait until the device is ready for data. Returns the state of the device or
+ * a negative error code.
+ */
+static int emmc_device_state(void)
+{
+	unsigned int status;
+	mmio_poll_t poll;
+	int ret;
+
+	mmio_poll_start(&poll, &emmc_ready_poll, EMMC_BUSY_TIMEOUT_US);
+	while (1) {
+		ret = emmc_send_status(&status);
+		if (ret != 0)
+			return ret;
+		if ((status & STATUS_SWITCH_ERROR) != 0)
+			return -EIO;
+		if ((status & STATUS_READY_FOR_DATA) != 0)
+			break;
+		if (mmio_poll_wait(&poll) != 0) {
+			ERROR("eMMC: not ready for data, status:0x%x\n",
+			      status);
+			return -ETIMEDOUT;
+		}
+	}
+	mmio_poll_done(&poll);
+	return EMMC_GET_STATE(status);
+}
+
+/* Wait until the device is back in the transfer state */
+static int emmc_wait_tran(mmio_poll_stats_t *stats, uint32_t timeout_us)
+{
+	mmio_poll_t poll;
+	int state;
+
+	mmio_poll_start(&poll, stats, timeout_us);
+	while (1) {
+		state = emmc_device_state();
+		if (state == EMMC_STATE_TRAN)
+			break;
+		if ((state < 0) || (mmio_poll_wait(&poll) != 0)) {
+			ERROR("eMMC: not in transfer state, state:%d\n",
+			      state);
+			return -ETIMEDOUT;
+		}
+	}
+	mmio_poll_done(&poll);
+	return 0;
+}
+
+/* Write a byte of EXT CSD, returning an error instead of asserting */
+static int emmc_switch(unsigned int ext_cmd, unsigned int value)
 {
 	emmc_cmd_t cmd;
-	int ret, state;
+	unsigned int status;
+	mmio_poll_t poll;
+	int ret;
 
 	zeromem(&cmd, sizeof(emmc_cmd_t));
 	cmd.cmd_idx = EMMC_CMD6;
 	cmd.cmd_arg = EXTCSD_WRITE_BYTES | EXTCSD_CMD(ext_cmd) |
 		      EXTCSD_VALUE(value) | 1;
-	ret = ops->send_cmd(&cmd);
-	assert(ret == 0);
+	ret = emmc_send_cmd(&cmd);
+	if (ret != 0)
+		return ret;
 
 	/* wait to exit PRG state */
-	do {
-		state = emmc_device_state();
-	} while (state == EMMC_STATE_PRG);
+	mmio_poll_start(&poll, &emmc_switch_poll, EMMC_BUSY_TIMEOUT_US);
+	while (1) {
+		ret = emmc_send_status(&status);
+		if (ret != 0)
+			return ret;
+		if (((status & STATUS_READY_FOR_DATA) != 0) &&
+		    (EMMC_GET_STATE(status) != EMMC_STATE_PRG))
+			break;
+		if (mmio_poll_wait(&poll) != 0)
+			return -ETIMEDOUT;
+	}
+	mmio_poll_done(&poll);
+	if ((status & STATUS_SWITCH_ERROR) != 0)
+		return -EIO;
+	return 0;
+}
+
+static void emmc_set_ext_csd(unsigned int ext_cmd, unsigned int value)
+{
+	int ret;
+
+	ret = emmc_switch(ext_cmd, value);
+	assert(ret == 0);
 	/* Ignore improbable errors in release builds */
 	(void)ret;
 }
@@ -76,19 +173,160 @@ static void emmc_set_ios(int clk, int bus_width)
 	(void)ret;
 }
 
+static int emmc_read_ext_csd(void)
+{
+	emmc_cmd_t cmd;
+	uintptr_t buf;
+	int ret;
+
+	buf = (uintptr_t)emmc_ext_csd;
+	inv_dcache_range(buf, sizeof(emmc_ext_csd));
+	ret = ops->prepare(0, buf, sizeof(emmc_ext_csd));
+	if (ret != 0)
+		return ret;
+
+	zeromem(&cmd, sizeof(emmc_cmd_t));
+	cmd.cmd_idx = EMMC_CMD8;
+	cmd.resp_type = EMMC_RESPONSE_R1;
+	ret = emmc_send_cmd(&cmd);
+	if (ret != 0)
+		return ret;
+	ret = ops->read(0, buf, sizeof(emmc_ext_csd));
+	if (ret != 0)
+		return ret;
+
+	/* wait buffer empty */
+	ret = emmc_device_state();
+	if (ret < 0)
+		return ret;
+	inv_dcache_range(buf, sizeof(emmc_ext_csd));
+	return 0;
+}
+
+static int emmc_select_hs200(int clk, int bus_width)
+{
+	int ret;
+
+	ret = emmc_switch(CMD_EXTCSD_BUS_WIDTH, bus_width);
+	if (ret != 0)
+		return ret;
+	ret = ops->set_ios(EMMC_BOOT_CLK_RATE, bus_width);
+	if (ret != 0)
+		return ret;
+	ret = emmc_switch(CMD_EXTCSD_HS_TIMING, EMMC_TIMING_HS200);
+	if (ret != 0)
+		return ret;
+	ret = ops->set_timing(EMMC_TIMING_HS200);
+	if (ret != 0)
+		return ret;
+	ret = ops->set_ios(MIN(clk, EMMC_HS200_MAX_CLK_RATE), bus_width);
+	if (ret != 0)
+		return ret;
+	return ops->execute_tuning(EMMC_CMD21);
+}
+
+/*
+ * HS400 can only be entered from a tuned HS200 by way of HS timing. As
+ * required by JEDEC, the device is switched to HS timing before the host
+ * drops to 52MHz, and to HS400 before the host raises the clock again.
+ */
+static int emmc_select_hs400(int clk)
+{
+	int ret;
+
+	ret = emmc_switch(CMD_EXTCSD_HS_TIMING, EMMC_TIMING_HS);
+	if (ret != 0)
+		return ret;
+	ret = ops->set_timing(EMMC_TIMING_HS);
+	if (ret != 0)
+		return ret;
+	ret = ops->set_ios(MIN(clk, EMMC_HS_MAX_CLK_RATE), EMMC_BUS_WIDTH_8);
+	if (ret != 0)
+		return ret;
+	ret = emmc_switch(CMD_EXTCSD_BUS_WIDTH, EMMC_BUS_WIDTH_DDR_8);
+	if (ret != 0)
+		return ret;
+	ret = emmc_switch(CMD_EXTCSD_HS_TIMING, EMMC_TIMING_HS400);
+	if (ret != 0)
+		return ret;
+	ret = ops->set_timing(EMMC_TIMING_HS400);
+	if (ret != 0)
+		return ret;
+	return ops->set_ios(MIN(clk, EMMC_HS200_MAX_CLK_RATE),
+			    EMMC_BUS_WIDTH_8);
+}
+
+/* Go back to the legacy timing after a failed switch */
+static void emmc_reset_timing(int bus_width)
+{
+	ops->set_timing(EMMC_TIMING_LEGACY);
+	ops->set_ios(EMMC_BOOT_CLK_RATE, bus_width);
+	(void)emmc_switch(CMD_EXTCSD_HS_TIMING, EMMC_TIMING_LEGACY);
+}
+
+/*
+ * Switch to the fastest timing allowed by emmc_flags that both the device
+ * and the host controller support. Returns 0 when HS200 or HS400 is in use.
+ */
+static int emmc_select_timing(int clk, int bus_width)
+{
+	unsigned int type;
+	int ret;
+
+	if (((emmc_flags & (EMMC_FLAG_HS200 | EMMC_FLAG_HS400)) == 0) ||
+	    (ops->set_timing == NULL) || (ops->execute_tuning == NULL) ||
+	    (emmc_csd.spec_vers != 4) || (bus_width == EMMC_BUS_WIDTH_1))
+		return -ENOTSUP;
+
+	ret = emmc_read_ext_csd();
+	if (ret != 0)
+		return ret;
+	type = emmc_ext_csd[CMD_EXTCSD_DEVICE_TYPE];
+
+	if (((emmc_flags & EMMC_FLAG_HS400) != 0) &&
+	    (bus_width == EMMC_BUS_WIDTH_8) &&
+	    ((type & (EXTCSD_DEVICE_TYPE_HS400_1V8 |
+		      EXTCSD_DEVICE_TYPE_HS400_1V2)) != 0)) {
+		ret = emmc_select_hs200(clk, bus_width);
+		if (ret == 0)
+			ret = emmc_select_hs400(clk);
+		if (ret == 0) {
+			INFO("eMMC: HS400 mode\n");
+			return 0;
+		}
+		WARN("eMMC: failed to switch to HS400 (%d)\n", ret);
+		emmc_reset_timing(bus_width);
+	}
+
+	if (((emmc_flags & EMMC_FLAG_HS200) != 0) &&
+	    ((type & (EXTCSD_DEVICE_TYPE_HS200_1V8 |
+		      EXTCSD_DEVICE_TYPE_HS200_1V2)) != 0)) {
+		ret = emmc_select_hs200(clk, bus_width);
+		if (ret == 0) {
+			INFO("eMMC: HS200 mode\n");
+			return 0;
+		}
+		WARN("eMMC: failed to switch to HS200 (%d)\n", ret);
+		emmc_reset_timing(bus_width);
+	}
+	return -ENOTSUP;
+}
+
 static int emmc_enumerate(int clk, int bus_width)
 {
 	emmc_cmd_t cmd;
-	int ret, state;
+	mmio_poll_t poll;
+	int ret;
 
 	ops->init();
 
 	/* CMD0: reset to IDLE */
 	zeromem(&cmd, sizeof(emmc_cmd_t));
 	cmd.cmd_idx = EMMC_CMD0;
-	ret = ops->send_cmd(&cmd);
+	ret = emmc_send_cmd(&cmd);
 	assert(ret == 0);
 
+	mmio_poll_start(&poll, &emmc_ocr_poll, EMMC_OCR_TIMEOUT_US);
 	while (1) {
 		/* CMD1: get OCR register */
 		zeromem(&cmd, sizeof(emmc_cmd_t));
@@ -96,18 +334,24 @@ static int emmc_enumerate(int clk, int bus_width)
 		cmd.cmd_arg = OCR_SECTOR_MODE | OCR_VDD_MIN_2V7 |
 			      OCR_VDD_MIN_1V7;
 		cmd.resp_type = EMMC_RESPONSE_R3;
-		ret = ops->send_cmd(&cmd);
+		ret = emmc_send_cmd(&cmd);
 		assert(ret == 0);
 		emmc_ocr_value = cmd.resp_data[0];
 		if (emmc_ocr_value & OCR_POWERUP)
 			break;
+		if (mmio_poll_wait(&poll) != 0) {
+			ERROR("eMMC: power up timed out, OCR:0x%x\n",
+			      emmc_ocr_value);
+			return -ETIMEDOUT;
+		}
 	}
+	mmio_poll_done(&poll);
 
 	/* CMD2: Card Identification */
 	zeromem(&cmd, sizeof(emmc_cmd_t));
 	cmd.cmd_idx = EMMC_CMD2;
 	cmd.resp_type = EMMC_RESPONSE_R2;
-	ret = ops->send_cmd(&cmd);
+	ret = emmc_send_cmd(&cmd);
 	assert(ret == 0);
 
 	/* CMD3: Set Relative Address */
@@ -115,7 +359,7 @@ static int emmc_enumerate(int clk, int bus_width)
 	cmd.cmd_idx = EMMC_CMD3;
 	cmd.cmd_arg = EMMC_FIX_RCA << RCA_SHIFT_OFFSET;
 	cmd.resp_type = EMMC_RESPONSE_R1;
-	ret = ops->send_cmd(&cmd);
+	ret = emmc_send_cmd(&cmd);
 	assert(ret == 0);
 
 	/* CMD9: CSD Register */
@@ -123,7 +367,7 @@ static int emmc_enumerate(int clk, int bus_width)
 	cmd.cmd_idx = EMMC_CMD9;
 	cmd.cmd_arg = EMMC_FIX_RCA << RCA_SHIFT_OFFSET;
 	cmd.resp_type = EMMC_RESPONSE_R2;
-	ret = ops->send_cmd(&cmd);
+	ret = emmc_send_cmd(&cmd);
 	assert(ret == 0);
 	memcpy(&emmc_csd, &cmd.resp_data, sizeof(cmd.resp_data));
 
@@ -132,43 +376,38 @@ static int emmc_enumerate(int clk, int bus_width)
 	cmd.cmd_idx = EMMC_CMD7;
 	cmd.cmd_arg = EMMC_FIX_RCA << RCA_SHIFT_OFFSET;
 	cmd.resp_type = EMMC_RESPONSE_R1;
-	ret = ops->send_cmd(&cmd);
+	ret = emmc_send_cmd(&cmd);
 	assert(ret == 0);
 	/* wait to TRAN state */
-	do {
-		state = emmc_device_state();
-	} while (state != EMMC_STATE_TRAN);
+	ret = emmc_wait_tran(&emmc_enum_tran_poll, EMMC_BUSY_TIMEOUT_US);
+	if (ret != 0)
+		return ret;
 
-	emmc_set_ios(clk, bus_width);
+	/* fall back to the legacy timing if HS200/HS400 can't be used */
+	if (emmc_select_timing(clk, bus_width) != 0)
+		emmc_set_ios(clk, bus_width);
 	return ret;
 }
 
-size_t emmc_read_blocks(int lba, uintptr_t buf, size_t size)
+/* Send the commands starting a read, whose descriptors are prepared */
+static void emmc_start_read(int lba, size_t size)
 {
 	emmc_cmd_t cmd;
 	int ret;
 
-	assert((ops != 0) &&
-	       (ops->read != 0) &&
-	       ((buf & EMMC_BLOCK_MASK) == 0) &&
-	       ((size & EMMC_BLOCK_MASK) == 0));
-
-	inv_dcache_range(buf, size);
-	ret = ops->prepare(lba, buf, size);
-	assert(ret == 0);
-
 	if (is_cmd23_enabled()) {
 		zeromem(&cmd, sizeof(emmc_cmd_t));
 		/* set block count */
 		cmd.cmd_idx = EMMC_CMD23;
 		cmd.cmd_arg = size / EMMC_BLOCK_SIZE;
 		cmd.resp_type = EMMC_RESPONSE_R1;
-		ret = ops->send_cmd(&cmd);
+		ret = emmc_send_cmd(&cmd);
 		assert(ret == 0);
 
 		zeromem(&cmd, sizeof(emmc_cmd_t));
 		cmd.cmd_idx = EMMC_CMD18;
 	} else {
+		zeromem(&cmd, sizeof(emmc_cmd_t));
 		if (size > EMMC_BLOCK_SIZE)
 			cmd.cmd_idx = EMMC_CMD18;
 		else
@@ -179,26 +418,81 @@ size_t emmc_read_blocks(int lba, uintptr_t buf, size_t size)
 	else
 		cmd.cmd_arg = lba;
 	cmd.resp_type = EMMC_RESPONSE_R1;
-	ret = ops->send_cmd(&cmd);
+	ret = emmc_send_cmd(&cmd);
 	assert(ret == 0);
+	/* Ignore improbable errors in release builds */
+	(void)ret;
+}
+
+static int emmc_finish_read(int lba, uintptr_t buf, size_t size)
+{
+	emmc_cmd_t cmd;
+	int ret;
 
 	ret = ops->read(lba, buf, size);
 	assert(ret == 0);
 
 	/* wait buffer empty */
-	emmc_device_state();
+	ret = emmc_device_state();
+	if (ret < 0)
+		return ret;
 
 	if (is_cmd23_enabled() == 0) {
 		if (size > EMMC_BLOCK_SIZE) {
 			zeromem(&cmd, sizeof(emmc_cmd_t));
 			cmd.cmd_idx = EMMC_CMD12;
-			ret = ops->send_cmd(&cmd);
+			ret = emmc_send_cmd(&cmd);
 			assert(ret == 0);
 		}
 	}
 	/* Ignore improbable errors in release builds */
 	(void)ret;
-	return size;
+	return 0;
+}
+
+/*
+ * Reads are issued in chunks of emmc_read_chunk bytes. The next chunk is
+ * prepared right after the current one is started, so building and cleaning
+ * its DMA descriptors overlaps with the data transfer. If the device doesn't
+ * complete a chunk, the size of the chunks read before is returned.
+ */
+size_t emmc_read_blocks(int lba, uintptr_t buf, size_t size)
+{
+	size_t offset, chunk, next;
+	unsigned long long start;
+	int ret;
+
+	assert((ops != 0) &&
+	       (ops->read != 0) &&
+	       ((buf & EMMC_BLOCK_MASK) == 0) &&
+	       ((size & EMMC_BLOCK_MASK) == 0));
+
+	start = read_cntpct_el0();
+	inv_dcache_range(buf, size);
+	chunk = MIN(size, emmc_read_chunk);
+	ret = ops->prepare(lba, buf, chunk);
+	assert(ret == 0);
+
+	for (offset = 0; offset < size; offset = next) {
+		chunk = MIN(size - offset, emmc_read_chunk);
+		next = offset + chunk;
+		emmc_start_read(lba + (offset / EMMC_BLOCK_SIZE), chunk);
+		if (next < size) {
+			ret = ops->prepare(lba + (next / EMMC_BLOCK_SIZE),
+					   buf + next,
+					   MIN(size - next,
+					       emmc_read_chunk));
+			assert(ret == 0);
+		}
+		ret = emmc_finish_read(lba + (offset / EMMC_BLOCK_SIZE),
+				       buf + offset, chunk);
+		if (ret != 0)
+			break;
+	}
+
+	emmc_stats.bytes_read += offset;
+	emmc_stats.read_ticks += read_cntpct_el0() - start;
+	return offset;
 }
 
 size_t emmc_write_blocks(int lba, const uintptr_t buf, size_t size)
@@ -221,7 +515,7 @@ size_t emmc_write_blocks(int lba, const uintptr_t buf, size_t size)
 		cmd.cmd_idx = EMMC_CMD23;
 		cmd.cmd_arg = size / EMMC_BLOCK_SIZE;
 		cmd.resp_type = EMMC_RESPONSE_R1;
-		ret = ops->send_cmd(&cmd);
+		ret = emmc_send_cmd(&cmd);
 		assert(ret == 0);
 
 		zeromem(&cmd, sizeof(emmc_cmd_t));
@@ -238,20 +532,22 @@ size_t emmc_write_blocks(int lba, const uintptr_t buf, size_t size)
 	else
 		cmd.cmd_arg = lba;
 	cmd.resp_type = EMMC_RESPONSE_R1;
-	ret = ops->send_cmd(&cmd);
+	ret = emmc_send_cmd(&cmd);
 	assert(ret == 0);
 
 	ret = ops->write(lba, buf, size);
 	assert(ret == 0);
 
 	/* wait buffer empty */
-	emmc_device_state();
+	ret = emmc_device_state();
+	if (ret < 0)
+		return 0;
 
 	if (is_cmd23_enabled() == 0) {
 		if (size > EMMC_BLOCK_SIZE) {
 			zeromem(&cmd, sizeof(emmc_cmd_t));
 			cmd.cmd_idx = EMMC_CMD12;
-			ret = ops->send_cmd(&cmd);
+			ret = emmc_send_cmd(&cmd);
 			assert(ret == 0);
 		}
 	}
@@ -263,7 +559,7 @@ size_t emmc_write_blocks(int lba, const uintptr_t buf, size_t size)
 size_t emmc_erase_blocks(int lba, size_t size)
 {
 	emmc_cmd_t cmd;
-	int ret, state;
+	int ret;
 
 	assert(ops != 0);
 	assert((size != 0) && ((size % EMMC_BLOCK_SIZE) == 0));
@@ -272,26 +568,25 @@ size_t emmc_erase_blocks(int lba, size_t size)
 	cmd.cmd_idx = EMMC_CMD35;
 	cmd.cmd_arg = lba;
 	cmd.resp_type = EMMC_RESPONSE_R1;
-	ret = ops->send_cmd(&cmd);
+	ret = emmc_send_cmd(&cmd);
 	assert(ret == 0);
 
 	zeromem(&cmd, sizeof(emmc_cmd_t));
 	cmd.cmd_idx = EMMC_CMD36;
 	cmd.cmd_arg = lba + (size / EMMC_BLOCK_SIZE) - 1;
 	cmd.resp_type = EMMC_RESPONSE_R1;
-	ret = ops->send_cmd(&cmd);
+	ret = emmc_send_cmd(&cmd);
 	assert(ret == 0);
 
 	zeromem(&cmd, sizeof(emmc_cmd_t));
 	cmd.cmd_idx = EMMC_CMD38;
 	cmd.resp_type = EMMC_RESPONSE_R1B;
-	ret = ops->send_cmd(&cmd);
+	ret = emmc_send_cmd(&cmd);
 	assert(ret == 0);
 
 	/* wait to TRAN state */
-	do {
-		state = emmc_device_state();
-	} while (state != EMMC_STATE_TRAN);
+	ret = emmc_wait_tran(&emmc_erase_tran_poll, EMMC_ERASE_TIMEOUT_US);
+	assert(ret == 0);
 	/* Ignore improbable errors in release builds */
 	(void)ret;
 	return size;
@@ -340,6 +635,12 @@ size_t emmc_rpmb_erase_blocks(int lba, size_t size)
 	return size_erased;
 }
 
+void emmc_get_stats(emmc_stats_t *stats)
+{
+	assert(stats != NULL);
+	memcpy(stats, &emmc_stats, sizeof(emmc_stats_t));
+}
+
 void emmc_init(const emmc_ops_t *ops_ptr, int clk, int width,
 	       unsigned int flags)
 {
@@ -357,5 +658,13 @@ void emmc_init(const emmc_ops_t *ops_ptr, int clk, int width,
 	ops = ops_ptr;
 	emmc_flags = flags;
 
+	emmc_read_chunk = EMMC_READ_CHUNK_SIZE;
+	if (ops->max_transfer != NULL) {
+		emmc_read_chunk = MIN(emmc_read_chunk,
+				      ops->max_transfer() &
+				      ~(size_t)EMMC_BLOCK_MASK);
+	}
+	assert(emmc_read_chunk >= EMMC_BLOCK_SIZE);
+
 	emmc_enumerate(clk, width);
 }
@@ -1,9 +1,10 @@
 /*
- * Copyright (c) 2016, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2016-2017, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
+#include <arch_helpers.h>
 #include <assert.h>
 #include <debug.h>
 #include <gpt.h>
@@ -11,9 +12,43 @@
 #include <mbr.h>
 #include <partition.h>
 #include <platform.h>
+#include <stddef.h>
 #include <string.h>
+#include <utils_def.h>
 
-static uint8_t mbr_sector[PARTITION_BLOCK_SIZE];
+/*
+ * The GPT entry array is read this many blocks at a time. It is typically
+ * 32 blocks long (128 entries of 128 bytes).
+ */
+#define PARTITION_READ_BLOCKS		8
+#define PARTITION_BUF_SIZE		(PARTITION_READ_BLOCKS *	\
+					 PARTITION_BLOCK_SIZE)
+
+/*
+ * Smallest power of two greater than or equal to x, for 0 < x <= 2^31. It is
+ * a constant expression, with x evaluated many times.
+ */
+#define POW2_SMEAR(x, shift)		((x) | ((x) >> (shift)))
+#define POW2_CEIL(x)							\
+	(POW2_SMEAR(POW2_SMEAR(POW2_SMEAR(POW2_SMEAR(POW2_SMEAR(	\
+		(x) - 1, 1), 2), 4), 8), 16) + 1)
+
+/*
+ * Open addressed hash table mapping partition names to entries. It is at
+ * least twice as large as the entry list to keep probe sequences short, and
+ * rounded up to a power of two so that slots are found with a mask.
+ * Slots hold the index of the entry plus one, zero marks an empty slot.
+ */
+#define PARTITION_HASH_SIZE		POW2_CEIL(2 * PLAT_PARTITION_MAX_ENTRIES)
+
+CASSERT(IS_POWER_OF_TWO(PARTITION_HASH_SIZE), assert_partition_hash_size);
+/* The slots are bytes, so the entry index plus one must fit in 8 bits */
+CASSERT(PLAT_PARTITION_MAX_ENTRIES < 255, assert_partition_hash_index);
+
+/* Buffer holding the MBR, the GPT header and chunks of the entry array */
+static uint8_t partition_buf[PARTITION_BUF_SIZE]
+		__aligned(PARTITION_BLOCK_SIZE);
+static uint8_t partition_hash[PARTITION_HASH_SIZE];
 partition_entry_list_t list;
 
 #if LOG_LEVEL >= LOG_LEVEL_VERBOSE
@@ -37,6 +72,109 @@ static void dump_entries(int num)
 #define dump_entries(num)	((void)num)
 #endif
 
+/*
+ * CRC32 (IEEE 802.3 polynomial, as used by GPT) helpers. The software
+ * version uses a nibble-wide lookup table to keep the footprint small.
+ */
+static uint32_t crc32_sw(uint32_t crc, const uint8_t *buf, size_t size)
+{
+	static const uint32_t crc32_nibble[16] = {
+		0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac,
+		0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+		0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c,
+		0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c
+	};
+
+	while (size-- != 0) {
+		crc ^= *buf++;
+		crc = (crc >> 4) ^ crc32_nibble[crc & 0xf];
+		crc = (crc >> 4) ^ crc32_nibble[crc & 0xf];
+	}
+	return crc;
+}
+
+#ifdef AARCH64
+/* Use the CRC32 instructions when the CPU implements them. */
+static uint32_t crc32_hw(uint32_t crc, const uint8_t *buf, size_t size)
+{
+	while ((size != 0) && (((uintptr_t)buf & 7) != 0)) {
+		__asm__ volatile(".arch_extension crc\n"
+				 "crc32b %w0, %w0, %w1"
+				 : "+r" (crc) : "r" (*buf));
+		buf++;
+		size--;
+	}
+	while (size >= 8) {
+		__asm__ volatile(".arch_extension crc\n"
+				 "crc32x %w0, %w0, %x1"
+				 : "+r" (crc) : "r" (*(const uint64_t *)buf));
+		buf += 8;
+		size -= 8;
+	}
+	while (size-- != 0) {
+		__asm__ volatile(".arch_extension crc\n"
+				 "crc32b %w0, %w0, %w1"
+				 : "+r" (crc) : "r" (*buf++));
+	}
+	return crc;
+}
+
+static int crc32_hw_present(void)
+{
+	return ((read_id_aa64isar0_el1() >> ID_AA64ISAR0_CRC32_SHIFT) &
+		ID_AA64ISAR0_CRC32_MASK) != 0;
+}
+#endif
+
+/*
+ * Update a running CRC32. Start from 0 and pass the result of the previous
+ * call to checksum data in several pieces.
+ */
+static uint32_t partition_crc32(uint32_t crc, const void *buf, size_t size)
+{
+	crc = ~crc;
+#ifdef AARCH64
+	if (crc32_hw_present()) {
+		return ~crc32_hw(crc, buf, size);
+	}
+#endif
+	return ~crc32_sw(crc, buf, size);
+}
+
+/* FNV-1a hash of a partition name */
+static unsigned int partition_name_hash(const char *name)
+{
+	uint32_t hash = 2166136261U;
+
+	while (*name != '\0') {
+		hash ^= (uint8_t)*name++;
+		hash *= 16777619U;
+	}
+	return hash & (PARTITION_HASH_SIZE - 1);
+}
+
+/* Index the loaded entries by name. The first of duplicate names wins. */
+static void build_partition_hash(void)
+{
+	unsigned int slot;
+	int i;
+
+	memset(partition_hash, 0, sizeof(partition_hash));
+	for (i = 0; i < list.entry_count; i++) {
+		slot = partition_name_hash(list.list[i].name);
+		while (partition_hash[slot] != 0) {
+			if (strcmp(list.list[i].name,
+				   list.list[partition_hash[slot] - 1].name) == 0) {
+				break;
+			}
+			slot = (slot + 1) & (PARTITION_HASH_SIZE - 1);
+		}
+		if (partition_hash[slot] == 0) {
+			partition_hash[slot] = i + 1;
+		}
+	}
+}
+
 /*
  * Load the first sector that carries MBR header.
  * The MBR boot signature should be always valid whether it's MBR or GPT.
@@ -54,7 +192,7 @@ static int load_mbr_header(uintptr_t image_handle, mbr_entry_t *mbr_entry)
 		WARN("Failed to seek (%i)\n", result);
 		return result;
 	}
-	result = io_read(image_handle, (uintptr_t)&mbr_sector,
+	result = io_read(image_handle, (uintptr_t)partition_buf,
 			 PARTITION_BLOCK_SIZE, &bytes_read);
 	if (result != 0) {
 		WARN("Failed to read data (%i)\n", result);
@@ -62,73 +200,115 @@ static int load_mbr_header(uintptr_t image_handle, mbr_entry_t *mbr_entry)
 	}
 
 	/* Check MBR boot signature. */
-	if ((mbr_sector[PARTITION_BLOCK_SIZE - 2] != MBR_SIGNATURE_FIRST) ||
-	    (mbr_sector[PARTITION_BLOCK_SIZE - 1] != MBR_SIGNATURE_SECOND)) {
+	if ((partition_buf[PARTITION_BLOCK_SIZE - 2] != MBR_SIGNATURE_FIRST) ||
+	    (partition_buf[PARTITION_BLOCK_SIZE - 1] != MBR_SIGNATURE_SECOND)) {
 		return -ENOENT;
 	}
-	offset = (uintptr_t)&mbr_sector + MBR_PRIMARY_ENTRY_OFFSET;
+	offset = (uintptr_t)partition_buf + MBR_PRIMARY_ENTRY_OFFSET;
 	memcpy(mbr_entry, (void *)offset, sizeof(mbr_entry_t));
 	return 0;
 }
 
 /*
- * Load GPT header and check the GPT signature.
+ * Load GPT header, check the GPT signature and the header CRC.
  * If partiton numbers could be found, check & update it.
  */
-static int load_gpt_header(uintptr_t image_handle)
+static int load_gpt_header(uintptr_t image_handle, gpt_header_t *header)
 {
-	gpt_header_t header;
 	size_t bytes_read;
+	uint32_t crc;
 	int result;
 
 	result = io_seek(image_handle, IO_SEEK_SET, GPT_HEADER_OFFSET);
 	if (result != 0) {
 		return result;
 	}
-	result = io_read(image_handle, (uintptr_t)&header,
-			 sizeof(gpt_header_t), &bytes_read);
-	if ((result != 0) || (sizeof(gpt_header_t) != bytes_read)) {
-		return result;
+	result = io_read(image_handle, (uintptr_t)partition_buf,
+			 PARTITION_BLOCK_SIZE, &bytes_read);
+	if ((result != 0) || (bytes_read != PARTITION_BLOCK_SIZE)) {
+		return (result != 0) ? result : -EINVAL;
+	}
+	memcpy(header, partition_buf, sizeof(gpt_header_t));
+	if (memcmp(header->signature, GPT_SIGNATURE,
+		   sizeof(header->signature)) != 0) {
+		return -EINVAL;
+	}
+
+	/* The header CRC is computed with the CRC field itself zeroed. */
+	if ((header->size < offsetof(gpt_header_t, part_crc) +
+			    sizeof(header->part_crc)) ||
+	    (header->size > PARTITION_BLOCK_SIZE)) {
+		WARN("Invalid GPT header size %u\n", header->size);
+		return -EINVAL;
+	}
+	memset(partition_buf + offsetof(gpt_header_t, header_crc), 0,
+	       sizeof(header->header_crc));
+	crc = partition_crc32(0, partition_buf, header->size);
+	if (crc != header->header_crc) {
+		WARN("GPT header CRC mismatch (0x%x != 0x%x)\n", crc,
+		     header->header_crc);
+		return -EINVAL;
 	}
-	if (memcmp(header.signature, GPT_SIGNATURE,
-		   sizeof(header.signature)) != 0) {
+
+	if (header->part_size != sizeof(gpt_entry_t)) {
+		WARN("Unsupported GPT entry size %u\n", header->part_size);
 		return -EINVAL;
 	}
 
 	/* partition numbers can't exceed PLAT_PARTITION_MAX_ENTRIES */
-	list.entry_count = header.list_num;
+	list.entry_count = header->list_num;
 	if (list.entry_count > PLAT_PARTITION_MAX_ENTRIES) {
 		list.entry_count = PLAT_PARTITION_MAX_ENTRIES;
 	}
 	return 0;
 }
 
-static int load_gpt_entry(uintptr_t image_handle, gpt_entry_t *entry)
+/*
+ * Read the whole GPT entry array in chunks of PARTITION_BUF_SIZE bytes,
+ * check its CRC and parse the entries that fit in the entry list.
+ */
+static int verify_partition_gpt(uintptr_t image_handle,
+				const gpt_header_t *header)
 {
-	size_t bytes_read;
-	int result;
+	size_t bytes_read, chunk, left, offset;
+	uint32_t crc = 0;
+	int result, i = 0, last = 0;
 
-	assert(entry != NULL);
-	result = io_read(image_handle, (uintptr_t)entry, sizeof(gpt_entry_t),
-			 &bytes_read);
-	if (sizeof(gpt_entry_t) != bytes_read)
-		return -EINVAL;
-	return result;
-}
+	result = io_seek(image_handle, IO_SEEK_SET,
+			 header->part_lba * PARTITION_BLOCK_SIZE);
+	if (result != 0) {
+		return result;
+	}
 
-static int verify_partition_gpt(uintptr_t image_handle)
-{
-	gpt_entry_t entry;
-	int result, i;
+	left = (size_t)header->list_num * sizeof(gpt_entry_t);
+	while (left != 0) {
+		chunk = (left > PARTITION_BUF_SIZE) ? PARTITION_BUF_SIZE : left;
+		result = io_read(image_handle, (uintptr_t)partition_buf, chunk,
+				 &bytes_read);
+		if ((result != 0) || (bytes_read != chunk)) {
+			WARN("Failed to read GPT entries (%i)\n", result);
+			return (result != 0) ? result : -EINVAL;
+		}
+		crc = partition_crc32(crc, partition_buf, chunk);
+		left -= chunk;
 
-	for (i = 0; i < list.entry_count; i++) {
-		result = load_gpt_entry(image_handle, &entry);
-		assert(result == 0);
-		result = parse_gpt_entry(&entry, &list.list[i]);
-		if (result != 0) {
-			break;
+		for (offset = 0; (offset < chunk) && !last &&
+		     (i < list.entry_count); offset += sizeof(gpt_entry_t)) {
+			if (parse_gpt_entry((gpt_entry_t *)(partition_buf +
+							    offset),
+					    &list.list[i]) != 0) {
+				last = 1;
+			} else {
+				i++;
+			}
 		}
 	}
+
+	if (crc != header->part_crc) {
+		WARN("GPT entry array CRC mismatch (0x%x != 0x%x)\n", crc,
+		     header->part_crc);
+		return -EINVAL;
+	}
 	if (i == 0) {
 		return -EINVAL;
 	}
@@ -138,6 +318,7 @@ static int verify_partition_gpt(uintptr_t image_handle)
 	 */
 	list.entry_count = i;
 	dump_entries(list.entry_count);
+	build_partition_hash();
 
 	return 0;
 }
@@ -146,6 +327,7 @@ int load_partition_table(unsigned int image_id)
 {
 	uintptr_t dev_handle, image_handle, image_spec = 0;
 	mbr_entry_t mbr_entry;
+	gpt_header_t header;
 	int result;
 
 	result = plat_get_image_source(image_id, &dev_handle, &image_spec);
@@ -161,35 +343,47 @@ int load_partition_table(unsigned int image_id)
 		return result;
 	}
 
+	/* Forget about any previously loaded table. */
+	list.entry_count = 0;
+	memset(partition_hash, 0, sizeof(partition_hash));
+
 	result = load_mbr_header(image_handle, &mbr_entry);
 	if (result != 0) {
 		WARN("Failed to access image id=%u (%i)\n", image_id, result);
-		return result;
+		goto exit;
 	}
 	if (mbr_entry.type == PARTITION_TYPE_GPT) {
-		result = load_gpt_header(image_handle);
-		assert(result == 0);
-		result = io_seek(image_handle, IO_SEEK_SET, GPT_ENTRY_OFFSET);
-		assert(result == 0);
-		result = verify_partition_gpt(image_handle);
+		result = load_gpt_header(image_handle, &header);
+		if (result != 0) {
+			WARN("Failed to load GPT header (%i)\n", result);
+			goto exit;
+		}
+		result = verify_partition_gpt(image_handle, &header);
 	} else {
 		/* MBR type isn't supported yet. */
 		result = -EINVAL;
 		goto exit;
 	}
 exit:
+	if (result != 0) {
+		list.entry_count = 0;
+	}
 	io_close(image_handle);
 	return result;
 }
 
 const partition_entry_t *get_partition_entry(const char *name)
 {
-	int i;
+	unsigned int slot;
+	const partition_entry_t *entry;
 
-	for (i = 0; i < list.entry_count; i++) {
-		if (strcmp(name, list.list[i].name) == 0) {
-			return &list.list[i];
+	slot = partition_name_hash(name);
+	while (partition_hash[slot] != 0) {
+		entry = &list.list[partition_hash[slot] - 1];
+		if (strcmp(name, entry->name) == 0) {
+			return entry;
 		}
+		slot = (slot + 1) & (PARTITION_HASH_SIZE - 1);
 	}
 	return NULL;
 }
@@ -13,6 +13,7 @@
 #include <emmc.h>
 #include <errno.h>
 #include <mmio.h>
+#include <mmio_poll.h>
 #include <string.h>
 
 #define DWMMC_CTRL			(0x00)
@@ -81,6 +82,8 @@
 #define FIFOTH_DMA_BURST_SIZE(x)	((x & 0x7) << 28)
 
 #define DWMMC_DEBNCE			(0x64)
+#define DWMMC_UHS_REG			(0x74)
+#define UHS_REG_DDR			(1 << 16)
 #define DWMMC_BMOD			(0x80)
 #define BMOD_ENABLE			(1 << 7)
 #define BMOD_FB				(1 << 1)
@@ -105,9 +108,20 @@
 
 #define DWMMC_DMA_MAX_BUFFER_SIZE	(512 * 8)
 
+/*
+ * The descriptor area is split into two rings, so the descriptors of the next
+ * transfer can be built while the IDMAC still walks the current ones.
+ */
+#define DWMMC_NUM_RINGS			2
+
 #define DWMMC_8BIT_MODE			(1 << 6)
 
-#define TIMEOUT				100000
+/* Timeouts of the waits on the controller, in microseconds */
+#define DWMMC_RESET_TIMEOUT_US		100000
+#define DWMMC_CMD_TIMEOUT_US		1000000
+#define DWMMC_DATA_TIMEOUT_US		1000000
+
+#define DWMMC_MAX_PHASES		32
 
 struct dw_idmac_desc {
 	unsigned int	des0;
@@ -122,6 +136,9 @@ static int dw_set_ios(int clk, int width);
 static int dw_prepare(int lba, uintptr_t buf, size_t size);
 static int dw_read(int lba, uintptr_t buf, size_t size);
 static int dw_write(int lba, uintptr_t buf, size_t size);
+static int dw_set_timing(int timing);
+static int dw_execute_tuning(unsigned int cmd_idx);
+static size_t dw_max_transfer(void);
 
 static const emmc_ops_t dw_mmc_ops = {
 	.init		= dw_init,
@@ -130,24 +147,97 @@ static const emmc_ops_t dw_mmc_ops = {
 	.prepare	= dw_prepare,
 	.read		= dw_read,
 	.write		= dw_write,
+	.set_timing	= dw_set_timing,
+	.execute_tuning	= dw_execute_tuning,
+	.max_transfer	= dw_max_transfer,
+};
+
+/* Tuning block patterns defined by JEDEC for 4-bit and 8-bit buses */
+static const unsigned char dw_tuning_pattern_4bit[64] = {
+	0xff, 0x0f, 0xff, 0x00, 0xff, 0xcc, 0xc3, 0xcc,
+	0xc3, 0x3c, 0xcc, 0xff, 0xfe, 0xff, 0xfe, 0xef,
+	0xff, 0xdf, 0xff, 0xdd, 0xff, 0xfb, 0xff, 0xfb,
+	0xbf, 0xff, 0x7f, 0xff, 0x77, 0xf7, 0xbd, 0xef,
+	0xff, 0xf0, 0xff, 0xf0, 0x0f, 0xfc, 0xcc, 0x3c,
+	0xcc, 0x33, 0xcc, 0xcf, 0xff, 0xef, 0xff, 0xee,
+	0xff, 0xfd, 0xff, 0xfd, 0xdf, 0xff, 0xbf, 0xff,
+	0xbb, 0xff, 0xf7, 0xff, 0xf7, 0x7f, 0x7b, 0xde,
+};
+
+static const unsigned char dw_tuning_pattern_8bit[128] = {
+	0xff, 0xff, 0x00, 0xff, 0xff, 0xff, 0x00, 0x00,
+	0xff, 0xff, 0xcc, 0xcc, 0xcc, 0x33, 0xcc, 0xcc,
+	0xcc, 0x33, 0x33, 0xcc, 0xcc, 0xcc, 0xff, 0xff,
+	0xff, 0xee, 0xff, 0xff, 0xff, 0xee, 0xee, 0xff,
+	0xff, 0xff, 0xdd, 0xff, 0xff, 0xff, 0xdd, 0xdd,
+	0xff, 0xff, 0xff, 0xbb, 0xff, 0xff, 0xff, 0xbb,
+	0xbb, 0xff, 0xff, 0xff, 0x77, 0xff, 0xff, 0xff,
+	0x77, 0x77, 0xff, 0x77, 0xbb, 0xdd, 0xee, 0xff,
+	0xff, 0xff, 0xff, 0x00, 0xff, 0xff, 0xff, 0x00,
+	0x00, 0xff, 0xff, 0xcc, 0xcc, 0xcc, 0x33, 0xcc,
+	0xcc, 0xcc, 0x33, 0x33, 0xcc, 0xcc, 0xcc, 0xff,
+	0xff, 0xff, 0xee, 0xff, 0xff, 0xff, 0xee, 0xee,
+	0xff, 0xff, 0xff, 0xdd, 0xff, 0xff, 0xff, 0xdd,
+	0xdd, 0xff, 0xff, 0xff, 0xbb, 0xff, 0xff, 0xff,
+	0xbb, 0xbb, 0xff, 0xff, 0xff, 0x77, 0xff, 0xff,
+	0xff, 0x77, 0x77, 0xff, 0x77, 0xbb, 0xdd, 0xee,
 };
 
 static dw_mmc_params_t dw_params;
 
+/* Descriptor rings and the number of descriptors already chained in each */
+static struct dw_idmac_desc *dw_ring[DWMMC_NUM_RINGS];
+static int dw_ring_chained[DWMMC_NUM_RINGS];
+static int dw_ring_len;
+static int dw_ring_next;
+
+/* Transfer prepared by dw_prepare(), programmed when its command is sent */
+static uintptr_t dw_pending_desc;
+static size_t dw_pending_size;
+
+/* Block at the end of the descriptor area that receives tuning blocks */
+static uintptr_t dw_tuning_buf;
+
+MMIO_POLL_STATS(dw_update_clk_poll);
+MMIO_POLL_STATS(dw_idle_poll);
+MMIO_POLL_STATS(dw_reset_poll);
+MMIO_POLL_STATS(dw_cmd_busy_poll);
+MMIO_POLL_STATS(dw_cmd_done_poll);
+MMIO_POLL_STATS(dw_data_poll);
+
+/* Wait for the controller to clear the self-clearing bits 'mask' of 'reg' */
+static void dw_wait_reset(unsigned int reg, unsigned int mask)
+{
+	unsigned int data;
+
+	if (mmio_poll_clr_32(&dw_reset_poll, dw_params.reg_base + reg, mask,
+			     DWMMC_RESET_TIMEOUT_US, &data) != 0) {
+		ERROR("%s, reg 0x%x:0x%x\n", __func__, reg, data);
+		panic();
+	}
+}
+
 static void dw_update_clk(void)
 {
 	unsigned int data;
+	mmio_poll_t poll;
 
 	mmio_write_32(dw_params.reg_base + DWMMC_CMD,
 		      CMD_WAIT_PRVDATA_COMPLETE | CMD_UPDATE_CLK_ONLY |
 		      CMD_START);
+	mmio_poll_start(&poll, &dw_update_clk_poll, DWMMC_CMD_TIMEOUT_US);
 	while (1) {
 		data = mmio_read_32(dw_params.reg_base + DWMMC_CMD);
 		if ((data & CMD_START) == 0)
 			break;
 		data = mmio_read_32(dw_params.reg_base + DWMMC_RINTSTS);
 		assert(data & INT_HLE);
+		if (mmio_poll_wait(&poll) != 0) {
+			ERROR("%s, RINTSTS:0x%x\n", __func__, data);
+			panic();
+		}
 	}
+	mmio_poll_done(&poll);
 }
 
 static void dw_set_clk(int clk)
@@ -157,17 +247,25 @@ static void dw_set_clk(int clk)
 
 	assert(clk > 0);
 
-	for (div = 1; div < 256; div++) {
-		if ((dw_params.clk_rate / (2 * div)) <= clk) {
-			break;
+	/* a divider of 0 bypasses the divider and runs at the source clock */
+	if (dw_params.clk_rate <= clk) {
+		div = 0;
+	} else {
+		for (div = 1; div < 256; div++) {
+			if ((dw_params.clk_rate / (2 * div)) <= clk) {
+				break;
+			}
 		}
+		assert(div < 256);
 	}
-	assert(div < 256);
 
 	/* wait until controller is idle */
-	do {
-		data = mmio_read_32(dw_params.reg_base + DWMMC_STATUS);
-	} while (data & STATUS_DATA_BUSY);
+	if (mmio_poll_clr_32(&dw_idle_poll, dw_params.reg_base + DWMMC_STATUS,
+			     STATUS_DATA_BUSY, DWMMC_CMD_TIMEOUT_US,
+			     &data) != 0) {
+		ERROR("%s, STATUS:0x%x\n", __func__, data);
+		panic();
+	}
 
 	/* disable clock before change clock rate */
 	mmio_write_32(dw_params.reg_base + DWMMC_CLKENA, 0);
@@ -192,9 +290,7 @@ static void dw_init(void)
 	base = dw_params.reg_base;
 	mmio_write_32(base + DWMMC_PWREN, 1);
 	mmio_write_32(base + DWMMC_CTRL, CTRL_RESET_ALL);
-	do {
-		data = mmio_read_32(base + DWMMC_CTRL);
-	} while (data);
+	dw_wait_reset(DWMMC_CTRL, ~0U);
 
 	/* enable DMA in CTRL */
 	data = CTRL_INT_EN | CTRL_DMA_EN | CTRL_IDMAC_EN;
@@ -207,9 +303,8 @@ static void dw_init(void)
 	mmio_write_32(base + DWMMC_BYTCNT, 256 * 1024);
 	mmio_write_32(base + DWMMC_DEBNCE, 0x00ffffff);
 	mmio_write_32(base + DWMMC_BMOD, BMOD_SWRESET);
-	do {
-		data = mmio_read_32(base + DWMMC_BMOD);
-	} while (data & BMOD_SWRESET);
+	dw_wait_reset(DWMMC_BMOD, BMOD_SWRESET);
+	data = mmio_read_32(base + DWMMC_BMOD);
 	/* enable DMA in BMOD */
 	data |= BMOD_ENABLE | BMOD_FB;
 	mmio_write_32(base + DWMMC_BMOD, data);
@@ -223,7 +318,6 @@ static int dw_send_cmd(emmc_cmd_t *cmd)
 {
 	unsigned int op, data, err_mask;
 	uintptr_t base;
-	int timeout;
 
 	assert(cmd);
 
@@ -241,6 +335,7 @@ static int dw_send_cmd(emmc_cmd_t *cmd)
 		break;
 	case EMMC_CMD8:
 	case EMMC_CMD17:
+	case EMMC_CMD21:
 	case EMMC_CMD18:
 		op = CMD_DATA_TRANS_EXPECT | CMD_WAIT_PRVDATA_COMPLETE;
 		break;
@@ -268,33 +363,33 @@ static int dw_send_cmd(emmc_cmd_t *cmd)
 		op |= CMD_RESP_EXPECT | CMD_CHECK_RESP_CRC;
 		break;
 	}
-	timeout = TIMEOUT;
-	do {
-		data = mmio_read_32(base + DWMMC_STATUS);
-		if (--timeout <= 0)
-			panic();
-	} while (data & STATUS_DATA_BUSY);
+	if (mmio_poll_clr_32(&dw_cmd_busy_poll, base + DWMMC_STATUS,
+			     STATUS_DATA_BUSY, DWMMC_CMD_TIMEOUT_US,
+			     &data) != 0) {
+		ERROR("%s, STATUS:0x%x\n", __func__, data);
+		panic();
+	}
 
+	if (op & CMD_DATA_TRANS_EXPECT) {
+		assert(dw_pending_desc != 0);
+		mmio_write_32(base + DWMMC_BYTCNT, dw_pending_size);
+		mmio_write_32(base + DWMMC_DBADDR, dw_pending_desc);
+		dw_pending_desc = 0;
+	}
 	mmio_write_32(base + DWMMC_RINTSTS, ~0);
 	mmio_write_32(base + DWMMC_CMDARG, cmd->cmd_arg);
 	mmio_write_32(base + DWMMC_CMD, op | cmd->cmd_idx);
 
 	err_mask = INT_EBE | INT_HLE | INT_RTO | INT_RCRC | INT_RE |
 		   INT_DCRC | INT_DRT | INT_SBE;
-	timeout = TIMEOUT;
-	do {
-		udelay(500);
-		data = mmio_read_32(base + DWMMC_RINTSTS);
-
-		if (data & err_mask)
-			return -EIO;
-		if (data & INT_DTO)
-			break;
-		if (--timeout == 0) {
-			ERROR("%s, RINTSTS:0x%x\n", __func__, data);
-			panic();
-		}
-	} while (!(data & INT_CMD_DONE));
+	if (mmio_poll_set_32(&dw_cmd_done_poll, base + DWMMC_RINTSTS,
+			     err_mask | INT_DTO | INT_CMD_DONE,
+			     DWMMC_CMD_TIMEOUT_US, &data) != 0) {
+		ERROR("%s, RINTSTS:0x%x\n", __func__, data);
+		panic();
+	}
+	if (data & err_mask)
+		return -EIO;
 
 	if (op & CMD_RESP_EXPECT) {
 		cmd->resp_data[0] = mmio_read_32(base + DWMMC_RESP0);
@@ -326,33 +421,34 @@ static int dw_set_ios(int clk, int width)
 	return 0;
 }
 
-static int dw_prepare(int lba, uintptr_t buf, size_t size)
+/*
+ * Build the descriptors of a transfer in the idle ring. The controller
+ * registers are only programmed by dw_send_cmd(), so this may run while the
+ * previous transfer is still in flight.
+ */
+static void dw_prepare_desc(uintptr_t buf, size_t size)
 {
 	struct dw_idmac_desc *desc;
-	int desc_cnt, i, last;
-	uintptr_t base;
-
-	assert(((buf & EMMC_BLOCK_MASK) == 0) &&
-	       ((size % EMMC_BLOCK_SIZE) == 0) &&
-	       (dw_params.desc_size > 0) &&
-	       ((dw_params.reg_base & EMMC_BLOCK_MASK) == 0) &&
-	       ((dw_params.desc_base & EMMC_BLOCK_MASK) == 0) &&
-	       ((dw_params.desc_size & EMMC_BLOCK_MASK) == 0));
+	int desc_cnt, i, last, ring;
 
 	desc_cnt = (size + DWMMC_DMA_MAX_BUFFER_SIZE - 1) /
 		   DWMMC_DMA_MAX_BUFFER_SIZE;
-	assert(desc_cnt * sizeof(struct dw_idmac_desc) < dw_params.desc_size);
+	assert(desc_cnt <= dw_ring_len);
+
+	ring = dw_ring_next;
+	dw_ring_next = (dw_ring_next + 1) % DWMMC_NUM_RINGS;
+	desc = dw_ring[ring];
+
+	/* the chain links never change, so only new ones are written */
+	for (i = dw_ring_chained[ring]; i < desc_cnt; i++)
+		desc[i].des3 = (uintptr_t)&desc[i + 1];
+	if (desc_cnt > dw_ring_chained[ring])
+		dw_ring_chained[ring] = desc_cnt;
 
-	base = dw_params.reg_base;
-	desc = (struct dw_idmac_desc *)dw_params.desc_base;
-	mmio_write_32(base + DWMMC_BYTCNT, size);
-	mmio_write_32(base + DWMMC_RINTSTS, ~0);
 	for (i = 0; i < desc_cnt; i++) {
 		desc[i].des0 = IDMAC_DES0_OWN | IDMAC_DES0_CH | IDMAC_DES0_DIC;
 		desc[i].des1 = IDMAC_DES1_BS1(DWMMC_DMA_MAX_BUFFER_SIZE);
 		desc[i].des2 = buf + DWMMC_DMA_MAX_BUFFER_SIZE * i;
-		desc[i].des3 = dw_params.desc_base +
-			       (sizeof(struct dw_idmac_desc)) * (i + 1);
 	}
 	/* first descriptor */
 	desc->des0 |= IDMAC_DES0_FS;
@@ -362,18 +458,43 @@ static int dw_prepare(int lba, uintptr_t buf, size_t size)
 	(desc + last)->des0 &= ~(IDMAC_DES0_DIC | IDMAC_DES0_CH);
 	(desc + last)->des1 = IDMAC_DES1_BS1(size - (last *
 				  DWMMC_DMA_MAX_BUFFER_SIZE));
-	/* set next descriptor address as 0 */
-	(desc + last)->des3 = 0;
 
-	mmio_write_32(base + DWMMC_DBADDR, dw_params.desc_base);
-	clean_dcache_range(dw_params.desc_base,
-			   desc_cnt * DWMMC_DMA_MAX_BUFFER_SIZE);
+	/* only the descriptors themselves are read by the IDMAC */
+	clean_dcache_range((uintptr_t)desc,
+			   desc_cnt * sizeof(struct dw_idmac_desc));
+
+	dw_pending_desc = (uintptr_t)desc;
+	dw_pending_size = size;
+}
+
+static int dw_prepare(int lba, uintptr_t buf, size_t size)
+{
+	assert(((buf & EMMC_BLOCK_MASK) == 0) &&
+	       ((size % EMMC_BLOCK_SIZE) == 0) &&
+	       (size > 0));
 
+	dw_prepare_desc(buf, size);
 	return 0;
 }
 
+/* Wait for the data phase of the transfer started by the last command */
 static int dw_read(int lba, uintptr_t buf, size_t size)
 {
+	unsigned int data, err_mask;
+
+	err_mask = INT_EBE | INT_SBE | INT_HLE | INT_FRUN | INT_DRT |
+		   INT_DCRC;
+	if (mmio_poll_set_32(&dw_data_poll,
+			     dw_params.reg_base + DWMMC_RINTSTS,
+			     err_mask | INT_DTO, DWMMC_DATA_TIMEOUT_US,
+			     &data) != 0) {
+		ERROR("%s, RINTSTS:0x%x\n", __func__, data);
+		panic();
+	}
+	if (data & err_mask) {
+		ERROR("%s, RINTSTS:0x%x\n", __func__, data);
+		return -EIO;
+	}
 	return 0;
 }
 
@@ -382,6 +503,130 @@ static int dw_write(int lba, uintptr_t buf, size_t size)
 	return 0;
 }
 
+static int dw_set_timing(int timing)
+{
+	uintptr_t reg;
+
+	reg = dw_params.reg_base + DWMMC_UHS_REG;
+	if (timing == EMMC_TIMING_HS400)
+		mmio_setbits_32(reg, UHS_REG_DDR);
+	else
+		mmio_clrbits_32(reg, UHS_REG_DDR);
+	if (dw_params.set_timing != NULL)
+		return dw_params.set_timing(timing);
+	return 0;
+}
+
+/* Read one tuning block with the current sample phase */
+static int dw_tuning_block(unsigned int cmd_idx, const unsigned char *pattern,
+			   size_t size)
+{
+	emmc_cmd_t cmd;
+	int ret;
+
+	memset((void *)dw_tuning_buf, 0, size);
+	clean_dcache_range(dw_tuning_buf, size);
+	mmio_write_32(dw_params.reg_base + DWMMC_BLKSIZ, size);
+	dw_prepare_desc(dw_tuning_buf, size);
+
+	memset(&cmd, 0, sizeof(emmc_cmd_t));
+	cmd.cmd_idx = cmd_idx;
+	cmd.resp_type = EMMC_RESPONSE_R1;
+	ret = dw_send_cmd(&cmd);
+	if (ret == 0)
+		ret = dw_read(0, dw_tuning_buf, size);
+	mmio_write_32(dw_params.reg_base + DWMMC_BLKSIZ, EMMC_BLOCK_SIZE);
+	if (ret != 0) {
+		/* drop whatever is left of the failed transfer */
+		mmio_setbits_32(dw_params.reg_base + DWMMC_CTRL,
+				CTRL_FIFO_RESET | CTRL_DMA_RESET);
+		dw_wait_reset(DWMMC_CTRL, CTRL_FIFO_RESET | CTRL_DMA_RESET);
+		return ret;
+	}
+	inv_dcache_range(dw_tuning_buf, size);
+	if (memcmp((void *)dw_tuning_buf, pattern, size) != 0)
+		return -EIO;
+	return 0;
+}
+
+/*
+ * Try every sample phase the platform offers and settle on the middle of the
+ * longest run of phases that read the tuning block correctly.
+ */
+static int dw_execute_tuning(unsigned int cmd_idx)
+{
+	const unsigned char *pattern;
+	size_t size;
+	int phase, start = -1, best_start = 0, best_len = 0;
+
+	if ((dw_params.set_phase == NULL) || (dw_params.num_phases <= 0))
+		return -ENOTSUP;
+	assert(dw_params.num_phases <= DWMMC_MAX_PHASES);
+
+	if (mmio_read_32(dw_params.reg_base + DWMMC_CTYPE) == CTYPE_8BIT) {
+		pattern = dw_tuning_pattern_8bit;
+		size = sizeof(dw_tuning_pattern_8bit);
+	} else {
+		pattern = dw_tuning_pattern_4bit;
+		size = sizeof(dw_tuning_pattern_4bit);
+	}
+
+	for (phase = 0; phase <= dw_params.num_phases; phase++) {
+		if ((phase < dw_params.num_phases) &&
+		    (dw_params.set_phase(phase) == 0) &&
+		    (dw_tuning_block(cmd_idx, pattern, size) == 0)) {
+			if (start < 0)
+				start = phase;
+			continue;
+		}
+		if ((start >= 0) && (phase - start > best_len)) {
+			best_start = start;
+			best_len = phase - start;
+		}
+		start = -1;
+	}
+	if (best_len == 0) {
+		ERROR("%s: no working sample phase\n", __func__);
+		return -EIO;
+	}
+	VERBOSE("%s: phases %d-%d pass\n", __func__, best_start,
+		best_start + best_len - 1);
+	return dw_params.set_phase(best_start + best_len / 2);
+}
+
+/* A transfer must fit in the descriptors of one ring */
+static size_t dw_max_transfer(void)
+{
+	return (size_t)dw_ring_len * DWMMC_DMA_MAX_BUFFER_SIZE;
+}
+
+/*
+ * Split the descriptor area between the rings and the tuning buffer. The
+ * whole area must be mapped, as the rings are used in turn.
+ */
+static void dw_init_rings(void)
+{
+	size_t ring_size;
+	int i;
+
+	/* the last block of the descriptor area is the tuning buffer */
+	assert(dw_params.desc_size >= EMMC_BLOCK_SIZE +
+	       DWMMC_NUM_RINGS * sizeof(struct dw_idmac_desc));
+	dw_tuning_buf = dw_params.desc_base + dw_params.desc_size -
+			EMMC_BLOCK_SIZE;
+	ring_size = (dw_params.desc_size - EMMC_BLOCK_SIZE) / DWMMC_NUM_RINGS;
+	dw_ring_len = ring_size / sizeof(struct dw_idmac_desc);
+	ring_size = dw_ring_len * sizeof(struct dw_idmac_desc);
+	for (i = 0; i < DWMMC_NUM_RINGS; i++) {
+		dw_ring[i] = (struct dw_idmac_desc *)(dw_params.desc_base +
+						       i * ring_size);
+		assert((uintptr_t)&dw_ring[i][dw_ring_len] <= dw_tuning_buf);
+		dw_ring_chained[i] = 0;
+	}
+	dw_ring_next = 0;
+	dw_pending_desc = 0;
+}
+
 void dw_mmc_init(dw_mmc_params_t *params)
 {
 	assert((params != 0) &&
@@ -395,6 +640,7 @@ void dw_mmc_init(dw_mmc_params_t *params)
 		(params->bus_width == EMMC_BUS_WIDTH_8)));
 
 	memcpy(&dw_params, params, sizeof(dw_mmc_params_t));
+	dw_init_rings();
 	emmc_init(&dw_mmc_ops, params->clk_rate, params->bus_width,
 		  params->flags);
 }
@@ -7,16 +7,26 @@
 #include <assert.h>
 #include <debug.h>
 #include <dw_ufs.h>
+#include <errno.h>
 #include <mmio.h>
+#include <mmio_poll.h>
 #include <stdint.h>
 #include <string.h>
 #include <ufs.h>
 
+/* Timeouts of the waits on the PHY and the link, in microseconds */
+#define DWUFS_TX_FSM_TIMEOUT_US		100000
+#define DWUFS_PWR_MODE_TIMEOUT_US	500000
+
+MMIO_POLL_STATS(dwufs_tx_fsm_poll);
+MMIO_POLL_STATS(dwufs_pwr_mode_poll);
+
 static int dwufs_phy_init(ufs_params_t *params)
 {
 	uintptr_t base;
 	unsigned int fsm0, fsm1;
 	unsigned int data;
+	mmio_poll_t poll;
 	int result;
 
 	assert((params != NULL) && (params->reg_base != 0));
@@ -66,6 +76,7 @@ static int dwufs_phy_init(ufs_params_t *params)
 	/* enable Unipro VS MPHY */
 	ufshc_dme_set(VS_MPHY_DISABLE_OFFSET, 0, 0);
 
+	mmio_poll_start(&poll, &dwufs_tx_fsm_poll, DWUFS_TX_FSM_TIMEOUT_US);
 	while (1) {
 		result = ufshc_dme_get(TX_FSM_STATE_OFFSET, 0, &fsm0);
 		assert(result == 0);
@@ -74,7 +85,13 @@ static int dwufs_phy_init(ufs_params_t *params)
 		if ((fsm0 == TX_FSM_STATE_HIBERN8) &&
 		    (fsm1 == TX_FSM_STATE_HIBERN8))
 			break;
+		if (mmio_poll_wait(&poll) != 0) {
+			ERROR("ufs: TX FSM not in HIBERN8, FSM:0x%x 0x%x\n",
+			      fsm0, fsm1);
+			return -ETIMEDOUT;
+		}
 	}
+	mmio_poll_done(&poll);
 
 	mmio_write_32(base + HCLKDIV, 0xE4);
 	mmio_clrbits_32(base + AHIT, 0x3FF);
@@ -158,9 +175,11 @@ static int dwufs_phy_set_pwr_mode(ufs_params_t *params)
 
 	result = ufshc_dme_set(PA_PWR_MODE_OFFSET, 0, 0x11);
 	assert(result == 0);
-	do {
-		data = mmio_read_32(base + IS);
-	} while ((data & UFS_INT_UPMS) == 0);
+	if (mmio_poll_set_32(&dwufs_pwr_mode_poll, base + IS, UFS_INT_UPMS,
+			     DWUFS_PWR_MODE_TIMEOUT_US, NULL) != 0) {
+		ERROR("ufs: power mode change timed out\n");
+		return -ETIMEDOUT;
+	}
 	mmio_write_32(base + IS, UFS_INT_UPMS);
 	data = mmio_read_32(base + HCS);
 	if ((data & HCS_UPMCRS_MASK) == HCS_PWR_LOCAL)
@@ -185,6 +204,5 @@ int dw_ufs_init(dw_ufs_params_t *params)
 	ufs_params.desc_base = params->desc_base;
 	ufs_params.desc_size = params->desc_size;
 	ufs_params.flags = params->flags;
-	ufs_init(&dw_ufs_ops, &ufs_params);
-	return 0;
+	return ufs_init(&dw_ufs_ops, &ufs_params);
 }
@@ -11,6 +11,7 @@
 #include <endian.h>
 #include <errno.h>
 #include <mmio.h>
+#include <mmio_poll.h>
 #include <platform_def.h>
 #include <stdint.h>
 #include <string.h>
@@ -20,17 +21,62 @@
 #define ALIGN_CDB(x)			(((x) + CDB_ADDR_MASK) & ~CDB_ADDR_MASK)
 #define ALIGN_8(x)			(((x) + 7) & ~7)
 
+/*
+ * The first UFS_DESC_SIZE bytes of the descriptor area hold the UTP Transfer
+ * Request List, one UTRD per slot. The UTP Command Descriptor of each slot
+ * follows in its own UFS_DESC_SIZE block.
+ */
 #define UFS_DESC_SIZE			0x400
 #define MAX_UFS_DESC_SIZE		0x8000		/* 32 descriptors */
+#define MAX_UFS_SLOTS			32
 
 #define MAX_PRDT_SIZE			0x40000		/* 256KB */
 
+/* Timeouts of the waits on the host controller, in microseconds */
+#define UFS_UIC_READY_TIMEOUT_US	100000
+#define UFS_UIC_TIMEOUT_US		500000
+#define UFS_HCE_TIMEOUT_US		100000
+#define UFS_LINK_TIMEOUT_US		100000
+#define UFS_UTRL_TIMEOUT_US		100000
+#define UFS_XFER_TIMEOUT_US		5000000
+
+/* Transfer length of each READ_10 issued by the queued read path */
+#define UFS_QUEUE_CHUNK_SIZE		0x100000	/* 1MB */
+
+/*
+ * Slots whose UTRDs share a cache line are handed to the controller together.
+ * Otherwise cleaning a new UTRD could overwrite the OCS field of a request
+ * that the controller still owns.
+ */
+#define UTRD_PER_LINE	(CACHE_WRITEBACK_GRANULE / sizeof(utrd_header_t))
+
 static ufs_params_t ufs_params;
 static int nutrs;	/* Number of UTP Transfer Request Slots */
 
+/* Requests in flight on the queued read path */
+static utp_utrd_t queue_utrd[MAX_UFS_SLOTS];
+static size_t queue_len[MAX_UFS_SLOTS];
+static int queue_lba[MAX_UFS_SLOTS];
+static uint64_t queue_start[MAX_UFS_SLOTS];
+
+static ufs_cmd_hook_t ufs_cmd_hook;
+
+MMIO_POLL_STATS(ufs_uic_ready_poll);
+MMIO_POLL_STATS(ufs_uic_cmd_poll);
+MMIO_POLL_STATS(ufs_dme_get_poll);
+MMIO_POLL_STATS(ufs_dme_set_poll);
+MMIO_POLL_STATS(ufs_hce_enable_poll);
+MMIO_POLL_STATS(ufs_device_present_poll);
+MMIO_POLL_STATS(ufs_utrl_start_poll);
+MMIO_POLL_STATS(ufs_xfer_poll);
+MMIO_POLL_STATS(ufs_queue_poll);
+MMIO_POLL_STATS(ufs_utrl_clear_poll);
+MMIO_POLL_STATS(ufs_hibern8_exit_poll);
+
 int ufshc_send_uic_cmd(uintptr_t base, uic_cmd_t *cmd)
 {
 	unsigned int data;
+	int result;
 
 	data = mmio_read_32(base + HCS);
 	if ((data & HCS_UCRDY) == 0)
@@ -41,9 +87,10 @@ int ufshc_send_uic_cmd(uintptr_t base, uic_cmd_t *cmd)
 	mmio_write_32(base + UCMDARG3, cmd->arg3);
 	mmio_write_32(base + UICCMD, cmd->op);
 
-	do {
-		data = mmio_read_32(base + IS);
-	} while ((data & UFS_INT_UCCS) == 0);
+	result = mmio_poll_set_32(&ufs_uic_cmd_poll, base + IS, UFS_INT_UCCS,
+				  UFS_UIC_TIMEOUT_US, NULL);
+	if (result != 0)
+		return result;
 	mmio_write_32(base + IS, UFS_INT_UCCS);
 	return mmio_read_32(base + UCMDARG2) & CONFIG_RESULT_CODE_MASK;
 }
@@ -52,18 +99,13 @@ int ufshc_dme_get(unsigned int attr, unsigned int idx, unsigned int *val)
 {
 	uintptr_t base;
 	unsigned int data;
-	int retries;
+	int result;
 
 	assert((ufs_params.reg_base != 0) && (val != NULL));
 
 	base = ufs_params.reg_base;
-	for (retries = 0; retries < 100; retries++) {
-		data = mmio_read_32(base + HCS);
-		if ((data & HCS_UCRDY) != 0)
-			break;
-		mdelay(1);
-	}
-	if (retries >= 100)
+	if (mmio_poll_set_32(&ufs_uic_ready_poll, base + HCS, HCS_UCRDY,
+			     UFS_UIC_READY_TIMEOUT_US, NULL) != 0)
 		return -EBUSY;
 
 	mmio_write_32(base + IS, ~0);
@@ -71,11 +113,13 @@ int ufshc_dme_get(unsigned int attr, unsigned int idx, unsigned int *val)
 	mmio_write_32(base + UCMDARG2, 0);
 	mmio_write_32(base + UCMDARG3, 0);
 	mmio_write_32(base + UICCMD, DME_GET);
-	do {
-		data = mmio_read_32(base + IS);
-		if (data & UFS_INT_UE)
-			return -EINVAL;
-	} while ((data & UFS_INT_UCCS) == 0);
+	result = mmio_poll_set_32(&ufs_dme_get_poll, base + IS,
+				  UFS_INT_UCCS | UFS_INT_UE,
+				  UFS_UIC_TIMEOUT_US, &data);
+	if (result != 0)
+		return result;
+	if (data & UFS_INT_UE)
+		return -EINVAL;
 	mmio_write_32(base + IS, UFS_INT_UCCS);
 	data = mmio_read_32(base + UCMDARG2) & CONFIG_RESULT_CODE_MASK;
 	assert(data == 0);
@@ -88,6 +132,7 @@ int ufshc_dme_set(unsigned int attr, unsigned int idx, unsigned int val)
 {
 	uintptr_t base;
 	unsigned int data;
+	int result;
 
 	assert((ufs_params.reg_base != 0));
 
@@ -100,32 +145,39 @@ int ufshc_dme_set(unsigned int attr, unsigned int idx, unsigned int val)
 	mmio_write_32(base + UCMDARG2, 0);
 	mmio_write_32(base + UCMDARG3, val);
 	mmio_write_32(base + UICCMD, DME_SET);
-	do {
-		data = mmio_read_32(base + IS);
-		if (data & UFS_INT_UE)
-			return -EINVAL;
-	} while ((data & UFS_INT_UCCS) == 0);
+	result = mmio_poll_set_32(&ufs_dme_set_poll, base + IS,
+				  UFS_INT_UCCS | UFS_INT_UE,
+				  UFS_UIC_TIMEOUT_US, &data);
+	if (result != 0)
+		return result;
+	if (data & UFS_INT_UE)
+		return -EINVAL;
 	mmio_write_32(base + IS, UFS_INT_UCCS);
 	data = mmio_read_32(base + UCMDARG2) & CONFIG_RESULT_CODE_MASK;
 	assert(data == 0);
 	return 0;
 }
 
-static void ufshc_reset(uintptr_t base)
+static int ufshc_reset(uintptr_t base)
 {
 	unsigned int data;
+	int result;
 
 	/* Enable Host Controller */
 	mmio_write_32(base + HCE, HCE_ENABLE);
 	/* Wait until basic initialization sequence completed */
-	do {
-		data = mmio_read_32(base + HCE);
-	} while ((data & HCE_ENABLE) == 0);
+	result = mmio_poll_set_32(&ufs_hce_enable_poll, base + HCE, HCE_ENABLE,
+				  UFS_HCE_TIMEOUT_US, NULL);
+	if (result != 0) {
+		ERROR("UFS: host controller enable timed out\n");
+		return result;
+	}
 
 	/* Enable Interrupts */
 	data = UFS_INT_UCCS | UFS_INT_ULSS | UFS_INT_UE | UFS_INT_UTPES |
 	       UFS_INT_DFES | UFS_INT_HCFES | UFS_INT_SBFES;
 	mmio_write_32(base + IE, data);
+	return 0;
 }
 
 static int ufshc_link_startup(uintptr_t base)
@@ -140,8 +192,10 @@ static int ufshc_link_startup(uintptr_t base)
 		result = ufshc_send_uic_cmd(base, &cmd);
 		if (result != 0)
 			continue;
-		while ((mmio_read_32(base + HCS) & HCS_DP) == 0)
-			;
+		result = mmio_poll_set_32(&ufs_device_present_poll, base + HCS,
+					  HCS_DP, UFS_LINK_TIMEOUT_US, NULL);
+		if (result != 0)
+			continue;
 		data = mmio_read_32(base + IS);
 		if (data & UFS_INT_ULSS)
 			mmio_write_32(base + IS, UFS_INT_ULSS);
@@ -168,26 +222,33 @@ static int get_empty_slot(int *slot)
 	return 0;
 }
 
-static void get_utrd(utp_utrd_t *utrd)
+/* Mask of the slots whose UTRDs share a cache line with the given slot */
+static unsigned int get_slot_group(int slot)
+{
+	unsigned int first;
+
+	first = slot & ~(UTRD_PER_LINE - 1);
+	return ((1U << UTRD_PER_LINE) - 1) << first;
+}
+
+static void init_utrd(utp_utrd_t *utrd, int slot)
 {
 	uintptr_t base;
-	int slot = 0, result;
 	utrd_header_t *hd;
 
-	assert(utrd != NULL);
-	result = get_empty_slot(&slot);
-	assert(result == 0);
+	assert((utrd != NULL) && (slot >= 0) && (slot < nutrs));
 
 	/* clear utrd */
 	memset((void *)utrd, 0, sizeof(utp_utrd_t));
-	base = ufs_params.desc_base + (slot * UFS_DESC_SIZE);
-	/* clear the descriptor */
+	utrd->header = ufs_params.desc_base + (slot * sizeof(utrd_header_t));
+	memset((void *)utrd->header, 0, sizeof(utrd_header_t));
+	/* clear the command descriptor */
+	base = ufs_params.desc_base + ((slot + 1) * UFS_DESC_SIZE);
 	memset((void *)base, 0, UFS_DESC_SIZE);
 
-	utrd->header = base;
 	utrd->task_tag = slot + 1;
 	/* CDB address should be aligned with 128 bytes */
-	utrd->upiu = ALIGN_CDB(utrd->header + sizeof(utrd_header_t));
+	utrd->upiu = ALIGN_CDB(base);
 	utrd->resp_upiu = ALIGN_8(utrd->upiu + sizeof(cmd_upiu_t));
 	utrd->size_upiu = utrd->resp_upiu - utrd->upiu;
 	utrd->size_resp_upiu = ALIGN_8(sizeof(resp_upiu_t));
@@ -199,27 +260,62 @@ static void get_utrd(utp_utrd_t *utrd)
 	/* Both RUL and RUO is based on DWORD */
 	hd->rul = utrd->size_resp_upiu >> 2;
 	hd->ruo = utrd->size_upiu >> 2;
+}
+
+static void get_utrd(utp_utrd_t *utrd)
+{
+	int slot = 0, result;
+
+	result = get_empty_slot(&slot);
+	assert(result == 0);
+	init_utrd(utrd, slot);
 	(void)result;
 }
 
+static void flush_utrd(utp_utrd_t *utrd)
+{
+	flush_dcache_range((uintptr_t)utrd, sizeof(utp_utrd_t));
+	flush_dcache_range(utrd->header, sizeof(utrd_header_t));
+	flush_dcache_range(utrd->upiu, UFS_DESC_SIZE);
+}
+
+static void inv_utrd(utp_utrd_t *utrd)
+{
+	inv_dcache_range(utrd->header, sizeof(utrd_header_t));
+	inv_dcache_range(utrd->upiu, UFS_DESC_SIZE);
+}
+
 /*
- * Prepare UTRD, Command UPIU, Response UPIU.
+ * Prepare UTRD, Command UPIU, Response UPIU. Each segment of the scatter list
+ * gets its own PRDT entries, so the data buffer needn't be contiguous. Returns
+ * -EINVAL if the PRDT entries don't fit into the command descriptor or the
+ * transfer is too long for a single command.
  */
-static int ufs_prepare_cmd(utp_utrd_t *utrd, uint8_t op, uint8_t lun,
-			   int lba, uintptr_t buf, size_t length)
+static int ufs_prepare_cmd_sg(utp_utrd_t *utrd, uint8_t op, uint8_t lun,
+			      int lba, const ufs_sg_t *sg, int nents)
 {
 	utrd_header_t *hd;
 	cmd_upiu_t *upiu;
 	prdt_t *prdt;
 	unsigned int ulba;
 	unsigned int lba_cnt;
-	int prdt_size;
-
+	uintptr_t buf;
+	size_t length, seg_len, prdt_num;
+	int i, prdt_size;
 
-	mmio_write_32(ufs_params.reg_base + UTRLBA,
-		      utrd->header & UINT32_MAX);
-	mmio_write_32(ufs_params.reg_base + UTRLBAU,
-		      (utrd->upiu >> 32) & UINT32_MAX);
+	assert((sg != NULL) || (nents == 0));
+	for (i = 0, length = 0, prdt_num = 0; i < nents; i++) {
+		length += sg[i].length;
+		prdt_num += (sg[i].length + MAX_PRDT_SIZE - 1) / MAX_PRDT_SIZE;
+	}
+	if (prdt_num > (utrd->upiu + UFS_DESC_SIZE - utrd->prdt) /
+		       sizeof(prdt_t)) {
+		ERROR("UFS: %d segments need %zu PRDT entries\n", nents,
+		      prdt_num);
+		return -EINVAL;
+	}
+	if ((length >> UFS_BLOCK_SHIFT) > UINT16_MAX)
+		return -EINVAL;
 
 	hd = (utrd_header_t *)utrd->header;
 	upiu = (cmd_upiu_t *)utrd->upiu;
@@ -272,41 +368,58 @@ static int ufs_prepare_cmd(utp_utrd_t *utrd, uint8_t op, uint8_t lun,
 	default:
 		assert(0);
 	}
-	if (hd->dd == DD_IN)
-		flush_dcache_range(buf, length);
-	else if (hd->dd == DD_OUT)
-		inv_dcache_range(buf, length);
+	for (i = 0; i < nents; i++) {
+		if (hd->dd == DD_IN)
+			flush_dcache_range(sg[i].buf, sg[i].length);
+		else if (hd->dd == DD_OUT)
+			inv_dcache_range(sg[i].buf, sg[i].length);
+	}
 	if (length) {
 		upiu->exp_data_trans_len = htobe32(length);
-		assert(lba_cnt <= UINT16_MAX);
 		prdt = (prdt_t *)utrd->prdt;
 
 		prdt_size = 0;
-		while (length > 0) {
-			prdt->dba = (unsigned int)(buf & UINT32_MAX);
-			prdt->dbau = (unsigned int)((buf >> 32) & UINT32_MAX);
-			/* prdt->dbc counts from 0 */
-			if (length > MAX_PRDT_SIZE) {
-				prdt->dbc = MAX_PRDT_SIZE - 1;
-				length = length - MAX_PRDT_SIZE;
-			} else {
-				prdt->dbc = length - 1;
-				length = 0;
+		for (i = 0; i < nents; i++) {
+			buf = sg[i].buf;
+			seg_len = sg[i].length;
+			/* data base address and byte count are in DWORDs */
+			assert(((buf & 3) == 0) && ((seg_len & 3) == 0));
+			while (seg_len > 0) {
+				prdt->dba = (unsigned int)(buf & UINT32_MAX);
+				prdt->dbau = (unsigned int)((buf >> 32) &
+							    UINT32_MAX);
+				/* prdt->dbc counts from 0 */
+				if (seg_len > MAX_PRDT_SIZE) {
+					prdt->dbc = MAX_PRDT_SIZE - 1;
+					seg_len = seg_len - MAX_PRDT_SIZE;
+				} else {
+					prdt->dbc = seg_len - 1;
+					seg_len = 0;
+				}
+				buf += MAX_PRDT_SIZE;
+				prdt++;
+				prdt_size += sizeof(prdt_t);
 			}
-			buf += MAX_PRDT_SIZE;
-			prdt++;
-			prdt_size += sizeof(prdt_t);
 		}
 		utrd->size_prdt = ALIGN_8(prdt_size);
 		hd->prdtl = utrd->size_prdt >> 2;
 		hd->prdto = (utrd->size_upiu + utrd->size_resp_upiu) >> 2;
 	}
 
-	flush_dcache_range((uintptr_t)utrd, sizeof(utp_utrd_t));
-	flush_dcache_range((uintptr_t)utrd->header, UFS_DESC_SIZE);
+	flush_utrd(utrd);
 	return 0;
 }
 
+static int ufs_prepare_cmd(utp_utrd_t *utrd, uint8_t op, uint8_t lun,
+			   int lba, uintptr_t buf, size_t length)
+{
+	ufs_sg_t sg;
+
+	sg.buf = buf;
+	sg.length = length;
+	return ufs_prepare_cmd_sg(utrd, op, lun, lba, &sg, (length != 0));
+}
+
 static int ufs_prepare_query(utp_utrd_t *utrd, uint8_t op, uint8_t idn,
 			     uint8_t index, uint8_t sel,
 			     uintptr_t buf, size_t length)
@@ -318,12 +431,6 @@ static int ufs_prepare_query(utp_utrd_t *utrd, uint8_t op, uint8_t idn,
 	hd = (utrd_header_t *)utrd->header;
 	query_upiu = (query_upiu_t *)utrd->upiu;
 
-	mmio_write_32(ufs_params.reg_base + UTRLBA,
-		      utrd->header & UINT32_MAX);
-	mmio_write_32(ufs_params.reg_base + UTRLBAU,
-		      (utrd->header >> 32) & UINT32_MAX);
-
-
 	hd->i = 1;
 	hd->ct = CT_UFS_STORAGE;
 	hd->ocs = OCS_MASK;
@@ -360,8 +467,7 @@ static int ufs_prepare_query(utp_utrd_t *utrd, uint8_t op, uint8_t idn,
 	default:
 		assert(0);
 	}
-	flush_dcache_range((uintptr_t)utrd, sizeof(utp_utrd_t));
-	flush_dcache_range((uintptr_t)utrd->header, UFS_DESC_SIZE);
+	flush_utrd(utrd);
 	return 0;
 }
 
@@ -370,11 +476,6 @@ static void ufs_prepare_nop_out(utp_utrd_t *utrd)
 	utrd_header_t *hd;
 	nop_out_upiu_t *nop_out;
 
-	mmio_write_32(ufs_params.reg_base + UTRLBA,
-		      utrd->header & UINT32_MAX);
-	mmio_write_32(ufs_params.reg_base + UTRLBAU,
-		      (utrd->header >> 32) & UINT32_MAX);
-
 	hd = (utrd_header_t *)utrd->header;
 	nop_out = (nop_out_upiu_t *)utrd->upiu;
 
@@ -384,8 +485,7 @@ static void ufs_prepare_nop_out(utp_utrd_t *utrd)
 
 	nop_out->trans_type = 0;
 	nop_out->task_tag = utrd->task_tag;
-	flush_dcache_range((uintptr_t)utrd, sizeof(utp_utrd_t));
-	flush_dcache_range((uintptr_t)utrd->header, UFS_DESC_SIZE);
+	flush_utrd(utrd);
 }
 
 static void ufs_send_request(int task_tag)
@@ -397,11 +497,6 @@ static void ufs_send_request(int task_tag)
 	/* clear all interrupts */
 	mmio_write_32(ufs_params.reg_base + IS, ~0);
 
-	mmio_write_32(ufs_params.reg_base + UTRLRSR, 1);
-	do {
-		data = mmio_read_32(ufs_params.reg_base + UTRLRSR);
-	} while (data == 0);
-
 	data = UTRIACR_IAEN | UTRIACR_CTR | UTRIACR_IACTH(0x1F) |
 	       UTRIACR_IATOVAL(0xFF);
 	mmio_write_32(ufs_params.reg_base + UTRIACR, data);
@@ -414,25 +509,28 @@ static int ufs_check_resp(utp_utrd_t *utrd, int trans_type)
 	utrd_header_t *hd;
 	resp_upiu_t *resp;
 	unsigned int data;
-	int slot;
+	int slot, result;
 
 	hd = (utrd_header_t *)utrd->header;
 	resp = (resp_upiu_t *)utrd->resp_upiu;
-	inv_dcache_range((uintptr_t)hd, UFS_DESC_SIZE);
+	inv_utrd(utrd);
 	inv_dcache_range((uintptr_t)utrd, sizeof(utp_utrd_t));
-	do {
-		data = mmio_read_32(ufs_params.reg_base + IS);
-		if ((data & ~(UFS_INT_UCCS | UFS_INT_UTRCS)) != 0)
-			return -EIO;
-	} while ((data & UFS_INT_UTRCS) == 0);
+	/* wait for the completion or for an error */
+	result = mmio_poll_set_32(&ufs_xfer_poll, ufs_params.reg_base + IS,
+				  ~UFS_INT_UCCS, UFS_XFER_TIMEOUT_US, &data);
+	if (result != 0)
+		return result;
+	if ((data & ~(UFS_INT_UCCS | UFS_INT_UTRCS)) != 0)
+		return -EIO;
 	slot = utrd->task_tag - 1;
 
 	data = mmio_read_32(ufs_params.reg_base + UTRLDBR);
-	assert((data & (1 << slot)) == 0);
-	assert(hd->ocs == OCS_SUCCESS);
-	assert((resp->trans_type & TRANS_TYPE_CODE_MASK) == trans_type);
-	(void)resp;
-	(void)slot;
+	if (((data & (1 << slot)) != 0) || (hd->ocs != OCS_SUCCESS) ||
+	    ((resp->trans_type & TRANS_TYPE_CODE_MASK) != trans_type)) {
+		ERROR("UFS: slot %d failed, ocs:0x%x, status:0x%x\n",
+		      slot, hd->ocs, resp->status);
+		return -EIO;
+	}
 	return 0;
 }
 
@@ -470,34 +568,28 @@ static void dump_upiu(utp_utrd_t *utrd)
 }
 #endif
 
-static void ufs_verify_init(void)
+static int ufs_verify_init(void)
 {
 	utp_utrd_t utrd;
-	int result;
 
 	get_utrd(&utrd);
 	ufs_prepare_nop_out(&utrd);
 	ufs_send_request(utrd.task_tag);
-	result = ufs_check_resp(&utrd, NOP_IN_UPIU);
-	assert(result == 0);
-	(void)result;
+	return ufs_check_resp(&utrd, NOP_IN_UPIU);
 }
 
-static void ufs_verify_ready(void)
+static int ufs_verify_ready(void)
 {
 	utp_utrd_t utrd;
-	int result;
 
 	get_utrd(&utrd);
 	ufs_prepare_cmd(&utrd, CDBCMD_TEST_UNIT_READY, 0, 0, 0, 0);
 	ufs_send_request(utrd.task_tag);
-	result = ufs_check_resp(&utrd, RESPONSE_UPIU);
-	assert(result == 0);
-	(void)result;
+	return ufs_check_resp(&utrd, RESPONSE_UPIU);
 }
 
-static void ufs_query(uint8_t op, uint8_t idn, uint8_t index, uint8_t sel,
-		      uintptr_t buf, size_t size)
+static int ufs_send_query(uint8_t op, uint8_t idn, uint8_t index,
+			  uint8_t sel, uintptr_t buf, size_t size)
 {
 	utp_utrd_t utrd;
 	query_resp_upiu_t *resp;
@@ -516,12 +608,14 @@ static void ufs_query(uint8_t op, uint8_t idn, uint8_t index, uint8_t sel,
 	ufs_prepare_query(&utrd, op, idn, index, sel, buf, size);
 	ufs_send_request(utrd.task_tag);
 	result = ufs_check_resp(&utrd, QUERY_RESPONSE_UPIU);
-	assert(result == 0);
+	if (result != 0)
+		return result;
 	resp = (query_resp_upiu_t *)utrd.resp_upiu;
 #ifdef UFS_RESP_DEBUG
 	dump_upiu(&utrd);
 #endif
-	assert(resp->query_resp == QUERY_RESP_SUCCESS);
+	if (resp->query_resp != QUERY_RESP_SUCCESS)
+		return -EIO;
 
 	switch (op) {
 	case QUERY_READ_FLAG:
@@ -534,6 +628,16 @@ static void ufs_query(uint8_t op, uint8_t idn, uint8_t index, uint8_t sel,
 		       size);
 		break;
 	}
+	return 0;
+}
+
+static void ufs_query(uint8_t op, uint8_t idn, uint8_t index, uint8_t sel,
+		      uintptr_t buf, size_t size)
+{
+	int result;
+
+	result = ufs_send_query(op, idn, index, sel, buf, size);
+	assert(result == 0);
 	(void)result;
 }
 
@@ -581,7 +685,8 @@ void ufs_write_desc(int idn, int index, uintptr_t buf, size_t size)
 	ufs_query(QUERY_WRITE_DESC, idn, index, 0, buf, size);
 }
 
-void ufs_read_capacity(int lun, unsigned int *num, unsigned int *size)
+static int ufs_read_capacity_lun(int lun, unsigned int *num,
+				 unsigned int *size)
 {
 	utp_utrd_t utrd;
 	resp_upiu_t *resp;
@@ -593,7 +698,7 @@ void ufs_read_capacity(int lun, unsigned int *num, unsigned int *size)
 
 	assert((ufs_params.reg_base != 0) &&
 	       (ufs_params.desc_base != 0) &&
-	       (ufs_params.desc_size >= UFS_DESC_SIZE) &&
+	       (ufs_params.desc_size >= (UFS_DESC_SIZE << 1)) &&
 	       (num != NULL) && (size != NULL));
 
 	/* align buf address */
@@ -608,7 +713,8 @@ void ufs_read_capacity(int lun, unsigned int *num, unsigned int *size)
 				buf, READ_CAPACITY_LENGTH);
 		ufs_send_request(utrd.task_tag);
 		result = ufs_check_resp(&utrd, RESPONSE_UPIU);
-		assert(result == 0);
+		if (result != 0)
+			return result;
 #ifdef UFS_RESP_DEBUG
 		dump_upiu(&utrd);
 #endif
@@ -629,80 +735,290 @@ void ufs_read_capacity(int lun, unsigned int *num, unsigned int *size)
 		/* logical block length in bytes */
 		*size = be32toh(*(unsigned int *)(buf + 4));
 	} while (retry);
+	return 0;
+}
+
+void ufs_read_capacity(int lun, unsigned int *num, unsigned int *size)
+{
+	int result;
+
+	result = ufs_read_capacity_lun(lun, num, size);
+	assert(result == 0);
 	(void)result;
 }
 
-size_t ufs_read_blocks(int lun, int lba, uintptr_t buf, size_t size)
+static uint64_t ufs_cmd_start(void)
+{
+	return (ufs_cmd_hook != NULL) ? read_cntpct_el0() : 0;
+}
+
+static void ufs_cmd_done(uint8_t op, int lun, int lba, size_t bytes,
+			 uint64_t start)
+{
+	if (ufs_cmd_hook != NULL)
+		ufs_cmd_hook(op, lun, lba, bytes, read_cntpct_el0() - start);
+}
+
+static int ufs_check_slot(utp_utrd_t *utrd, size_t *count)
+{
+	utrd_header_t *hd;
+	resp_upiu_t *resp;
+
+	hd = (utrd_header_t *)utrd->header;
+	resp = (resp_upiu_t *)utrd->resp_upiu;
+	inv_utrd(utrd);
+	if ((hd->ocs != OCS_SUCCESS) ||
+	    ((resp->trans_type & TRANS_TYPE_CODE_MASK) != RESPONSE_UPIU)) {
+		ERROR("UFS: slot %d failed, ocs:0x%x, status:0x%x\n",
+		      utrd->task_tag - 1, hd->ocs, resp->status);
+		return -EIO;
+	}
+	*count = resp->res_trans_cnt;
+	return 0;
+}
+
+/*
+ * Split a read into UFS_QUEUE_CHUNK_SIZE commands and keep every transfer
+ * request slot busy until the whole buffer is read. Completion is detected
+ * by polling the doorbell register, so any number of commands may complete
+ * between two polls. If no command completes within UFS_XFER_TIMEOUT_US, or
+ * a command or the controller reports an error, the commands in flight are
+ * aborted and the number of bytes read so far is returned.
+ */
+static size_t ufs_queue_read(int lun, int lba, uintptr_t buf, size_t size)
+{
+	uintptr_t base;
+	utp_utrd_t *utrd;
+	mmio_poll_t poll;
+	unsigned int busy = 0, ready, done, data;
+	size_t chunk, offset = 0, count = 0, residue;
+	uint64_t start;
+	int slot, result = 0;
+
+	base = ufs_params.reg_base;
+	assert(mmio_read_32(base + UTRLDBR) == 0);
+	mmio_write_32(base + IS, ~0);
+
+	mmio_poll_start(&poll, &ufs_queue_poll, UFS_XFER_TIMEOUT_US);
+	while ((offset < size) || (busy != 0)) {
+		ready = 0;
+		for (slot = 0; (slot < nutrs) && (offset < size); slot++) {
+			if ((busy & get_slot_group(slot)) != 0)
+				continue;
+			chunk = MIN(size - offset,
+				    (size_t)UFS_QUEUE_CHUNK_SIZE);
+			utrd = &queue_utrd[slot];
+			init_utrd(utrd, slot);
+			ufs_prepare_cmd(utrd, CDBCMD_READ_10, lun,
+					lba + (offset >> UFS_BLOCK_SHIFT),
+					buf + offset, chunk);
+			queue_len[slot] = chunk;
+			queue_lba[slot] = lba + (offset >> UFS_BLOCK_SHIFT);
+			offset += chunk;
+			ready |= 1U << slot;
+		}
+		/*
+		 * Writing 0 to a doorbell bit has no effect, so only the new
+		 * slots are written. A read-modify-write could ring a slot
+		 * again that completed in the meantime.
+		 */
+		if (ready != 0) {
+			busy |= ready;
+			start = ufs_cmd_start();
+			for (slot = 0; slot < nutrs; slot++) {
+				if ((ready & (1U << slot)) != 0)
+					queue_start[slot] = start;
+			}
+			mmio_write_32(base + UTRLDBR, ready);
+		}
+
+		data = mmio_read_32(base + IS);
+		if ((data & (UFS_INT_UE | UFS_INT_UTPES | UFS_INT_DFES |
+			     UFS_INT_HCFES | UFS_INT_SBFES)) != 0) {
+			ERROR("UFS: queued read failed, IS:0x%x\n", data);
+			break;
+		}
+		done = busy & ~mmio_read_32(base + UTRLDBR);
+		if (done == 0) {
+			if (mmio_poll_wait(&poll) != 0) {
+				ERROR("UFS: queued read timed out\n");
+				break;
+			}
+			continue;
+		}
+		mmio_poll_done(&poll);
+		for (slot = 0; done != 0; slot++, done >>= 1) {
+			if ((done & 1) == 0)
+				continue;
+			result = ufs_check_slot(&queue_utrd[slot], &residue);
+			busy &= ~(1U << slot);
+			if (result != 0)
+				break;
+			count += queue_len[slot] - residue;
+			ufs_cmd_done(CDBCMD_READ_10, lun, queue_lba[slot],
+				     queue_len[slot] - residue,
+				     queue_start[slot]);
+		}
+		if (result != 0)
+			break;
+		/* Each completion restarts the wait for the next one */
+		mmio_poll_start(&poll, &ufs_queue_poll, UFS_XFER_TIMEOUT_US);
+	}
+
+	if (busy != 0) {
+		/* Clearing a slot is done by writing 0 to its bit */
+		mmio_write_32(base + UTRLCLR, ~busy);
+		if (mmio_poll_clr_32(&ufs_utrl_clear_poll, base + UTRLDBR,
+				     busy, UFS_UTRL_TIMEOUT_US, NULL) != 0)
+			ERROR("UFS: transfer requests 0x%x not cleared\n",
+			      busy);
+	}
+	mmio_write_32(base + IS, UFS_INT_UTRCS);
+	return count;
+}
+
+/* Issue a single command, returning the number of bytes, 0 on error */
+static size_t ufs_transfer(uint8_t op, int lun, int lba,
+			   const ufs_sg_t *sg, int nents)
 {
 	utp_utrd_t utrd;
 	resp_upiu_t *resp;
-	int result;
+	uint64_t start;
+	size_t size;
+	int i, result;
 
-	assert((ufs_params.reg_base != 0) &&
-	       (ufs_params.desc_base != 0) &&
-	       (ufs_params.desc_size >= UFS_DESC_SIZE));
+	for (i = 0, size = 0; i < nents; i++)
+		size += sg[i].length;
 
-	memset((void *)buf, 0, size);
 	get_utrd(&utrd);
-	ufs_prepare_cmd(&utrd, CDBCMD_READ_10, lun, lba, buf, size);
+	result = ufs_prepare_cmd_sg(&utrd, op, lun, lba, sg, nents);
+	if (result != 0)
+		return 0;
+	start = ufs_cmd_start();
 	ufs_send_request(utrd.task_tag);
 	result = ufs_check_resp(&utrd, RESPONSE_UPIU);
-	assert(result == 0);
+	if (result != 0)
+		return 0;
 #ifdef UFS_RESP_DEBUG
 	dump_upiu(&utrd);
 #endif
 	resp = (resp_upiu_t *)utrd.resp_upiu;
-	(void)result;
+	ufs_cmd_done(op, lun, lba, size - resp->res_trans_cnt, start);
 	return size - resp->res_trans_cnt;
 }
 
+/*
+ * The destination isn't cleared beforehand: it is invalidated before the
+ * transfer and the return value tells how much of it holds valid data.
+ */
+size_t ufs_read_blocks(int lun, int lba, uintptr_t buf, size_t size)
+{
+	ufs_sg_t sg;
+
+	assert((ufs_params.reg_base != 0) &&
+	       (ufs_params.desc_base != 0) &&
+	       (ufs_params.desc_size >= (UFS_DESC_SIZE << 1)));
+
+	if ((size > UFS_QUEUE_CHUNK_SIZE) && (nutrs > 1))
+		return ufs_queue_read(lun, lba, buf, size);
+
+	sg.buf = buf;
+	sg.length = size;
+	return ufs_transfer(CDBCMD_READ_10, lun, lba, &sg, 1);
+}
+
+/*
+ * Read consecutive blocks into a list of discontiguous buffers with a single
+ * READ_10. All segments must fit into the PRDT of one command descriptor,
+ * otherwise nothing is read and 0 is returned.
+ */
+size_t ufs_read_blocks_sg(int lun, int lba, const ufs_sg_t *sg, int nents)
+{
+	assert((ufs_params.reg_base != 0) &&
+	       (ufs_params.desc_base != 0) &&
+	       (ufs_params.desc_size >= (UFS_DESC_SIZE << 1)) &&
+	       (sg != NULL) && (nents > 0));
+
+	return ufs_transfer(CDBCMD_READ_10, lun, lba, sg, nents);
+}
+
 size_t ufs_write_blocks(int lun, int lba, const uintptr_t buf, size_t size)
 {
-	utp_utrd_t utrd;
-	resp_upiu_t *resp;
-	int result;
+	ufs_sg_t sg;
 
 	assert((ufs_params.reg_base != 0) &&
 	       (ufs_params.desc_base != 0) &&
-	       (ufs_params.desc_size >= UFS_DESC_SIZE));
+	       (ufs_params.desc_size >= (UFS_DESC_SIZE << 1)));
 
 	memset((void *)buf, 0, size);
-	get_utrd(&utrd);
-	ufs_prepare_cmd(&utrd, CDBCMD_WRITE_10, lun, lba, buf, size);
-	ufs_send_request(utrd.task_tag);
-	result = ufs_check_resp(&utrd, RESPONSE_UPIU);
-	assert(result == 0);
-#ifdef UFS_RESP_DEBUG
-	dump_upiu(&utrd);
-#endif
-	resp = (resp_upiu_t *)utrd.resp_upiu;
-	(void)result;
-	return size - resp->res_trans_cnt;
+	sg.buf = buf;
+	sg.length = size;
+	return ufs_transfer(CDBCMD_WRITE_10, lun, lba, &sg, 1);
 }
 
-static void ufs_enum(void)
+void ufs_set_cmd_hook(ufs_cmd_hook_t hook)
+{
+	ufs_cmd_hook = hook;
+}
+
+/*
+ * The transfer request list stays at the start of the descriptor area, so
+ * its base is programmed and the list is started only once.
+ */
+static int ufs_start_queue(void)
+{
+	uintptr_t base;
+	int result;
+
+	base = ufs_params.reg_base;
+	mmio_write_32(base + UTRLBA, ufs_params.desc_base & UINT32_MAX);
+	mmio_write_32(base + UTRLBAU,
+		      (ufs_params.desc_base >> 32) & UINT32_MAX);
+	mmio_write_32(base + UTRLRSR, 1);
+	result = mmio_poll_set_32(&ufs_utrl_start_poll, base + UTRLRSR, ~0U,
+				  UFS_UTRL_TIMEOUT_US, NULL);
+	if (result != 0)
+		ERROR("UFS: transfer request list start timed out\n");
+	return result;
+}
+
+static int ufs_enum(void)
 {
 	unsigned int blk_num, blk_size;
-	int i;
+	int i, result;
 
 	/* 0 means 1 slot */
 	nutrs = (mmio_read_32(ufs_params.reg_base + CAP) & CAP_NUTRS_MASK) + 1;
-	if (nutrs > (ufs_params.desc_size / UFS_DESC_SIZE))
-		nutrs = ufs_params.desc_size / UFS_DESC_SIZE;
-
-	ufs_verify_init();
-	ufs_verify_ready();
-
-	ufs_set_flag(FLAG_DEVICE_INIT);
+	/* the first descriptor block holds the transfer request list */
+	if (nutrs > (ufs_params.desc_size / UFS_DESC_SIZE) - 1)
+		nutrs = (ufs_params.desc_size / UFS_DESC_SIZE) - 1;
+	assert(nutrs <= MAX_UFS_SLOTS);
+
+	result = ufs_start_queue();
+	if (result != 0)
+		return result;
+	result = ufs_verify_init();
+	if (result != 0)
+		return result;
+	result = ufs_verify_ready();
+	if (result != 0)
+		return result;
+
+	result = ufs_send_query(QUERY_SET_FLAG, FLAG_DEVICE_INIT, 0, 0, 0, 0);
+	if (result != 0)
+		return result;
 	mdelay(100);
 	/* dump available LUNs */
 	for (i = 0; i < UFS_MAX_LUNS; i++) {
-		ufs_read_capacity(i, &blk_num, &blk_size);
+		result = ufs_read_capacity_lun(i, &blk_num, &blk_size);
+		if (result != 0)
+			return result;
 		if (blk_num && blk_size) {
 			INFO("UFS LUN%d contains %d blocks with %d-byte size\n",
 			     i, blk_num, blk_size);
 		}
 	}
+	return 0;
 }
 
 int ufs_init(const ufs_ops_t *ops, ufs_params_t *params)
@@ -714,46 +1030,58 @@ int ufs_init(const ufs_ops_t *ops, ufs_params_t *params)
 	assert((params != NULL) &&
 	       (params->reg_base != 0) &&
 	       (params->desc_base != 0) &&
-	       (params->desc_size >= UFS_DESC_SIZE));
+	       (params->desc_size >= (UFS_DESC_SIZE << 1)) &&
+	       ((params->desc_base & (UFS_DESC_SIZE - 1)) == 0));
 
 	memcpy(&ufs_params, params, sizeof(ufs_params_t));
 
 	if (ufs_params.flags & UFS_FLAGS_SKIPINIT) {
 		result = ufshc_dme_get(0x1571, 0, &data);
-		assert(result == 0);
+		if (result != 0)
+			return result;
 		result = ufshc_dme_get(0x41, 0, &data);
-		assert(result == 0);
+		if (result != 0)
+			return result;
 		if (data == 1) {
 			/* prepare to exit hibernate mode */
 			memset(&cmd, 0, sizeof(uic_cmd_t));
 			cmd.op = DME_HIBERNATE_EXIT;
 			result = ufshc_send_uic_cmd(ufs_params.reg_base,
 						    &cmd);
-			assert(result == 0);
-			data = mmio_read_32(ufs_params.reg_base + UCMDARG2);
-			assert(data == 0);
-			do {
-				data = mmio_read_32(ufs_params.reg_base + IS);
-			} while ((data & UFS_INT_UHXS) == 0);
+			if (result != 0)
+				return (result < 0) ? result : -EIO;
+			result = mmio_poll_set_32(&ufs_hibern8_exit_poll,
+						  ufs_params.reg_base + IS,
+						  UFS_INT_UHXS,
+						  UFS_UIC_TIMEOUT_US, NULL);
+			if (result != 0)
+				return result;
 			mmio_write_32(ufs_params.reg_base + IS, UFS_INT_UHXS);
 			data = mmio_read_32(ufs_params.reg_base + HCS);
-			assert((data & HCS_UPMCRS_MASK) == HCS_PWR_LOCAL);
+			if ((data & HCS_UPMCRS_MASK) != HCS_PWR_LOCAL)
+				return -EIO;
 		}
 		result = ufshc_dme_get(0x1568, 0, &data);
-		assert(result == 0);
+		if (result != 0)
+			return result;
 		assert((data > 0) && (data <= 3));
 	} else {
 		assert((ops != NULL) && (ops->phy_init != NULL) &&
 		       (ops->phy_set_pwr_mode != NULL));
 
-		ufshc_reset(ufs_params.reg_base);
-		ops->phy_init(&ufs_params);
+		result = ufshc_reset(ufs_params.reg_base);
+		if (result != 0)
+			return result;
+		result = ops->phy_init(&ufs_params);
+		if (result != 0)
+			return result;
 		result = ufshc_link_startup(ufs_params.reg_base);
-		assert(result == 0);
-		ops->phy_set_pwr_mode(&ufs_params);
+		if (result != 0)
+			return result;
+		result = ops->phy_set_pwr_mode(&ufs_params);
+		if (result != 0)
+			return result;
 	}
 
-	ufs_enum();
-	(void)result;
-	return 0;
+	return ufs_enum();
 }
@@ -0,0 +1,35 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __EL3_IPI_H__
+#define __EL3_IPI_H__
+
+#include <utils_def.h>
+
+/*******************************************************************************
+ * Flags for the EL3 inter-processor calls
+ ******************************************************************************/
+/* Return only once the function has completed on all the target CPUs */
+#define EL3_IPI_WAIT		U(1)
+
+#ifndef __ASSEMBLY__
+
+#include <stdint.h>
+
+/* Prototype of a function called on another CPU */
+typedef void (*el3_ipi_func_t)(void *arg);
+
+/*******************************************************************************
+ * Function & variable prototypes
+ ******************************************************************************/
+void el3_ipi_init(void);
+int el3_ipi_call(unsigned int cpu_idx, el3_ipi_func_t func, void *arg,
+		 unsigned int flags);
+int el3_ipi_call_mask(uint64_t cpu_mask, el3_ipi_func_t func, void *arg,
+		      unsigned int flags);
+
+#endif /* __ASSEMBLY__ */
+#endif /* __EL3_IPI_H__ */
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __EL3_TIMER_H__
+#define __EL3_TIMER_H__
+
+#include <stdint.h>
+
+/*
+ * Number of slots of the timer wheel of each CPU, and width of a slot as a
+ * power of two of system counter ticks. They can be overridden by the platform
+ * through build flags. The number of slots must be a power of two no greater
+ * than 64.
+ */
+#if !PLAT_EL3_TIMER_WHEEL_SLOTS
+# define PLAT_EL3_TIMER_WHEEL_SLOTS	32
+#endif
+#if !PLAT_EL3_TIMER_SLOT_SHIFT
+# define PLAT_EL3_TIMER_SLOT_SHIFT	10
+#endif
+
+typedef struct el3_timer el3_timer_t;
+
+/* Prototype of the function called when a timer expires */
+typedef void (*el3_timer_func_t)(el3_timer_t *timer, void *arg);
+
+/*******************************************************************************
+ * Timer managed by the EL3 timer service. The storage is provided by the user
+ * of the timer, and the fields are private to the service.
+ *
+ * 'next', 'pprev' : Links in the list of a slot of the wheel. 'pprev' is NULL
+ *                   when the timer isn't pending.
+ * 'deadline'      : System counter value at which the timer expires.
+ * 'period'        : Number of system counter ticks between two expiries of a
+ *                   periodic timer, 0 for a one-shot timer.
+ * 'cpu', 'slot'   : Linear index of the CPU the timer was started on, and
+ *                   slot of the wheel of that CPU the timer is in.
+ ******************************************************************************/
+struct el3_timer {
+	el3_timer_t *next;
+	el3_timer_t **pprev;
+	uint64_t deadline;
+	uint64_t period;
+	el3_timer_func_t func;
+	void *arg;
+	unsigned int cpu;
+	unsigned int slot;
+};
+
+/*******************************************************************************
+ * Function & variable prototypes
+ ******************************************************************************/
+void el3_timer_init(void);
+void el3_timer_setup(el3_timer_t *timer, el3_timer_func_t func, void *arg);
+void el3_timer_start(el3_timer_t *timer, uint64_t deadline, uint64_t period);
+void el3_timer_cancel(el3_timer_t *timer);
+int el3_timer_is_pending(const el3_timer_t *timer);
+void el3_timer_resume(void);
+
+#endif /* __EL3_TIMER_H__ */
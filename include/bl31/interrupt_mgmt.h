@@ -28,6 +28,14 @@
  */
 #define INTR_ID_UNAVAILABLE		U(0xFFFFFFFF)
 
+/*
+ * Maximum number of handlers which can be registered for individual EL3
+ * interrupts. It can be overridden by the platform through a build flag.
+ */
+#if !PLAT_MAX_EL3_INTR_HANDLERS
+# define PLAT_MAX_EL3_INTR_HANDLERS	8
+#endif
+
 
 /*******************************************************************************
  * Mask for _both_ the routing model bits in the 'flags' parameter and
@@ -115,6 +123,9 @@ int32_t register_interrupt_type_handler(uint32_t type,
 					interrupt_type_handler_t handler,
 					uint32_t flags);
 interrupt_type_handler_t get_interrupt_type_handler(uint32_t interrupt_type);
+int32_t register_el3_interrupt_handler(uint32_t id,
+				       interrupt_type_handler_t handler,
+				       uint32_t flags);
 int disable_intr_rm_local(uint32_t type, uint32_t security_state);
 int enable_intr_rm_local(uint32_t type, uint32_t security_state);
 
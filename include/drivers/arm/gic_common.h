@@ -33,6 +33,16 @@
 #define GIC_INTR_CFG_LEVEL		0
 #define GIC_INTR_CFG_EDGE		1
 
+/*
+ * Value of the 2-bit Int_config field of an interrupt in GICD_ICFGR<n> and
+ * GICR_ICFGR<n>, for one of the above configurations. The field of interrupt
+ * m spans bits [2m + 1:2m] of its register: Int_config[1] (bit 2m + 1) is set
+ * for an edge-triggered interrupt, and Int_config[0] is reserved.
+ */
+#define GIC_CFG_EDGE_FIELD		0x2
+#define GIC_CFG_FIELD(cfg)		\
+	(((cfg) == GIC_INTR_CFG_EDGE) ? GIC_CFG_EDGE_FIELD : 0)
+
 /* Constants to categorise priorities */
 #define GIC_HIGHEST_SEC_PRIORITY	0
 #define GIC_LOWEST_SEC_PRIORITY		127
@@ -363,6 +363,20 @@ typedef struct gicv3_its_ctx {
 	uint32_t gits_ctlr;
 } gicv3_its_ctx_t;
 
+/*******************************************************************************
+ * Per-CPU GICv3 record kept in the cpu_data of each CPU when GICV3_PCPU_CACHE
+ * is enabled. It is filled in when the driver is initialised so that per-CPU
+ * operations do not need to recompute it.
+ ******************************************************************************/
+typedef struct gicv3_cpu_data {
+	/* Base address of the Redistributor frame of the CPU */
+	uintptr_t rdist_base;
+	/* ICC_SGI0R_EL1 value targeting the CPU, with a zero INTID field */
+	uint64_t sgi_target;
+	/* GICD_IROUTER value routing an SPI to the CPU */
+	uint64_t irouter_val;
+} gicv3_cpu_data_t;
+
 /*******************************************************************************
  * GICv3 EL3 driver API
  ******************************************************************************/
@@ -377,6 +391,13 @@ unsigned int gicv3_get_pending_interrupt_type(void);
 unsigned int gicv3_get_pending_interrupt_id(void);
 unsigned int gicv3_get_interrupt_type(unsigned int id,
 					  unsigned int proc_num);
+/*
+ * With GICV3_SPARSE_SAVE_RESTORE, gicv3_distif_save() only reads back the
+ * GICD_IGROUPR, GICD_IGRPMODR and GICD_NSACR registers of the SPIs
+ * reconfigured through gicv3_distif_init() or gicv3_set_interrupt_type()
+ * since the same context was last saved or restored. These registers must not
+ * be written by other means, or the change may be missing from the next save.
+ */
 void gicv3_distif_init_restore(const gicv3_dist_ctx_t * const dist_ctx);
 void gicv3_distif_save(gicv3_dist_ctx_t * const dist_ctx);
 /*
@@ -403,6 +424,10 @@ void gicv3_set_interrupt_type(unsigned int id, unsigned int proc_num,
 void gicv3_raise_secure_g0_sgi(int sgi_num, u_register_t target);
 void gicv3_set_spi_routing(unsigned int id, unsigned int irm,
 		u_register_t mpidr);
+#if GICV3_PCPU_CACHE
+void gicv3_raise_secure_g0_sgi_by_index(int sgi_num, unsigned int core_pos);
+void gicv3_set_spi_routing_by_index(unsigned int id, unsigned int core_pos);
+#endif
 void gicv3_set_interrupt_pending(unsigned int id, unsigned int proc_num);
 void gicv3_clear_interrupt_pending(unsigned int id, unsigned int proc_num);
 unsigned int gicv3_set_pmr(unsigned int mask);
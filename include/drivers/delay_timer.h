@@ -15,6 +15,13 @@
  * function pointer to return the timer value and a clock
  * multiplier/divider. The ratio of the multiplier and the divider is
  * the clock period in microseconds.
+ *
+ * Independently of the timer, deadlines can be computed and waited
+ * for on the system counter with a nanosecond resolution. Waiting
+ * uses WFE on the event stream of the generic timer. The counter
+ * frequency must first be given to delay_counter_init(), which
+ * generic_delay_timer_init() does. delay_counter_freq() returns 0 if
+ * the counter can't be used, in which case only the timer is left.
  ********************************************************************/
 
 typedef struct timer_ops {
@@ -27,5 +34,13 @@ void mdelay(uint32_t msec);
 void udelay(uint32_t usec);
 void timer_init(const timer_ops_t *ops);
 
+void delay_counter_init(unsigned int freq);
+unsigned int delay_counter_freq(void);
+uint64_t delay_deadline_ns(uint64_t nsec);
+int delay_expired(uint64_t deadline);
+void delay_wait_until(uint64_t deadline);
+void ndelay(uint64_t nsec);
+int delay_timer_calibrate(void);
+
 
 #endif /* __DELAY_TIMER_H__ */
@@ -12,6 +12,8 @@
 #define EMMC_BLOCK_SIZE			512
 #define EMMC_BLOCK_MASK			(EMMC_BLOCK_SIZE - 1)
 #define EMMC_BOOT_CLK_RATE		(400 * 1000)
+#define EMMC_HS_MAX_CLK_RATE		(52 * 1000 * 1000)
+#define EMMC_HS200_MAX_CLK_RATE		(200 * 1000 * 1000)
 
 #define EMMC_CMD0			0
 #define EMMC_CMD1			1
@@ -25,6 +27,7 @@
 #define EMMC_CMD13			13
 #define EMMC_CMD17			17
 #define EMMC_CMD18			18
+#define EMMC_CMD21			21
 #define EMMC_CMD23			23
 #define EMMC_CMD24			24
 #define EMMC_CMD25			25
@@ -53,6 +56,7 @@
 #define CMD_EXTCSD_PARTITION_CONFIG	179
 #define CMD_EXTCSD_BUS_WIDTH		183
 #define CMD_EXTCSD_HS_TIMING		185
+#define CMD_EXTCSD_DEVICE_TYPE		196
 
 #define PART_CFG_BOOT_PARTITION1_ENABLE	(1 << 3)
 #define PART_CFG_PARTITION1_ACCESS	(1 << 0)
@@ -61,10 +65,24 @@
 #define EMMC_BUS_WIDTH_1		0
 #define EMMC_BUS_WIDTH_4		1
 #define EMMC_BUS_WIDTH_8		2
+#define EMMC_BUS_WIDTH_DDR_4		5
+#define EMMC_BUS_WIDTH_DDR_8		6
 #define EMMC_BOOT_MODE_BACKWARD		(0 << 3)
 #define EMMC_BOOT_MODE_HS_TIMING	(1 << 3)
 #define EMMC_BOOT_MODE_DDR		(2 << 3)
 
+/* HS_TIMING values in EXT CSD register, also passed to ops->set_timing() */
+#define EMMC_TIMING_LEGACY		0
+#define EMMC_TIMING_HS			1
+#define EMMC_TIMING_HS200		2
+#define EMMC_TIMING_HS400		3
+
+/* DEVICE_TYPE bits in EXT CSD register */
+#define EXTCSD_DEVICE_TYPE_HS200_1V8	(1 << 4)
+#define EXTCSD_DEVICE_TYPE_HS200_1V2	(1 << 5)
+#define EXTCSD_DEVICE_TYPE_HS400_1V8	(1 << 6)
+#define EXTCSD_DEVICE_TYPE_HS400_1V2	(1 << 7)
+
 #define EXTCSD_SET_CMD			(0 << 24)
 #define EXTCSD_SET_BITS			(1 << 24)
 #define EXTCSD_CLR_BITS			(2 << 24)
@@ -89,6 +107,9 @@
 #define EMMC_STATE_SLP			10
 
 #define EMMC_FLAG_CMD23			(1 << 0)
+/* Try to switch to HS200 or HS400, falling back to the legacy timing */
+#define EMMC_FLAG_HS200			(1 << 1)
+#define EMMC_FLAG_HS400			(1 << 2)
 
 typedef struct emmc_cmd {
 	unsigned int	cmd_idx;
@@ -104,8 +125,20 @@ typedef struct emmc_ops {
 	int (*prepare)(int lba, uintptr_t buf, size_t size);
 	int (*read)(int lba, uintptr_t buf, size_t size);
 	int (*write)(int lba, const uintptr_t buf, size_t size);
+	/* Optional, only needed for HS200 and HS400 */
+	int (*set_timing)(int timing);
+	int (*execute_tuning)(unsigned int cmd_idx);
+	/* Optional, largest size accepted by prepare() if it is limited */
+	size_t (*max_transfer)(void);
 } emmc_ops_t;
 
+/* Counters for measuring the throughput of the eMMC stack */
+typedef struct emmc_stats {
+	unsigned long long	cmds;		/* commands sent */
+	unsigned long long	bytes_read;
+	unsigned long long	read_ticks;	/* system counter ticks */
+} emmc_stats_t;
+
 typedef struct emmc_csd {
 	unsigned int 	    not_used:		1;
 	unsigned int   	    crc:			7;
@@ -156,6 +189,7 @@ size_t emmc_erase_blocks(int lba, size_t size);
 size_t emmc_rpmb_read_blocks(int lba, uintptr_t buf, size_t size);
 size_t emmc_rpmb_write_blocks(int lba, const uintptr_t buf, size_t size);
 size_t emmc_rpmb_erase_blocks(int lba, size_t size);
+void emmc_get_stats(emmc_stats_t *stats);
 void emmc_init(const emmc_ops_t *ops, int clk, int bus_width,
 	       unsigned int flags);
 
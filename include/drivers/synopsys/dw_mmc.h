@@ -14,6 +14,14 @@ typedef struct dw_mmc_params {
 	int		clk_rate;
 	int		bus_width;
 	unsigned int	flags;
+	/*
+	 * Optional platform hooks for HS200/HS400: set_timing() adjusts the
+	 * clocks and pads for an EMMC_TIMING_* value, set_phase() selects one
+	 * of num_phases sample phases during tuning.
+	 */
+	int		(*set_timing)(int timing);
+	int		(*set_phase)(int phase);
+	int		num_phases;
 } dw_mmc_params_t;
 
 void dw_mmc_init(dw_mmc_params_t *params);
@@ -506,6 +506,19 @@ typedef struct ufs_params {
 	unsigned long	flags;
 } ufs_params_t;
 
+/* Scatter list entry for ufs_read_blocks_sg() */
+typedef struct ufs_sg {
+	uintptr_t	buf;
+	size_t		length;
+} ufs_sg_t;
+
+/*
+ * Optional hook called when a READ_10 or WRITE_10 completes, with the number
+ * of bytes transferred and the command latency in system counter ticks.
+ */
+typedef void (*ufs_cmd_hook_t)(uint8_t op, int lun, int lba, size_t bytes,
+			       uint64_t ticks);
+
 typedef struct ufs_ops {
 	int		(*phy_init)(ufs_params_t *params);
 	int		(*phy_set_pwr_mode)(ufs_params_t *params);
@@ -523,7 +536,9 @@ void ufs_clear_flag(int idn);
 void ufs_read_desc(int idn, int index, uintptr_t buf, size_t size);
 void ufs_write_desc(int idn, int index, uintptr_t buf, size_t size);
 size_t ufs_read_blocks(int lun, int lba, uintptr_t buf, size_t size);
+size_t ufs_read_blocks_sg(int lun, int lba, const ufs_sg_t *sg, int nents);
 size_t ufs_write_blocks(int lun, int lba, const uintptr_t buf, size_t size);
+void ufs_set_cmd_hook(ufs_cmd_hook_t hook);
 int ufs_init(const ufs_ops_t *ops, ufs_params_t *params);
 
 #endif /* __UFS_H__ */
@@ -240,6 +240,7 @@ DEFINE_COPROCR_RW_FUNCS(hcr, HCR)
 DEFINE_COPROCR_RW_FUNCS(hcptr, HCPTR)
 DEFINE_COPROCR_RW_FUNCS(cntfrq, CNTFRQ)
 DEFINE_COPROCR_RW_FUNCS(cnthctl, CNTHCTL)
+DEFINE_COPROCR_RW_FUNCS(cntkctl, CNTKCTL)
 DEFINE_COPROCR_RW_FUNCS(mair0, MAIR0)
 DEFINE_COPROCR_RW_FUNCS(mair1, MAIR1)
 DEFINE_COPROCR_RW_FUNCS(ttbcr, TTBCR)
@@ -325,6 +326,9 @@ DEFINE_DCOP_PARAM_FUNC(cvac, DCCMVAC)
 
 #define read_cntpct_el0()	read64_cntpct()
 
+#define read_cntkctl_el1()	read_cntkctl()
+#define write_cntkctl_el1(_v)	write_cntkctl(_v)
+
 #define read_ctr_el0()		read_ctr()
 
 #define write_icc_sgi0r_el1(_v) \
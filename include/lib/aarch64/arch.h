@@ -117,6 +117,11 @@
 #define ID_AA64DFR0_PMS_LENGTH	U(4)
 #define ID_AA64DFR0_PMS_MASK	U(0xf)
 
+/* ID_AA64DFR0_EL1.PMUVer definitions */
+#define ID_AA64DFR0_PMUVER_SHIFT	U(8)
+#define ID_AA64DFR0_PMUVER_MASK		U(0xf)
+#define ID_AA64DFR0_PMUVER_IMP_DEF	U(0xf)
+
 #define EL_IMPL_NONE		U(0)
 #define EL_IMPL_A64ONLY		U(1)
 #define EL_IMPL_A64_A32		U(2)
@@ -125,6 +130,10 @@
 #define ID_AA64PFR0_GIC_WIDTH	U(4)
 #define ID_AA64PFR0_GIC_MASK	((U(1) << ID_AA64PFR0_GIC_WIDTH) - 1)
 
+/* ID_AA64ISAR0_EL1 definitions */
+#define ID_AA64ISAR0_CRC32_SHIFT	U(16)
+#define ID_AA64ISAR0_CRC32_MASK		U(0xf)
+
 /* ID_AA64MMFR0_EL1 definitions */
 #define ID_AA64MMFR0_EL1_PARANGE_MASK	U(0xf)
 
@@ -191,6 +200,7 @@
 #define SCR_RESET_VAL		SCR_RES1_BITS
 
 /* MDCR_EL3 definitions */
+#define MDCR_SPME_BIT		(U(1) << 17)
 #define MDCR_SPD32(x)		((x) << 14)
 #define MDCR_SPD32_LEGACY	U(0x0)
 #define MDCR_SPD32_DISABLE	U(0x2)
@@ -512,6 +522,19 @@
 #define PMCR_EL0_DP_BIT		(U(1) << 5)
 #define PMCR_EL0_X_BIT		(U(1) << 4)
 #define PMCR_EL0_D_BIT		(U(1) << 3)
+#define PMCR_EL0_E_BIT		(U(1) << 0)
+
+/* PMEVTYPER<n>_EL0 and PMCCFILTR_EL0 definitions */
+#define PMEVTYPER_P_BIT		(U(1) << 31)
+#define PMEVTYPER_U_BIT		(U(1) << 30)
+#define PMEVTYPER_NSK_BIT	(U(1) << 29)
+#define PMEVTYPER_NSU_BIT	(U(1) << 28)
+#define PMEVTYPER_NSH_BIT	(U(1) << 27)
+#define PMEVTYPER_M_BIT		(U(1) << 26)
+#define PMEVTYPER_EVTCOUNT_MASK	U(0x3ff)
+
+/* PMCCNTR_EL0 enable bit in PMCNTENSET_EL0 and PMCNTENCLR_EL0 */
+#define PMCNTEN_C_BIT		(U(1) << 31)
 
 /*******************************************************************************
  * Definitions of MAIR encodings for device and normal memory
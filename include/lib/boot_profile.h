@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __BOOT_PROFILE_H__
+#define __BOOT_PROFILE_H__
+
+#include <boot_profile_log.h>
+
+/*
+ * Macros recording a point in time, or the beginning or the end of a span, in
+ * the boot profile log. They compile to nothing unless ENABLE_BOOT_PROFILE is
+ * set. '_name' must be a string literal.
+ */
+#if ENABLE_BOOT_PROFILE
+#define BOOT_PROFILE_MARK(_name)					\
+	boot_profile_record(_name, BOOT_PROFILE_TYPE_MARK, 0)
+#define BOOT_PROFILE_BEGIN(_name, _arg)					\
+	boot_profile_record(_name, BOOT_PROFILE_TYPE_BEGIN, (_arg))
+#define BOOT_PROFILE_END(_name, _arg)					\
+	boot_profile_record(_name, BOOT_PROFILE_TYPE_END, (_arg))
+
+void boot_profile_init(void);
+void boot_profile_record(const char *name, unsigned int type,
+			 unsigned int arg);
+#else
+#define BOOT_PROFILE_MARK(_name)
+#define BOOT_PROFILE_BEGIN(_name, _arg)
+#define BOOT_PROFILE_END(_name, _arg)
+
+static inline void boot_profile_init(void)
+{
+}
+#endif /* ENABLE_BOOT_PROFILE */
+
+#endif /* __BOOT_PROFILE_H__ */
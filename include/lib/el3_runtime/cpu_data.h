@@ -51,6 +51,9 @@
 
 #include <arch_helpers.h>
 #include <cassert.h>
+#if GICV3_PCPU_CACHE
+#include <gicv3.h>
+#endif
 #include <platform_def.h>
 #include <psci.h>
 #include <stdint.h>
@@ -93,6 +96,9 @@ typedef struct cpu_data {
 	uint64_t cpu_data_pmf_ts[CPU_DATA_PMF_TS_COUNT];
 #endif
 	struct psci_cpu_data psci_svc_cpu_data;
+#if GICV3_PCPU_CACHE
+	gicv3_cpu_data_t gicv3_cpu_data;
+#endif
 #if PLAT_PCPU_DATA_SIZE
 	uint8_t platform_cpu_data[PLAT_PCPU_DATA_SIZE];
 #endif
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __MMIO_POLL_H__
+#define __MMIO_POLL_H__
+
+#include <stdint.h>
+
+/*
+ * Statistics of a polling call site. They are accumulated over all the polls
+ * of the site and printed by mmio_poll_dump_stats().
+ *
+ * 'calls'       : Number of polls.
+ * 'timeouts'    : Number of polls which timed out.
+ * 'iterations'  : Total number of times the condition was checked.
+ * 'total_us'    : Total time spent polling, in microseconds.
+ * 'max_us'      : Longest poll, in microseconds.
+ *
+ * When the system counter can't be used, the polls wait with udelay() and
+ * their time only includes these waits.
+ */
+typedef struct mmio_poll_stats {
+	const char *name;
+	unsigned int calls;
+	unsigned int timeouts;
+	uint64_t iterations;
+	uint64_t total_us;
+	uint64_t max_us;
+	struct mmio_poll_stats *next;
+} mmio_poll_stats_t;
+
+/* Define the statistics of a polling call site */
+#define MMIO_POLL_STATS(_name)						\
+	static mmio_poll_stats_t _name = { .name = #_name }
+
+/*
+ * State of a poll in progress, for conditions which aren't a simple test of
+ * register bits. The condition is checked in a loop which calls
+ * mmio_poll_wait() each time it isn't met, and mmio_poll_done() once it is.
+ *
+ * 'cnt_freq' is the frequency of the system counter, or 0 if the poll waits
+ * with udelay(). 'start' and 'deadline' are counter values in the first case.
+ * In the second, they are counts of nanoseconds waited like 'now', which is
+ * only used then.
+ */
+typedef struct mmio_poll {
+	mmio_poll_stats_t *stats;
+	unsigned int cnt_freq;
+	uint64_t start;
+	uint64_t now;
+	uint64_t deadline;
+	uint64_t backoff_ns;
+	unsigned int iterations;
+} mmio_poll_t;
+
+void mmio_poll_start(mmio_poll_t *poll, mmio_poll_stats_t *stats,
+		     uint32_t timeout_us);
+int mmio_poll_wait(mmio_poll_t *poll);
+void mmio_poll_done(mmio_poll_t *poll);
+
+int mmio_poll_set_32(mmio_poll_stats_t *stats, uintptr_t addr, uint32_t mask,
+		     uint32_t timeout_us, uint32_t *val);
+int mmio_poll_clr_32(mmio_poll_stats_t *stats, uintptr_t addr, uint32_t mask,
+		     uint32_t timeout_us, uint32_t *val);
+
+void mmio_poll_dump_stats(void);
+
+#endif /* __MMIO_POLL_H__ */
@@ -39,7 +39,13 @@
  */
 #define PMF_SMC_GET_TIMESTAMP_32	0x82000010
 #define PMF_SMC_GET_TIMESTAMP_64	0xC2000010
+#define PMF_SMC_GET_PMU_COUNT_32	0x82000011
+#define PMF_SMC_GET_PMU_COUNT_64	0xC2000011
+#if ENABLE_PMU_INSTRUMENTATION
+#define PMF_NUM_SMC_CALLS		4
+#else
 #define PMF_NUM_SMC_CALLS		2
+#endif
 
 /*
  * The macros below are used to identify
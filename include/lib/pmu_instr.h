@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __PMU_INSTR_H__
+#define __PMU_INSTR_H__
+
+/* Regions of EL3 code counted by the PMU instrumentation */
+#define PMU_INSTR_SMC			0
+#define PMU_INSTR_PSCI			1
+#define PMU_INSTR_EL1_CTX_SAVE		2
+#define PMU_INSTR_EL1_CTX_RESTORE	3
+#define PMU_INSTR_TOTAL_REGIONS		4
+
+/* Per-CPU aggregates of a region, as returned by PMF_SMC_GET_PMU_COUNT */
+#define PMU_INSTR_CNT_CALLS		0
+#define PMU_INSTR_CNT_CYCLES		1
+#define PMU_INSTR_CNT_INSTRUCTIONS	2
+#define PMU_INSTR_CNT_L1D_REFILLS	3
+#define PMU_INSTR_CNT_TLB_REFILLS	4
+#define PMU_INSTR_CNT_MAX_CYCLES	5
+#define PMU_INSTR_TOTAL_CNTS		6
+
+#ifndef __ASSEMBLY__
+
+#include <stdint.h>
+#include <types.h>
+
+/*
+ * Macros counting a region of EL3 code. They compile to nothing unless
+ * ENABLE_PMU_INSTRUMENTATION is set, and outside of BL31. The PMU is only
+ * claimed for EL3 while an SMC is handled, so regions outside of SMC handling
+ * aren't counted.
+ */
+#if ENABLE_PMU_INSTRUMENTATION && IMAGE_BL31
+#define PMU_INSTR_BEGIN(_region)	pmu_instr_region_begin(_region)
+#define PMU_INSTR_END(_region)		pmu_instr_region_end(_region)
+#else
+#define PMU_INSTR_BEGIN(_region)
+#define PMU_INSTR_END(_region)
+#endif
+
+void pmu_instr_region_begin(unsigned int region);
+void pmu_instr_region_end(unsigned int region);
+int pmu_instr_get_count_smc(unsigned int region,
+			    u_register_t mpidr,
+			    unsigned int cnt,
+			    unsigned long long *value);
+
+/* Called from the SMC handling and warm boot paths */
+void pmu_instr_smc_entry(void);
+void pmu_instr_smc_exit(void);
+void pmu_instr_warmboot(void);
+
+#endif /* __ASSEMBLY__ */
+
+#endif /* __PMU_INSTR_H__ */
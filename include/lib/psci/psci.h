@@ -306,8 +306,22 @@ typedef struct plat_psci_ops {
 	int (*write_mem_protect)(int val);
 	int (*system_reset2)(int is_vendor,
 				int reset_type, u_register_t cookie);
+	void (*pwr_domain_pwr_down_caches)(unsigned int pwr_lvl);
+	u_register_t (*get_pwr_lvl_state_min_residency)(
+				    plat_local_state_t local_state,
+				    int pwr_lvl);
 } plat_psci_ops_t;
 
+/*******************************************************************************
+ * Structure used to report the idle governor statistics of a non-CPU power
+ * domain. Residencies are in microseconds.
+ ******************************************************************************/
+typedef struct psci_idle_gov_stat {
+	u_register_t predicted_residency;
+	u_register_t samples;
+	u_register_t demotions;
+} psci_idle_gov_stat_t;
+
 /*******************************************************************************
  * Function & Data prototypes
  ******************************************************************************/
@@ -315,6 +329,11 @@ unsigned int psci_version(void);
 int psci_cpu_on(u_register_t target_cpu,
 		uintptr_t entrypoint,
 		u_register_t context_id);
+int psci_cpu_on_multi(const u_register_t *target_cpus,
+		      unsigned int num_cpus,
+		      uintptr_t entrypoint,
+		      u_register_t context_id,
+		      int *results);
 int psci_cpu_suspend(unsigned int power_state,
 		     uintptr_t entrypoint,
 		     u_register_t context_id);
@@ -327,7 +346,10 @@ int psci_migrate_info_type(void);
 long psci_migrate_info_up_cpu(void);
 int psci_node_hw_state(u_register_t target_cpu,
 		       unsigned int power_level);
+int psci_idle_gov_get_stat(u_register_t target_cpu, unsigned int power_level,
+			   psci_idle_gov_stat_t *stat);
 int psci_features(unsigned int psci_fid);
+u_register_t psci_get_cpu_mpidr_by_index(unsigned int cpu_idx);
 void __dead2 psci_power_down_wfi(void);
 void psci_arch_setup(void);
 
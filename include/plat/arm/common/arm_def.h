@@ -167,8 +167,21 @@
 
 /*
  * List of secure interrupts are deprecated, but are retained only to support
- * legacy configurations.
+ * legacy configurations. With EL3_TIMER, the secure physical timer drives the
+ * EL3 timers and is a Group 0 interrupt.
  */
+#if EL3_TIMER
+#define ARM_G1S_IRQS			ARM_IRQ_SEC_SGI_1,		\
+					ARM_IRQ_SEC_SGI_2,		\
+					ARM_IRQ_SEC_SGI_3,		\
+					ARM_IRQ_SEC_SGI_4,		\
+					ARM_IRQ_SEC_SGI_5,		\
+					ARM_IRQ_SEC_SGI_7
+
+#define ARM_G0_IRQS			ARM_IRQ_SEC_PHY_TIMER,		\
+					ARM_IRQ_SEC_SGI_0,		\
+					ARM_IRQ_SEC_SGI_6
+#else
 #define ARM_G1S_IRQS			ARM_IRQ_SEC_PHY_TIMER,		\
 					ARM_IRQ_SEC_SGI_1,		\
 					ARM_IRQ_SEC_SGI_2,		\
@@ -179,15 +192,30 @@
 
 #define ARM_G0_IRQS			ARM_IRQ_SEC_SGI_0,		\
 					ARM_IRQ_SEC_SGI_6
+#endif
 
 /*
  * Define a list of Group 1 Secure and Group 0 interrupt properties as per GICv3
  * terminology. On a GICv2 system or mode, the lists will be merged and treated
  * as Group 0 interrupts.
  */
-#define ARM_G1S_IRQ_PROPS(grp) \
+#define ARM_IRQ_SEC_PHY_TIMER_PROP(grp) \
 	INTR_PROP_DESC(ARM_IRQ_SEC_PHY_TIMER, GIC_HIGHEST_SEC_PRIORITY, grp, \
-			GIC_INTR_CFG_LEVEL), \
+			GIC_INTR_CFG_LEVEL)
+
+#if EL3_TIMER
+#define ARM_G1S_IRQ_PROPS(grp)		ARM_G1S_SGI_PROPS(grp)
+#define ARM_G0_IRQ_PROPS(grp) \
+	ARM_IRQ_SEC_PHY_TIMER_PROP(grp), \
+	ARM_G0_SGI_PROPS(grp)
+#else
+#define ARM_G1S_IRQ_PROPS(grp) \
+	ARM_IRQ_SEC_PHY_TIMER_PROP(grp), \
+	ARM_G1S_SGI_PROPS(grp)
+#define ARM_G0_IRQ_PROPS(grp)		ARM_G0_SGI_PROPS(grp)
+#endif
+
+#define ARM_G1S_SGI_PROPS(grp) \
 	INTR_PROP_DESC(ARM_IRQ_SEC_SGI_1, GIC_HIGHEST_SEC_PRIORITY, grp, \
 			GIC_INTR_CFG_EDGE), \
 	INTR_PROP_DESC(ARM_IRQ_SEC_SGI_2, GIC_HIGHEST_SEC_PRIORITY, grp, \
@@ -201,7 +229,7 @@
 	INTR_PROP_DESC(ARM_IRQ_SEC_SGI_7, GIC_HIGHEST_SEC_PRIORITY, grp, \
 			GIC_INTR_CFG_EDGE)
 
-#define ARM_G0_IRQ_PROPS(grp) \
+#define ARM_G0_SGI_PROPS(grp) \
 	INTR_PROP_DESC(ARM_IRQ_SEC_SGI_0, GIC_HIGHEST_SEC_PRIORITY, grp, \
 			GIC_INTR_CFG_EDGE), \
 	INTR_PROP_DESC(ARM_IRQ_SEC_SGI_6, GIC_HIGHEST_SEC_PRIORITY, grp, \
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __BOOT_PROFILE_LOG_H__
+#define __BOOT_PROFILE_LOG_H__
+
+#include <stdint.h>
+
+/*
+ * Layout of the boot profile log, shared by the firmware images which record
+ * it and by the host tool which renders it. All the fields are little endian.
+ */
+
+/* This is used as a signature to validate the log header ("BPRF") */
+#define BOOT_PROFILE_MAGIC		0x46525042
+#define BOOT_PROFILE_VERSION		1
+
+/* Maximum length of the name of an entry, including the terminating NUL */
+#define BOOT_PROFILE_NAME_LEN		24
+
+/* Types of the entries */
+#define BOOT_PROFILE_TYPE_MARK		0
+#define BOOT_PROFILE_TYPE_BEGIN		1
+#define BOOT_PROFILE_TYPE_END		2
+
+/* Images which record entries */
+#define BOOT_PROFILE_STAGE_BL1		1
+#define BOOT_PROFILE_STAGE_BL2		2
+#define BOOT_PROFILE_STAGE_BL31		31
+#define BOOT_PROFILE_STAGE_BL32		32
+
+/*
+ * An entry is a named point in time, or the beginning or the end of a named
+ * span. A span ends with the next END entry of the same stage, name and
+ * argument, so spans can be nested.
+ *
+ * 'timestamp' : System counter value.
+ * 'arg'       : Argument further identifying the entry, e.g. an image ID.
+ */
+typedef struct boot_profile_entry {
+	uint64_t timestamp;
+	uint32_t arg;
+	uint16_t stage;
+	uint16_t type;
+	char name[BOOT_PROFILE_NAME_LEN];
+} boot_profile_entry_t;
+
+/*
+ * 'num_entries' : Number of entries recorded.
+ * 'max_entries' : Number of entries which fit in the log.
+ * 'dropped'     : Number of entries which didn't fit in the log.
+ * 'cnt_freq'    : Frequency of the system counter in Hz.
+ */
+typedef struct boot_profile_log {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t num_entries;
+	uint32_t max_entries;
+	uint32_t dropped;
+	uint32_t reserved;
+	uint64_t cnt_freq;
+	boot_profile_entry_t entries[];
+} boot_profile_log_t;
+
+#endif /* __BOOT_PROFILE_LOG_H__ */
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <arch_helpers.h>
+#include <assert.h>
+#include <boot_profile.h>
+#include <platform.h>
+#include <platform_def.h>
+
+#if !defined(PLAT_BOOT_PROFILE_BASE) || !defined(PLAT_BOOT_PROFILE_SIZE)
+#error "ENABLE_BOOT_PROFILE requires PLAT_BOOT_PROFILE_BASE and _SIZE"
+#endif
+
+#if defined(IMAGE_BL1)
+#define BOOT_PROFILE_STAGE	BOOT_PROFILE_STAGE_BL1
+#elif defined(IMAGE_BL2)
+#define BOOT_PROFILE_STAGE	BOOT_PROFILE_STAGE_BL2
+#elif defined(IMAGE_BL31)
+#define BOOT_PROFILE_STAGE	BOOT_PROFILE_STAGE_BL31
+#elif defined(IMAGE_BL32)
+#define BOOT_PROFILE_STAGE	BOOT_PROFILE_STAGE_BL32
+#else
+#error "Unknown image for the boot profile"
+#endif
+
+/*
+ * The log is kept in a memory region which is preserved from one image to the
+ * next, so that all the images of the boot append to the same log. Each update
+ * is written back to memory, as the next image may access the region with
+ * different memory attributes.
+ */
+#define boot_profile_log ((boot_profile_log_t *)PLAT_BOOT_PROFILE_BASE)
+
+/*******************************************************************************
+ * Prepare the log for this image. BL1 starts a new log. The later images
+ * append to the log of the previous images, unless it isn't valid.
+ ******************************************************************************/
+void boot_profile_init(void)
+{
+	boot_profile_log_t *log = boot_profile_log;
+
+	assert(PLAT_BOOT_PROFILE_SIZE > sizeof(boot_profile_log_t));
+
+	inv_dcache_range((uintptr_t)log, sizeof(boot_profile_log_t));
+
+	if ((BOOT_PROFILE_STAGE != BOOT_PROFILE_STAGE_BL1) &&
+	    (log->magic == BOOT_PROFILE_MAGIC) &&
+	    (log->version == BOOT_PROFILE_VERSION))
+		return;
+
+	log->magic = BOOT_PROFILE_MAGIC;
+	log->version = BOOT_PROFILE_VERSION;
+	log->num_entries = 0;
+	log->max_entries = (PLAT_BOOT_PROFILE_SIZE - sizeof(boot_profile_log_t))
+			   / sizeof(boot_profile_entry_t);
+	log->dropped = 0;
+	log->reserved = 0;
+	log->cnt_freq = plat_get_syscnt_freq2();
+
+	flush_dcache_range((uintptr_t)log, sizeof(boot_profile_log_t));
+}
+
+/*******************************************************************************
+ * Append an entry to the log. Entries which don't fit in the log are only
+ * counted. The name is truncated to BOOT_PROFILE_NAME_LEN - 1 characters.
+ ******************************************************************************/
+void boot_profile_record(const char *name, unsigned int type,
+			 unsigned int arg)
+{
+	boot_profile_log_t *log = boot_profile_log;
+	boot_profile_entry_t *entry;
+	uint64_t timestamp = read_cntpct_el0();
+	unsigned int i;
+
+	assert(name != NULL);
+
+	if (log->magic != BOOT_PROFILE_MAGIC)
+		return;
+
+	if (log->num_entries >= log->max_entries) {
+		log->dropped++;
+		flush_dcache_range((uintptr_t)log, sizeof(boot_profile_log_t));
+		return;
+	}
+
+	entry = &log->entries[log->num_entries];
+	entry->timestamp = timestamp;
+	entry->arg = arg;
+	entry->stage = BOOT_PROFILE_STAGE;
+	entry->type = type;
+	for (i = 0; (i < BOOT_PROFILE_NAME_LEN - 1) && (name[i] != '\0'); i++)
+		entry->name[i] = name[i];
+	for (; i < BOOT_PROFILE_NAME_LEN; i++)
+		entry->name[i] = '\0';
+
+	log->num_entries++;
+
+	flush_dcache_range((uintptr_t)entry, sizeof(*entry));
+	flush_dcache_range((uintptr_t)log, sizeof(boot_profile_log_t));
+}
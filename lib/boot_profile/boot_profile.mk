@@ -0,0 +1,9 @@
+#
+# Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+#
+# SPDX-License-Identifier: BSD-3-Clause
+#
+
+ifeq (${ENABLE_BOOT_PROFILE},1)
+BL_COMMON_SOURCES	+=	lib/boot_profile/boot_profile.c
+endif
@@ -13,6 +13,7 @@
 #include <interrupt_mgmt.h>
 #include <platform.h>
 #include <platform_def.h>
+#include <pmu_instr.h>
 #include <pubsub_events.h>
 #include <smcc_helpers.h>
 #include <string.h>
@@ -438,6 +439,8 @@ void cm_el1_sysregs_context_save(uint32_t security_state)
 	ctx = cm_get_context(security_state);
 	assert(ctx);
 
+	PMU_INSTR_BEGIN(PMU_INSTR_EL1_CTX_SAVE);
+
 	el1_sysregs_context_save(get_sysregs_ctx(ctx));
 	el1_sysregs_context_save_post_ops();
 
@@ -447,6 +450,8 @@ void cm_el1_sysregs_context_save(uint32_t security_state)
 	else
 		PUBLISH_EVENT(cm_exited_normal_world);
 #endif
+
+	PMU_INSTR_END(PMU_INSTR_EL1_CTX_SAVE);
 }
 
 void cm_el1_sysregs_context_restore(uint32_t security_state)
@@ -456,6 +461,8 @@ void cm_el1_sysregs_context_restore(uint32_t security_state)
 	ctx = cm_get_context(security_state);
 	assert(ctx);
 
+	PMU_INSTR_BEGIN(PMU_INSTR_EL1_CTX_RESTORE);
+
 	el1_sysregs_context_restore(get_sysregs_ctx(ctx));
 
 #if IMAGE_BL31
@@ -464,6 +471,8 @@ void cm_el1_sysregs_context_restore(uint32_t security_state)
 	else
 		PUBLISH_EVENT(cm_entering_normal_world);
 #endif
+
+	PMU_INSTR_END(PMU_INSTR_EL1_CTX_RESTORE);
 }
 
 /*******************************************************************************
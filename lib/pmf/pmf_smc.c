@@ -7,6 +7,7 @@
 #include <debug.h>
 #include <platform.h>
 #include <pmf.h>
+#include <pmu_instr.h>
 #include <smcc_helpers.h>
 
 /*
@@ -23,6 +24,9 @@ uintptr_t pmf_smc_handler(unsigned int smc_fid,
 {
 	int rc;
 	unsigned long long ts_value;
+#if ENABLE_PMU_INSTRUMENTATION
+	unsigned long long cnt_value;
+#endif
 
 	if (((smc_fid >> FUNCID_CC_SHIFT) & FUNCID_CC_MASK) == SMC_32) {
 
@@ -42,6 +46,19 @@ uintptr_t pmf_smc_handler(unsigned int smc_fid,
 			SMC_RET3(handle, rc, (uint32_t)ts_value,
 					(uint32_t)(ts_value >> 32));
 
+#if ENABLE_PMU_INSTRUMENTATION
+		case PMF_SMC_GET_PMU_COUNT_32:
+			/*
+			 * Return error code and the aggregate of the PMU
+			 * instrumentation region to the caller.
+			 * x0 --> error code.
+			 * x1 - x2 --> aggregate value.
+			 */
+			rc = pmu_instr_get_count_smc(x1, x2, x3, &cnt_value);
+			SMC_RET3(handle, rc, (uint32_t)cnt_value,
+					(uint32_t)(cnt_value >> 32));
+#endif
+
 		default:
 			break;
 		}
@@ -57,6 +74,18 @@ uintptr_t pmf_smc_handler(unsigned int smc_fid,
 			rc = pmf_get_timestamp_smc(x1, x2, x3, &ts_value);
 			SMC_RET2(handle, rc, ts_value);
 
+#if ENABLE_PMU_INSTRUMENTATION
+		case PMF_SMC_GET_PMU_COUNT_64:
+			/*
+			 * Return error code and the aggregate of the PMU
+			 * instrumentation region to the caller.
+			 * x0 --> error code.
+			 * x1 --> aggregate value.
+			 */
+			rc = pmu_instr_get_count_smc(x1, x2, x3, &cnt_value);
+			SMC_RET2(handle, rc, cnt_value);
+#endif
+
 		default:
 			break;
 		}
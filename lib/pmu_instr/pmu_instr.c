@@ -0,0 +1,352 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <arch.h>
+#include <arch_helpers.h>
+#include <assert.h>
+#include <context.h>
+#include <context_mgmt.h>
+#include <debug.h>
+#include <errno.h>
+#include <platform.h>
+#include <platform_def.h>
+#include <pmu_instr.h>
+#include <pubsub_events.h>
+
+/*
+ * While an SMC is handled, the PMU is claimed for EL3: the state of the
+ * counters used by the instrumentation is saved, the other counters are
+ * stopped and MDCR_EL3.SPME allows counting in Secure state. The cycle counter
+ * and the event counters 0 to 2 then count the following PMUv3 common events
+ * at EL3 only. The PMU state of the lower ELs is restored before returning to
+ * them, so the instrumentation isn't visible to them.
+ */
+#define PMU_EV_L1D_CACHE_REFILL		0x03
+#define PMU_EV_L1D_TLB_REFILL		0x05
+#define PMU_EV_INST_RETIRED		0x08
+
+#define PMU_INSTR_NUM_EVCNTRS		3
+#define PMU_INSTR_CNTEN_MASK		(PMCNTEN_C_BIT | 0x7)
+
+/* Filter counting at EL3 only, in PMEVTYPER<n>_EL0 and PMCCFILTR_EL0 */
+#define PMU_INSTR_EL3_FILTER		(PMEVTYPER_P_BIT | PMEVTYPER_U_BIT | \
+					 PMEVTYPER_M_BIT)
+
+/* States of the instrumentation on a CPU */
+#define PMU_INSTR_UNKNOWN		0
+#define PMU_INSTR_UNSUPPORTED		1
+#define PMU_INSTR_IDLE			2
+#define PMU_INSTR_ACTIVE		3
+
+typedef struct pmu_instr_sample {
+	uint64_t cycles;
+	uint32_t evcntr[PMU_INSTR_NUM_EVCNTRS];
+} pmu_instr_sample_t;
+
+/* PMU state of the lower ELs, saved while an SMC is handled */
+typedef struct pmu_instr_lower_el {
+	u_register_t mdcr_el3;
+	u_register_t pmcr;
+	u_register_t pmcnten;
+	u_register_t pmccfiltr;
+	u_register_t pmccntr;
+	u_register_t evtyper[PMU_INSTR_NUM_EVCNTRS];
+	u_register_t evcntr[PMU_INSTR_NUM_EVCNTRS];
+} pmu_instr_lower_el_t;
+
+/*
+ * 'open'  : Bitmask of the regions being counted.
+ * 'start' : Counter values at the beginning of the regions being counted.
+ * 'cnt'   : Aggregates of the regions, indexed by PMU_INSTR_CNT_*.
+ */
+typedef struct pmu_instr_cpu {
+	unsigned int state;
+	unsigned int open;
+	pmu_instr_lower_el_t lower_el;
+	pmu_instr_sample_t start[PMU_INSTR_TOTAL_REGIONS];
+	unsigned long long cnt[PMU_INSTR_TOTAL_REGIONS][PMU_INSTR_TOTAL_CNTS];
+} __aligned(CACHE_WRITEBACK_GRANULE) pmu_instr_cpu_t;
+
+static pmu_instr_cpu_t pmu_instr_cpus[PLATFORM_CORE_COUNT];
+
+static inline pmu_instr_cpu_t *pmu_instr_this_cpu(void)
+{
+	return &pmu_instr_cpus[plat_my_core_pos()];
+}
+
+/*
+ * Check that this CPU implements PMUv3 with enough event counters and the
+ * events used by the instrumentation.
+ */
+static int pmu_instr_probe(void)
+{
+	unsigned int pmuver, num_cntrs;
+	uint64_t events = (1ULL << PMU_EV_L1D_CACHE_REFILL) |
+			  (1ULL << PMU_EV_L1D_TLB_REFILL) |
+			  (1ULL << PMU_EV_INST_RETIRED);
+
+	pmuver = (read_id_aa64dfr0_el1() >> ID_AA64DFR0_PMUVER_SHIFT) &
+		 ID_AA64DFR0_PMUVER_MASK;
+	if ((pmuver == 0) || (pmuver == ID_AA64DFR0_PMUVER_IMP_DEF))
+		return 0;
+
+	num_cntrs = (read_pmcr_el0() >> PMCR_EL0_N_SHIFT) & PMCR_EL0_N_MASK;
+	if (num_cntrs < PMU_INSTR_NUM_EVCNTRS)
+		return 0;
+
+	return (read_pmceid0_el0() & events) == events;
+}
+
+/*
+ * PMCR_EL0 value for the instrumentation, based on the one of the lower ELs:
+ * enable the counters, with a 64-bit cycle counter counting every cycle.
+ */
+static inline u_register_t pmu_instr_pmcr(u_register_t pmcr)
+{
+	return (pmcr & ~PMCR_EL0_D_BIT) | PMCR_EL0_LC_BIT | PMCR_EL0_E_BIT;
+}
+
+static void pmu_instr_sample(pmu_instr_sample_t *sample)
+{
+	isb();
+	sample->cycles = read_pmccntr_el0();
+	sample->evcntr[0] = read_pmevcntr0_el0();
+	sample->evcntr[1] = read_pmevcntr1_el0();
+	sample->evcntr[2] = read_pmevcntr2_el0();
+}
+
+/*******************************************************************************
+ * Claim the PMU for EL3 on the entry of an SMC, and start counting it. This is
+ * called from the SMC handling path, before the SMC handler.
+ ******************************************************************************/
+void pmu_instr_smc_entry(void)
+{
+	pmu_instr_cpu_t *cpu = pmu_instr_this_cpu();
+	pmu_instr_lower_el_t *lower_el = &cpu->lower_el;
+	u_register_t mdcr_el3;
+
+	if (cpu->state == PMU_INSTR_UNKNOWN) {
+		if (pmu_instr_probe() == 0) {
+			WARN("PMU instrumentation not supported on CPU %u\n",
+			     plat_my_core_pos());
+			cpu->state = PMU_INSTR_UNSUPPORTED;
+		} else {
+			cpu->state = PMU_INSTR_IDLE;
+		}
+	}
+
+	if (cpu->state != PMU_INSTR_IDLE)
+		return;
+
+	/* Save the PMU state of the lower ELs */
+	mdcr_el3 = read_mdcr_el3();
+	lower_el->mdcr_el3 = mdcr_el3;
+	lower_el->pmcr = read_pmcr_el0();
+	lower_el->pmcnten = read_pmcntenset_el0();
+	lower_el->pmccfiltr = read_pmccfiltr_el0();
+	lower_el->pmccntr = read_pmccntr_el0();
+	lower_el->evtyper[0] = read_pmevtyper0_el0();
+	lower_el->evtyper[1] = read_pmevtyper1_el0();
+	lower_el->evtyper[2] = read_pmevtyper2_el0();
+	lower_el->evcntr[0] = read_pmevcntr0_el0();
+	lower_el->evcntr[1] = read_pmevcntr1_el0();
+	lower_el->evcntr[2] = read_pmevcntr2_el0();
+
+	/*
+	 * Stop all the counters, so that those of the lower ELs don't count
+	 * EL3 events once counting is allowed in Secure state.
+	 */
+	write_pmcntenclr_el0(lower_el->pmcnten);
+	write_mdcr_el3(mdcr_el3 | MDCR_SPME_BIT);
+
+	write_pmevtyper0_el0(PMU_INSTR_EL3_FILTER | PMU_EV_INST_RETIRED);
+	write_pmevtyper1_el0(PMU_INSTR_EL3_FILTER | PMU_EV_L1D_CACHE_REFILL);
+	write_pmevtyper2_el0(PMU_INSTR_EL3_FILTER | PMU_EV_L1D_TLB_REFILL);
+	write_pmccfiltr_el0(PMU_INSTR_EL3_FILTER);
+	write_pmevcntr0_el0(0);
+	write_pmevcntr1_el0(0);
+	write_pmevcntr2_el0(0);
+	write_pmccntr_el0(0);
+
+	write_pmcr_el0(pmu_instr_pmcr(lower_el->pmcr));
+	write_pmcntenset_el0(PMU_INSTR_CNTEN_MASK);
+
+	cpu->open = 0;
+	cpu->state = PMU_INSTR_ACTIVE;
+
+	pmu_instr_region_begin(PMU_INSTR_SMC);
+}
+
+/*******************************************************************************
+ * Stop counting the SMC and give the PMU back to the lower ELs. This is called
+ * from the SMC handling path, before el3_exit().
+ ******************************************************************************/
+void pmu_instr_smc_exit(void)
+{
+	pmu_instr_cpu_t *cpu = pmu_instr_this_cpu();
+	pmu_instr_lower_el_t *lower_el = &cpu->lower_el;
+
+	if (cpu->state != PMU_INSTR_ACTIVE)
+		return;
+
+	pmu_instr_region_end(PMU_INSTR_SMC);
+
+	write_pmcntenclr_el0(PMU_INSTR_CNTEN_MASK);
+
+	write_pmevtyper0_el0(lower_el->evtyper[0]);
+	write_pmevtyper1_el0(lower_el->evtyper[1]);
+	write_pmevtyper2_el0(lower_el->evtyper[2]);
+	write_pmevcntr0_el0(lower_el->evcntr[0]);
+	write_pmevcntr1_el0(lower_el->evcntr[1]);
+	write_pmevcntr2_el0(lower_el->evcntr[2]);
+	write_pmccfiltr_el0(lower_el->pmccfiltr);
+	write_pmccntr_el0(lower_el->pmccntr);
+	write_pmcr_el0(lower_el->pmcr);
+
+	write_mdcr_el3(lower_el->mdcr_el3);
+	write_pmcntenset_el0(lower_el->pmcnten);
+	isb();
+
+	cpu->state = PMU_INSTR_IDLE;
+}
+
+/*******************************************************************************
+ * A CPU which powered down while handling an SMC resumes through the warm boot
+ * path, and has lost its PMU state. Forget about the SMC in progress.
+ ******************************************************************************/
+void pmu_instr_warmboot(void)
+{
+	pmu_instr_cpu_t *cpu = pmu_instr_this_cpu();
+
+	if (cpu->state == PMU_INSTR_ACTIVE)
+		cpu->state = PMU_INSTR_IDLE;
+}
+
+/*******************************************************************************
+ * Start counting a region. Regions can be nested, but a region can't be nested
+ * in itself.
+ ******************************************************************************/
+void pmu_instr_region_begin(unsigned int region)
+{
+	pmu_instr_cpu_t *cpu = pmu_instr_this_cpu();
+
+	assert(region < PMU_INSTR_TOTAL_REGIONS);
+
+	if (cpu->state != PMU_INSTR_ACTIVE)
+		return;
+
+	pmu_instr_sample(&cpu->start[region]);
+	cpu->open |= 1U << region;
+}
+
+/*******************************************************************************
+ * Stop counting a region, and add its counts to the aggregates of this CPU.
+ ******************************************************************************/
+void pmu_instr_region_end(unsigned int region)
+{
+	pmu_instr_cpu_t *cpu = pmu_instr_this_cpu();
+	pmu_instr_sample_t *start = &cpu->start[region];
+	unsigned long long *cnt = cpu->cnt[region];
+	pmu_instr_sample_t end;
+	uint64_t cycles;
+
+	assert(region < PMU_INSTR_TOTAL_REGIONS);
+
+	if ((cpu->state != PMU_INSTR_ACTIVE) ||
+	    ((cpu->open & (1U << region)) == 0))
+		return;
+
+	pmu_instr_sample(&end);
+	cpu->open &= ~(1U << region);
+
+	/* The event counters are 32-bit wide */
+	cycles = end.cycles - start->cycles;
+	cnt[PMU_INSTR_CNT_CALLS]++;
+	cnt[PMU_INSTR_CNT_CYCLES] += cycles;
+	cnt[PMU_INSTR_CNT_INSTRUCTIONS] +=
+		(uint32_t)(end.evcntr[0] - start->evcntr[0]);
+	cnt[PMU_INSTR_CNT_L1D_REFILLS] +=
+		(uint32_t)(end.evcntr[1] - start->evcntr[1]);
+	cnt[PMU_INSTR_CNT_TLB_REFILLS] +=
+		(uint32_t)(end.evcntr[2] - start->evcntr[2]);
+	if (cycles > cnt[PMU_INSTR_CNT_MAX_CYCLES])
+		cnt[PMU_INSTR_CNT_MAX_CYCLES] = cycles;
+}
+
+/*******************************************************************************
+ * Return the aggregate 'cnt' of 'region' for the CPU identified by 'mpidr'.
+ * This is used by the PMF SMC handler.
+ ******************************************************************************/
+int pmu_instr_get_count_smc(unsigned int region,
+			    u_register_t mpidr,
+			    unsigned int cnt,
+			    unsigned long long *value)
+{
+	int core_pos = plat_core_pos_by_mpidr(mpidr);
+
+	assert(value);
+
+	if ((core_pos < 0) || (region >= PMU_INSTR_TOTAL_REGIONS) ||
+	    (cnt >= PMU_INSTR_TOTAL_CNTS)) {
+		*value = 0;
+		return -EINVAL;
+	}
+
+	*value = pmu_instr_cpus[core_pos].cnt[region][cnt];
+	return 0;
+}
+
+/*
+ * cm_el1_sysregs_context_save() saves PMCR_EL0 in the context of the world
+ * being left. While the PMU is claimed, that is the value of the
+ * instrumentation, so replace it with the value of the lower ELs.
+ */
+static void pmu_instr_fix_saved_pmcr(uint32_t security_state)
+{
+	pmu_instr_cpu_t *cpu = pmu_instr_this_cpu();
+	cpu_context_t *ctx;
+
+	if (cpu->state != PMU_INSTR_ACTIVE)
+		return;
+
+	ctx = cm_get_context(security_state);
+	assert(ctx);
+	write_ctx_reg(get_sysregs_ctx(ctx), CTX_PMCR_EL0, cpu->lower_el.pmcr);
+}
+
+static void *pmu_instr_exited_secure_world(const void *arg)
+{
+	pmu_instr_fix_saved_pmcr(SECURE);
+	return NULL;
+}
+
+static void *pmu_instr_exited_normal_world(const void *arg)
+{
+	pmu_instr_fix_saved_pmcr(NON_SECURE);
+	return NULL;
+}
+
+/*
+ * cm_el1_sysregs_context_restore() restores PMCR_EL0 from the context of the
+ * world being entered. Keep it for the return to that world, and reclaim the
+ * PMU.
+ */
+static void *pmu_instr_entering_world(const void *arg)
+{
+	pmu_instr_cpu_t *cpu = pmu_instr_this_cpu();
+
+	if (cpu->state != PMU_INSTR_ACTIVE)
+		return NULL;
+
+	cpu->lower_el.pmcr = read_pmcr_el0();
+	write_pmcr_el0(pmu_instr_pmcr(cpu->lower_el.pmcr));
+	return NULL;
+}
+
+SUBSCRIBE_TO_EVENT(cm_exited_secure_world, pmu_instr_exited_secure_world);
+SUBSCRIBE_TO_EVENT(cm_exited_normal_world, pmu_instr_exited_normal_world);
+SUBSCRIBE_TO_EVENT(cm_entering_secure_world, pmu_instr_entering_world);
+SUBSCRIBE_TO_EVENT(cm_entering_normal_world, pmu_instr_entering_world);
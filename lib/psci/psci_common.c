@@ -11,6 +11,7 @@
 #include <context.h>
 #include <context_mgmt.h>
 #include <debug.h>
+#include <el3_timer.h>
 #include <platform.h>
 #include <string.h>
 #include <utils.h>
@@ -33,14 +34,49 @@ const spd_pm_ops_t *psci_spd_pm;
  * local states requested for a particular non cpu power domain by each cpu
  * within the domain.
  *
- * TODO: Dense packing of the requested states will cause cache thrashing
- * when multiple power domains write to it. If we allocate the requested
- * states at each power level in a cache-line aligned per-domain memory,
- * the cache thrashing can be avoided.
+ * With PSCI_INCREMENTAL_COORDINATION, the number of CPUs of each non cpu power
+ * domain that request each local power state is kept as well. It is updated
+ * along with the requested states, under the lock of the power domain, so the
+ * coordinated state of a domain is its shallowest state with a non-zero count
+ * and no longer needs a scan over all its CPUs.
  */
+#if PSCI_CACHE_ALIGNED_PD_DATA
+/*
+ * Dense packing of the requested states causes cache thrashing when CPUs of
+ * different power domains write to it. Here the states are grouped per non
+ * cpu power domain instead, each group in its own cache lines.
+ */
+typedef struct psci_pd_req_states {
+	plat_local_state_t states[PLATFORM_CORE_COUNT];
+#if PSCI_INCREMENTAL_COORDINATION
+	unsigned short count[PLAT_MAX_OFF_STATE + 1];
+#endif
+} __aligned(CACHE_WRITEBACK_GRANULE) psci_pd_req_states_t;
+
+static psci_pd_req_states_t
+	psci_req_local_pwr_states[PSCI_NUM_NON_CPU_PWR_DOMAINS];
+
+#define psci_req_state(lvl, node_idx, cpu_idx)				\
+	psci_req_local_pwr_states[node_idx].states[(cpu_idx) -		\
+		psci_non_cpu_pd_nodes[node_idx].cpu_start_idx]
+#define psci_req_state_count(node_idx, state)				\
+	psci_req_local_pwr_states[node_idx].count[state]
+#else
 static plat_local_state_t
 	psci_req_local_pwr_states[PLAT_MAX_PWR_LVL][PLATFORM_CORE_COUNT];
 
+#define psci_req_state(lvl, node_idx, cpu_idx)				\
+	psci_req_local_pwr_states[(lvl) - 1][cpu_idx]
+
+#if PSCI_INCREMENTAL_COORDINATION
+static unsigned short
+	psci_req_state_counts[PSCI_NUM_NON_CPU_PWR_DOMAINS][PLAT_MAX_OFF_STATE + 1];
+
+#define psci_req_state_count(node_idx, state)				\
+	psci_req_state_counts[node_idx][state]
+#endif
+#endif /* PSCI_CACHE_ALIGNED_PD_DATA */
+
 
 /*******************************************************************************
  * Arrays that hold the platform's power domain tree information for state
@@ -192,8 +228,13 @@ static unsigned int get_power_on_target_pwrlvl(void)
  *****************************************************************************/
 static void psci_set_req_local_pwr_state(unsigned int pwrlvl,
 					 unsigned int cpu_idx,
+					 unsigned int parent_idx,
 					 plat_local_state_t req_pwr_state)
 {
+#if PSCI_INCREMENTAL_COORDINATION
+	plat_local_state_t old_pwr_state;
+#endif
+
 	/*
 	 * This should never happen, we have this here to avoid
 	 * "array subscript is above array bounds" errors in GCC.
@@ -201,7 +242,17 @@ static void psci_set_req_local_pwr_state(unsigned int pwrlvl,
 	assert(pwrlvl > PSCI_CPU_PWR_LVL);
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Warray-bounds"
-	psci_req_local_pwr_states[pwrlvl - 1][cpu_idx] = req_pwr_state;
+#if PSCI_INCREMENTAL_COORDINATION
+	assert(req_pwr_state <= PLAT_MAX_OFF_STATE);
+	old_pwr_state = psci_req_state(pwrlvl, parent_idx, cpu_idx);
+	if (old_pwr_state != req_pwr_state) {
+		assert(psci_req_state_count(parent_idx, old_pwr_state) != 0);
+		psci_req_state_count(parent_idx, old_pwr_state)--;
+		psci_req_state_count(parent_idx, req_pwr_state)++;
+	}
+#endif
+	psci_req_state(pwrlvl, parent_idx, cpu_idx) = req_pwr_state;
+	(void)parent_idx;
 #pragma GCC diagnostic pop
 }
 
@@ -210,26 +261,65 @@ static void psci_set_req_local_pwr_state(unsigned int pwrlvl,
  *****************************************************************************/
 void psci_init_req_local_pwr_states(void)
 {
+#if PSCI_INCREMENTAL_COORDINATION
+	unsigned int i, state;
+#endif
+
 	/* Initialize the requested state of all non CPU power domains as OFF */
 	memset(&psci_req_local_pwr_states, PLAT_MAX_OFF_STATE,
 			sizeof(psci_req_local_pwr_states));
+
+#if PSCI_INCREMENTAL_COORDINATION
+	/* Hence every CPU of a power domain requests OFF */
+	for (i = 0; i < PSCI_NUM_NON_CPU_PWR_DOMAINS; i++) {
+		for (state = 0; state < PLAT_MAX_OFF_STATE; state++)
+			psci_req_state_count(i, state) = 0;
+		psci_req_state_count(i, PLAT_MAX_OFF_STATE) =
+			psci_non_cpu_pd_nodes[i].ncpus;
+	}
+#endif
+}
+
+#if PSCI_INCREMENTAL_COORDINATION
+/******************************************************************************
+ * Return the shallowest local power state requested by a CPU of the power
+ * domain 'parent_idx'. This is the policy of the default implementation of
+ * plat_get_target_pwr_state(), which this mode replaces.
+ *****************************************************************************/
+static plat_local_state_t psci_get_coordinated_pwr_state(
+		unsigned int parent_idx)
+{
+	plat_local_state_t state;
+
+	for (state = PSCI_LOCAL_STATE_RUN; state < PLAT_MAX_OFF_STATE; state++) {
+		if (psci_req_state_count(parent_idx, state) != 0)
+			break;
+	}
+	return state;
 }
+#endif
 
+#if !PSCI_INCREMENTAL_COORDINATION
 /******************************************************************************
  * Helper function to return a reference to an array containing the local power
- * states requested by each cpu for a power domain at 'pwrlvl'. The size of the
- * array will be the number of cpu power domains of which this power domain is
- * an ancestor. These requested states will be used to determine a suitable
- * target state for this power domain during psci state coordination. An
- * assertion is added to prevent us from accessing the CPU power level.
+ * states requested by each cpu for the power domain 'parent_idx' at 'pwrlvl'.
+ * The size of the array will be the number of cpu power domains of which this
+ * power domain is an ancestor. These requested states will be used to
+ * determine a suitable target state for this power domain during psci state
+ * coordination. An assertion is added to prevent us from accessing the CPU
+ * power level.
  *****************************************************************************/
 static plat_local_state_t *psci_get_req_local_pwr_states(unsigned int pwrlvl,
-							 unsigned int cpu_idx)
+							 unsigned int parent_idx)
 {
+	unsigned int cpu_idx;
+
 	assert(pwrlvl > PSCI_CPU_PWR_LVL);
 
-	return &psci_req_local_pwr_states[pwrlvl - 1][cpu_idx];
+	cpu_idx = psci_non_cpu_pd_nodes[parent_idx].cpu_start_idx;
+	return &psci_req_state(pwrlvl, parent_idx, cpu_idx);
 }
+#endif
 
 /*
  * psci_non_cpu_pd_nodes can be placed either in normal memory or coherent
@@ -363,6 +453,7 @@ void psci_set_pwr_domains_to_run(unsigned int end_pwrlvl)
 				PSCI_LOCAL_STATE_RUN);
 		psci_set_req_local_pwr_state(lvl,
 					     cpu_idx,
+					     parent_idx,
 					     PSCI_LOCAL_STATE_RUN);
 		parent_idx = psci_non_cpu_pd_nodes[parent_idx].parent_node;
 	}
@@ -391,15 +482,23 @@ void psci_set_pwr_domains_to_run(unsigned int end_pwrlvl)
  * The 'state_info' is updated with the target state for each level between the
  * CPU and the 'end_pwrlvl' and returned to the caller.
  *
+ * 'is_idle_req' is set when the request comes from an idle CPU_SUSPEND call,
+ * whose coordinated states may be demoted by the idle governor. The states
+ * requested by CPU_OFF and SYSTEM_SUSPEND are always honoured.
+ *
  * This function will only be invoked with data cache enabled and while
  * powering down a core.
  *****************************************************************************/
 void psci_do_state_coordination(unsigned int end_pwrlvl,
-				psci_power_state_t *state_info)
+				psci_power_state_t *state_info,
+				unsigned int is_idle_req)
 {
 	unsigned int lvl, parent_idx, cpu_idx = plat_my_core_pos();
-	unsigned int start_idx, ncpus;
-	plat_local_state_t target_state, *req_states;
+#if !PSCI_INCREMENTAL_COORDINATION
+	unsigned int ncpus;
+	plat_local_state_t *req_states;
+#endif
+	plat_local_state_t target_state;
 
 	assert(end_pwrlvl <= PLAT_MAX_PWR_LVL);
 	parent_idx = psci_cpu_pd_nodes[cpu_idx].parent_node;
@@ -409,12 +508,14 @@ void psci_do_state_coordination(unsigned int end_pwrlvl,
 	for (lvl = PSCI_CPU_PWR_LVL + 1; lvl <= end_pwrlvl; lvl++) {
 
 		/* First update the requested power state */
-		psci_set_req_local_pwr_state(lvl, cpu_idx,
+		psci_set_req_local_pwr_state(lvl, cpu_idx, parent_idx,
 					     state_info->pwr_domain_state[lvl]);
 
+#if PSCI_INCREMENTAL_COORDINATION
+		target_state = psci_get_coordinated_pwr_state(parent_idx);
+#else
 		/* Get the requested power states for this power level */
-		start_idx = psci_non_cpu_pd_nodes[parent_idx].cpu_start_idx;
-		req_states = psci_get_req_local_pwr_states(lvl, start_idx);
+		req_states = psci_get_req_local_pwr_states(lvl, parent_idx);
 
 		/*
 		 * Let the platform coordinate amongst the requested states at
@@ -424,6 +525,20 @@ void psci_do_state_coordination(unsigned int end_pwrlvl,
 		target_state = plat_get_target_pwr_state(lvl,
 							 req_states,
 							 ncpus);
+#endif
+
+#if PSCI_IDLE_GOVERNOR
+		/*
+		 * Demote the target state if this power domain isn't expected
+		 * to stay in it long enough to save energy.
+		 */
+		if (is_idle_req)
+			target_state = psci_idle_gov_select(lvl, parent_idx,
+					target_state,
+					state_info->pwr_domain_state[lvl - 1]);
+#else
+		(void)is_idle_req;
+#endif
 
 		state_info->pwr_domain_state[lvl] = target_state;
 
@@ -441,7 +556,8 @@ void psci_do_state_coordination(unsigned int end_pwrlvl,
 	 * set the target state as RUN.
 	 */
 	for (lvl = lvl + 1; lvl <= end_pwrlvl; lvl++) {
-		psci_set_req_local_pwr_state(lvl, cpu_idx,
+		parent_idx = psci_non_cpu_pd_nodes[parent_idx].parent_node;
+		psci_set_req_local_pwr_state(lvl, cpu_idx, parent_idx,
 					     state_info->pwr_domain_state[lvl]);
 		state_info->pwr_domain_state[lvl] = PSCI_LOCAL_STATE_RUN;
 
@@ -812,6 +928,15 @@ void psci_warmboot_entrypoint(void)
 	 */
 	psci_release_pwr_domain_locks(end_pwrlvl,
 				      cpu_idx);
+
+#if EL3_TIMER
+	/*
+	 * The secure physical timer of this CPU lost its state while the CPU
+	 * was powered down. Reprogram it with the earliest pending deadline now
+	 * that the platform has set up the CPU interface of the GIC again.
+	 */
+	el3_timer_resume();
+#endif
 }
 
 /*******************************************************************************
@@ -899,6 +1024,17 @@ void psci_print_power_domain_map(void)
 #endif
 }
 
+/******************************************************************************
+ * Return the MPIDR of the CPU with linear index 'cpu_idx' if it has been
+ * powered up at least once, and PSCI_INVALID_MPIDR otherwise.
+ *****************************************************************************/
+u_register_t psci_get_cpu_mpidr_by_index(unsigned int cpu_idx)
+{
+	assert(cpu_idx < PLATFORM_CORE_COUNT);
+
+	return psci_cpu_pd_nodes[cpu_idx].mpidr;
+}
+
 /******************************************************************************
  * Return whether any secondaries were powered up with CPU_ON call. A CPU that
  * have ever been powered up would have set its MPDIR value to something other
@@ -1012,6 +1148,20 @@ void psci_do_pwrdown_sequence(unsigned int power_level)
 	 * this call.
 	 */
 	prepare_cpu_pwr_dwn(power_level);
+#elif PSCI_RANGE_CACHE_MAINTENANCE
+	/*
+	 * Only clean the data of this image by VA, after disabling the data
+	 * cache. The platform then takes this CPU out of coherency and has the
+	 * power controller clean the caches. Without such a handler, fall back
+	 * to the CPU driver power down operations, which clean the caches by
+	 * set/way.
+	 */
+	psci_do_pwrdown_range_maintenance();
+
+	if (psci_plat_pm_ops->pwr_domain_pwr_down_caches)
+		psci_plat_pm_ops->pwr_domain_pwr_down_caches(power_level);
+	else
+		prepare_cpu_pwr_dwn(power_level);
 #else
 	/*
 	 * Without hardware-assisted coherency, the CPU drivers disable data
@@ -43,6 +43,46 @@ int psci_cpu_on(u_register_t target_cpu,
 	return psci_cpu_on_start(target_cpu, &ep);
 }
 
+/*******************************************************************************
+ * Extension of psci_cpu_on() for platform services, which turns on the
+ * `num_cpus` cpus in `target_cpus` at the same entry point. The result of the
+ * request for each cpu is returned in `results`, and the first error, if any,
+ * is returned. No cpu is turned on if the arguments are invalid.
+ ******************************************************************************/
+int psci_cpu_on_multi(const u_register_t *target_cpus,
+		      unsigned int num_cpus,
+		      uintptr_t entrypoint,
+		      u_register_t context_id,
+		      int *results)
+{
+	int rc, idx;
+	unsigned int i, j;
+	entry_point_info_t ep;
+
+	if (num_cpus == 0 || num_cpus > PLATFORM_CORE_COUNT)
+		return PSCI_E_INVALID_PARAMS;
+
+	/* Determine if the cpus exist and are only requested once */
+	for (i = 0; i < num_cpus; i++) {
+		rc = psci_validate_mpidr(target_cpus[i]);
+		if (rc != PSCI_E_SUCCESS)
+			return PSCI_E_INVALID_PARAMS;
+
+		idx = plat_core_pos_by_mpidr(target_cpus[i]);
+		for (j = 0; j < i; j++) {
+			if (plat_core_pos_by_mpidr(target_cpus[j]) == idx)
+				return PSCI_E_INVALID_PARAMS;
+		}
+	}
+
+	/* Validate the entry point and get the entry_point_info */
+	rc = psci_validate_entry_point(&ep, entrypoint, context_id);
+	if (rc != PSCI_E_SUCCESS)
+		return rc;
+
+	return psci_cpu_on_start_multi(target_cpus, num_cpus, &ep, results);
+}
+
 unsigned int psci_version(void)
 {
 	return PSCI_MAJOR_VER | PSCI_MINOR_VER;
@@ -142,7 +182,8 @@ int psci_cpu_suspend(unsigned int power_state,
 	psci_cpu_suspend_start(&ep,
 			    target_pwrlvl,
 			    &state_info,
-			    is_power_down_state);
+			    is_power_down_state,
+			    0);
 
 	return PSCI_E_SUCCESS;
 }
@@ -180,7 +221,8 @@ int psci_system_suspend(uintptr_t entrypoint, u_register_t context_id)
 	psci_cpu_suspend_start(&ep,
 			    PLAT_MAX_PWR_LVL,
 			    &state_info,
-			    PSTATE_TYPE_POWERDOWN);
+			    PSTATE_TYPE_POWERDOWN,
+			    1);
 
 	return PSCI_E_SUCCESS;
 }
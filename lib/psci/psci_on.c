@@ -32,36 +32,15 @@ static int cpu_on_validate_state(aff_info_state_t aff_state)
 }
 
 /*******************************************************************************
- * Generic handler which is called to physically power on a cpu identified by
- * its mpidr. It performs the generic, architectural, platform setup and state
- * management to power on the target cpu e.g. it will ensure that
- * enough information is stashed for it to resume execution in the non-secure
- * security state.
- *
- * The state of all the relevant power domains are changed after calling the
- * platform handler as it can return error.
+ * This function performs the generic state management needed before the target
+ * cpu can be powered on: it checks that the cpu is OFF and marks it ON_PENDING.
+ * It must be called with the cpu lock of the target held.
  ******************************************************************************/
-int psci_cpu_on_start(u_register_t target_cpu,
-		      entry_point_info_t *ep)
+static int cpu_on_prepare(u_register_t target_cpu, unsigned int target_idx)
 {
 	int rc;
-	unsigned int target_idx = plat_core_pos_by_mpidr(target_cpu);
 	aff_info_state_t target_aff_state;
 
-	/* Calling function must supply valid input arguments */
-	assert((int) target_idx >= 0);
-	assert(ep != NULL);
-
-	/*
-	 * This function must only be called on platforms where the
-	 * CPU_ON platform hooks have been implemented.
-	 */
-	assert(psci_plat_pm_ops->pwr_domain_on &&
-			psci_plat_pm_ops->pwr_domain_on_finish);
-
-	/* Protect against multiple CPUs trying to turn ON the same target CPU */
-	psci_spin_lock_cpu(target_idx);
-
 	/*
 	 * Generic management: Ensure that the cpu is off to be
 	 * turned on.
@@ -81,7 +60,7 @@ int psci_cpu_on_start(u_register_t target_cpu,
 	flush_cpu_data_by_index(target_idx, psci_svc_cpu_data.aff_info_state);
 	rc = cpu_on_validate_state(psci_get_aff_info_state_by_idx(target_idx));
 	if (rc != PSCI_E_SUCCESS)
-		goto exit;
+		return rc;
 
 	/*
 	 * Call the cpu on handler registered by the Secure Payload Dispatcher
@@ -114,15 +93,17 @@ int psci_cpu_on_start(u_register_t target_cpu,
 		assert(psci_get_aff_info_state_by_idx(target_idx) == AFF_STATE_ON_PENDING);
 	}
 
-	/*
-	 * Perform generic, architecture and platform specific handling.
-	 */
-	/*
-	 * Plat. management: Give the platform the current state
-	 * of the target cpu to allow it to perform the necessary
-	 * steps to power on.
-	 */
-	rc = psci_plat_pm_ops->pwr_domain_on(target_cpu);
+	return PSCI_E_SUCCESS;
+}
+
+/*******************************************************************************
+ * This function completes the state management of the target cpu once the
+ * platform has been asked to power it on, `rc` being the result of that request.
+ * It must be called with the cpu lock of the target held.
+ ******************************************************************************/
+static void cpu_on_complete(unsigned int target_idx, entry_point_info_t *ep,
+			    int rc)
+{
 	assert(rc == PSCI_E_SUCCESS || rc == PSCI_E_INTERN_FAIL);
 
 	if (rc == PSCI_E_SUCCESS)
@@ -133,12 +114,138 @@ int psci_cpu_on_start(u_register_t target_cpu,
 		psci_set_aff_info_state_by_idx(target_idx, AFF_STATE_OFF);
 		flush_cpu_data_by_index(target_idx, psci_svc_cpu_data.aff_info_state);
 	}
+}
+
+/*******************************************************************************
+ * Generic handler which is called to physically power on a cpu identified by
+ * its mpidr. It performs the generic, architectural, platform setup and state
+ * management to power on the target cpu e.g. it will ensure that
+ * enough information is stashed for it to resume execution in the non-secure
+ * security state.
+ *
+ * The state of all the relevant power domains are changed after calling the
+ * platform handler as it can return error.
+ ******************************************************************************/
+int psci_cpu_on_start(u_register_t target_cpu,
+		      entry_point_info_t *ep)
+{
+	int rc;
+	unsigned int target_idx = plat_core_pos_by_mpidr(target_cpu);
+
+	/* Calling function must supply valid input arguments */
+	assert((int) target_idx >= 0);
+	assert(ep != NULL);
+
+	/*
+	 * This function must only be called on platforms where the
+	 * CPU_ON platform hooks have been implemented.
+	 */
+	assert(psci_plat_pm_ops->pwr_domain_on &&
+			psci_plat_pm_ops->pwr_domain_on_finish);
+
+	/* Protect against multiple CPUs trying to turn ON the same target CPU */
+	psci_spin_lock_cpu(target_idx);
+
+	rc = cpu_on_prepare(target_cpu, target_idx);
+	if (rc != PSCI_E_SUCCESS)
+		goto exit;
+
+	/*
+	 * Perform generic, architecture and platform specific handling.
+	 */
+	/*
+	 * Plat. management: Give the platform the current state
+	 * of the target cpu to allow it to perform the necessary
+	 * steps to power on.
+	 */
+	rc = psci_plat_pm_ops->pwr_domain_on(target_cpu);
+	cpu_on_complete(target_idx, ep, rc);
 
 exit:
 	psci_spin_unlock_cpu(target_idx);
 	return rc;
 }
 
+/*******************************************************************************
+ * Generic handler which is called to power on several cpus at once, all of them
+ * starting at the same entry point. The cpu locks of the targets are taken in
+ * order of linear index, so that concurrent callers can't deadlock. The power
+ * on requests are then issued back to back, and only after that are the
+ * contexts of the targets initialised and their locks released. The targets
+ * thus come out of reset while the contexts are being initialised, each of
+ * them waiting for its lock in psci_cpu_on_finish().
+ *
+ * `target_cpus` holds `num_cpus` distinct and valid mpidrs. The result for each
+ * target is returned in `results`, and the first error, if any, is returned.
+ ******************************************************************************/
+int psci_cpu_on_start_multi(const u_register_t *target_cpus,
+			    unsigned int num_cpus,
+			    entry_point_info_t *ep,
+			    int *results)
+{
+	int slot[PLATFORM_CORE_COUNT];
+	unsigned int i, idx;
+	int rc = PSCI_E_SUCCESS;
+
+	assert(target_cpus != NULL && results != NULL && ep != NULL);
+	assert(num_cpus <= PLATFORM_CORE_COUNT);
+	assert(psci_plat_pm_ops->pwr_domain_on &&
+			psci_plat_pm_ops->pwr_domain_on_finish);
+
+	for (idx = 0; idx < PLATFORM_CORE_COUNT; idx++)
+		slot[idx] = -1;
+
+	for (i = 0; i < num_cpus; i++) {
+		idx = plat_core_pos_by_mpidr(target_cpus[i]);
+		assert((int) idx >= 0 && slot[idx] == -1);
+		slot[idx] = i;
+	}
+
+	/*
+	 * Lock and validate all the targets. Those that can't be turned on
+	 * are released straight away.
+	 */
+	for (idx = 0; idx < PLATFORM_CORE_COUNT; idx++) {
+		if (slot[idx] < 0)
+			continue;
+
+		i = slot[idx];
+		psci_spin_lock_cpu(idx);
+		results[i] = cpu_on_prepare(target_cpus[i], idx);
+		if (results[i] != PSCI_E_SUCCESS) {
+			psci_spin_unlock_cpu(idx);
+			slot[idx] = -1;
+		}
+	}
+
+	/* Issue the power on requests back to back */
+	for (idx = 0; idx < PLATFORM_CORE_COUNT; idx++) {
+		if (slot[idx] < 0)
+			continue;
+
+		i = slot[idx];
+		results[i] = psci_plat_pm_ops->pwr_domain_on(target_cpus[i]);
+	}
+
+	/* Initialise the contexts and release the targets */
+	for (idx = 0; idx < PLATFORM_CORE_COUNT; idx++) {
+		if (slot[idx] < 0)
+			continue;
+
+		cpu_on_complete(idx, ep, results[slot[idx]]);
+		psci_spin_unlock_cpu(idx);
+	}
+
+	for (i = 0; i < num_cpus; i++) {
+		if (results[i] != PSCI_E_SUCCESS) {
+			rc = results[i];
+			break;
+		}
+	}
+
+	return rc;
+}
+
 /*******************************************************************************
  * The following function finish an earlier power on request. They
  * are called by the common finisher routine in psci_common.c. The `state_info`
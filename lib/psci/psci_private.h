@@ -31,13 +31,24 @@
  * On systems where participant CPUs are cache-coherent, we can use spinlocks
  * instead of bakery locks.
  */
+#if PSCI_CACHE_ALIGNED_PD_DATA
+/* Give the lock of each power domain a cache line of its own */
+typedef struct psci_spinlock {
+	spinlock_t lock;
+} __aligned(CACHE_WRITEBACK_GRANULE) psci_spinlock_t;
+
+#define DEFINE_PSCI_LOCK(_name)		psci_spinlock_t _name
+#define psci_lock_ptr(idx)		(&psci_locks[(idx)].lock)
+#else
 #define DEFINE_PSCI_LOCK(_name)		spinlock_t _name
+#define psci_lock_ptr(idx)		(&psci_locks[(idx)])
+#endif
 #define DECLARE_PSCI_LOCK(_name)	extern DEFINE_PSCI_LOCK(_name)
 
 #define psci_lock_get(non_cpu_pd_node)				\
-	spin_lock(&psci_locks[(non_cpu_pd_node)->lock_index])
+	spin_lock(psci_lock_ptr((non_cpu_pd_node)->lock_index))
 #define psci_lock_release(non_cpu_pd_node)			\
-	spin_unlock(&psci_locks[(non_cpu_pd_node)->lock_index])
+	spin_unlock(psci_lock_ptr((non_cpu_pd_node)->lock_index))
 
 #else
 
@@ -126,6 +137,19 @@
 #define is_cpu_standby_req(is_power_down_state, retn_lvl) \
 		(((!(is_power_down_state)) && ((retn_lvl) == 0)) ? 1 : 0)
 
+/*
+ * With PSCI_CACHE_ALIGNED_PD_DATA, each power domain node gets a cache line of
+ * its own, so that updating or flushing the state of a domain never touches
+ * the data of its siblings. The bakery locks need no such padding: their
+ * per-CPU data already lives in cache line aligned per-CPU blocks, or in
+ * uncached coherent memory.
+ */
+#if PSCI_CACHE_ALIGNED_PD_DATA
+#define __psci_pd_node_aligned	__aligned(CACHE_WRITEBACK_GRANULE)
+#else
+#define __psci_pd_node_aligned
+#endif
+
 /*******************************************************************************
  * The following two data structures implement the power domain tree. The tree
  * is used to track the state of all the nodes i.e. power domain instances
@@ -159,7 +183,7 @@ typedef struct non_cpu_pwr_domain_node {
 
 	/* For indexing the psci_lock array*/
 	unsigned char lock_index;
-} non_cpu_pd_node_t;
+} __psci_pd_node_aligned non_cpu_pd_node_t;
 
 typedef struct cpu_pwr_domain_node {
 	u_register_t mpidr;
@@ -177,7 +201,7 @@ typedef struct cpu_pwr_domain_node {
 	 * when multiple CPUs try to turn ON the same target CPU.
 	 */
 	spinlock_t cpu_lock;
-} cpu_pd_node_t;
+} __psci_pd_node_aligned cpu_pd_node_t;
 
 /*******************************************************************************
  * Data prototypes
@@ -212,7 +236,8 @@ void psci_get_parent_pwr_domain_nodes(unsigned int cpu_idx,
 				      unsigned int end_lvl,
 				      unsigned int node_index[]);
 void psci_do_state_coordination(unsigned int end_pwrlvl,
-				psci_power_state_t *state_info);
+				psci_power_state_t *state_info,
+				unsigned int is_idle_req);
 void psci_acquire_pwr_domain_locks(unsigned int end_pwrlvl,
 				   unsigned int cpu_idx);
 void psci_release_pwr_domain_locks(unsigned int end_pwrlvl,
@@ -237,6 +262,10 @@ void prepare_cpu_pwr_dwn(unsigned int power_level);
 /* Private exported functions from psci_on.c */
 int psci_cpu_on_start(u_register_t target_cpu,
 		      entry_point_info_t *ep);
+int psci_cpu_on_start_multi(const u_register_t *target_cpus,
+			    unsigned int num_cpus,
+			    entry_point_info_t *ep,
+			    int *results);
 
 void psci_cpu_on_finish(unsigned int cpu_idx,
 			psci_power_state_t *state_info);
@@ -248,7 +277,8 @@ int psci_do_cpu_off(unsigned int end_pwrlvl);
 void psci_cpu_suspend_start(entry_point_info_t *ep,
 			unsigned int end_pwrlvl,
 			psci_power_state_t *state_info,
-			unsigned int is_power_down_state_req);
+			unsigned int is_power_down_state_req,
+			unsigned int is_sys_suspend);
 
 void psci_cpu_suspend_finish(unsigned int cpu_idx,
 			psci_power_state_t *state_info);
@@ -256,6 +286,9 @@ void psci_cpu_suspend_finish(unsigned int cpu_idx,
 /* Private exported functions from psci_helpers.S */
 void psci_do_pwrdown_cache_maintenance(unsigned int pwr_level);
 void psci_do_pwrup_cache_maintenance(void);
+#if PSCI_RANGE_CACHE_MAINTENANCE
+void psci_do_pwrdown_range_maintenance(void);
+#endif
 
 /* Private exported functions from psci_system_off.c */
 void __dead2 psci_system_off(void);
@@ -267,6 +300,12 @@ void psci_stats_update_pwr_down(unsigned int end_pwrlvl,
 			const psci_power_state_t *state_info);
 void psci_stats_update_pwr_up(unsigned int end_pwrlvl,
 			const psci_power_state_t *state_info);
+#if PSCI_IDLE_GOVERNOR
+plat_local_state_t psci_idle_gov_select(unsigned int lvl,
+			unsigned int parent_idx,
+			plat_local_state_t target_state,
+			plat_local_state_t child_state);
+#endif
 u_register_t psci_stat_residency(u_register_t target_cpu,
 			unsigned int power_state);
 u_register_t psci_stat_count(u_register_t target_cpu,
@@ -4,10 +4,12 @@
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
+#include <arch_helpers.h>
 #include <assert.h>
 #include <debug.h>
 #include <platform.h>
 #include <platform_def.h>
+#include <spinlock.h>
 #include "psci_private.h"
 
 #ifndef PLAT_MAX_PWR_LVL_STATES
@@ -35,6 +37,169 @@ static psci_stat_t psci_cpu_stat[PLATFORM_CORE_COUNT]
 static psci_stat_t psci_non_cpu_stat[PSCI_NUM_NON_CPU_PWR_DOMAINS]
 				[PLAT_MAX_PWR_LVL_STATES];
 
+#if PSCI_IDLE_GOVERNOR
+/* Ticks elapsed in one second by a signal of 1 MHz */
+#define MHZ_TICKS_PER_SEC		1000000
+
+/*
+ * Weight of a new residency sample in the prediction of the idle governor, as
+ * a power of two: each sample accounts for 1/8th of the prediction.
+ */
+#define PSCI_IDLE_GOV_WEIGHT_SHIFT	3
+
+/*
+ * Following structure is used by the idle governor for non CPU domains. The
+ * lock protects the structure on the wake up paths, which don't all hold the
+ * lock of the power domain.
+ */
+typedef struct psci_idle_gov {
+	psci_idle_gov_stat_t stat;
+	/* Timestamp of the demotion of the domain to RUN, 0 if not demoted */
+	unsigned long long demote_ts;
+	spinlock_t lock;
+} psci_idle_gov_t;
+
+static psci_idle_gov_t psci_idle_gov[PSCI_NUM_NON_CPU_PWR_DOMAINS];
+
+/*
+ * This function folds a residency sample, in microseconds, into the predicted
+ * residency of a non cpu power domain. It is called with the governor lock of
+ * the domain held.
+ */
+static void psci_idle_gov_update(psci_idle_gov_t *gov, u_register_t residency)
+{
+	psci_idle_gov_stat_t *stat = &gov->stat;
+
+	if (stat->samples++ == 0) {
+		stat->predicted_residency = residency;
+		return;
+	}
+
+	stat->predicted_residency -=
+		stat->predicted_residency >> PSCI_IDLE_GOV_WEIGHT_SHIFT;
+	stat->predicted_residency += residency >> PSCI_IDLE_GOV_WEIGHT_SHIFT;
+}
+
+/*
+ * A domain demoted to RUN doesn't enter any low power state, so the PSCI stats
+ * don't measure how long it stayed idle. This function is called on every
+ * wake up path of a cpu. For each ancestor of the cpu which was demoted and
+ * which this cpu is the first to leave, it samples the time elapsed since the
+ * demotion instead.
+ */
+static void psci_idle_gov_wake_up(unsigned int cpu_idx)
+{
+	unsigned int lvl, parent_idx = psci_cpu_pd_nodes[cpu_idx].parent_node;
+	unsigned long long ts;
+	u_register_t residency_div;
+	psci_idle_gov_t *gov;
+
+	for (lvl = PSCI_CPU_PWR_LVL + 1; lvl <= PLAT_MAX_PWR_LVL; lvl++) {
+		gov = &psci_idle_gov[parent_idx];
+		parent_idx = psci_non_cpu_pd_nodes[parent_idx].parent_node;
+
+		/* Skip the lock in the common case of a domain not demoted */
+		if (gov->demote_ts == 0)
+			continue;
+
+		spin_lock(&gov->lock);
+
+		ts = gov->demote_ts;
+		gov->demote_ts = 0;
+		if (ts != 0) {
+			residency_div = read_cntfrq_el0() / MHZ_TICKS_PER_SEC;
+			assert(residency_div);
+
+			psci_idle_gov_update(gov,
+				(read_cntpct_el0() - ts) / residency_div);
+		}
+
+		spin_unlock(&gov->lock);
+	}
+}
+
+/*******************************************************************************
+ * This function is called during state coordination, with the lock of the
+ * non cpu power domain `parent_idx` at `lvl` held, once its target state has
+ * been negotiated. It returns the deepest state, no deeper than `target_state`
+ * and `child_state`, whose break-even residency declared by the platform is
+ * covered by the predicted residency of the domain. If there is none, the
+ * domain is demoted to RUN.
+ ******************************************************************************/
+plat_local_state_t psci_idle_gov_select(unsigned int lvl,
+			unsigned int parent_idx,
+			plat_local_state_t target_state,
+			plat_local_state_t child_state)
+{
+	psci_idle_gov_t *gov = &psci_idle_gov[parent_idx];
+	plat_local_state_t state;
+	u_register_t predicted_residency;
+
+	if (is_local_state_run(target_state) ||
+	    !psci_plat_pm_ops->get_pwr_lvl_state_min_residency)
+		return target_state;
+
+	/* The domain can't enter a deeper state than its children */
+	if (target_state > child_state)
+		target_state = child_state;
+
+	spin_lock(&gov->lock);
+
+	/* Without any history, trust the coordinated state */
+	if (gov->stat.samples == 0) {
+		spin_unlock(&gov->lock);
+		return target_state;
+	}
+
+	predicted_residency = gov->stat.predicted_residency;
+	for (state = target_state; !is_local_state_run(state); state--) {
+		if (psci_plat_pm_ops->get_pwr_lvl_state_min_residency(state,
+				lvl) <= predicted_residency)
+			break;
+	}
+
+	if (state != target_state)
+		gov->stat.demotions++;
+
+	if (is_local_state_run(state))
+		gov->demote_ts = read_cntpct_el0();
+
+	spin_unlock(&gov->lock);
+
+	return state;
+}
+
+/*******************************************************************************
+ * This function returns the idle governor statistics of the power domain at
+ * `power_level` which is an ancestor of `target_cpu`.
+ ******************************************************************************/
+int psci_idle_gov_get_stat(u_register_t target_cpu, unsigned int power_level,
+			   psci_idle_gov_stat_t *stat)
+{
+	unsigned int lvl, parent_idx;
+	int target_idx;
+
+	assert(stat);
+
+	target_idx = plat_core_pos_by_mpidr(target_cpu);
+	if (target_idx == -1)
+		return PSCI_E_INVALID_PARAMS;
+
+	if (power_level <= PSCI_CPU_PWR_LVL || power_level > PLAT_MAX_PWR_LVL)
+		return PSCI_E_INVALID_PARAMS;
+
+	parent_idx = psci_cpu_pd_nodes[target_idx].parent_node;
+	for (lvl = PSCI_CPU_PWR_LVL + 1; lvl < power_level; lvl++)
+		parent_idx = psci_non_cpu_pd_nodes[parent_idx].parent_node;
+
+	spin_lock(&psci_idle_gov[parent_idx].lock);
+	*stat = psci_idle_gov[parent_idx].stat;
+	spin_unlock(&psci_idle_gov[parent_idx].lock);
+
+	return PSCI_E_SUCCESS;
+}
+#endif /* PSCI_IDLE_GOVERNOR */
+
 /*
  * This functions returns the index into the `psci_stat_t` array given the
  * local power state and power domain level. If the platform implements the
@@ -124,6 +289,11 @@ void psci_stats_update_pwr_up(unsigned int end_pwrlvl,
 	psci_cpu_stat[cpu_idx][stat_idx].residency += residency;
 	psci_cpu_stat[cpu_idx][stat_idx].count++;
 
+#if PSCI_IDLE_GOVERNOR
+	/* The ancestors of this CPU may have been demoted by the governor */
+	psci_idle_gov_wake_up(cpu_idx);
+#endif
+
 	/*
 	 * Check what power domains above CPU were off
 	 * prior to this CPU powering on.
@@ -152,6 +322,12 @@ void psci_stats_update_pwr_up(unsigned int end_pwrlvl,
 		psci_non_cpu_stat[parent_idx][stat_idx].residency += residency;
 		psci_non_cpu_stat[parent_idx][stat_idx].count++;
 
+#if PSCI_IDLE_GOVERNOR
+		spin_lock(&psci_idle_gov[parent_idx].lock);
+		psci_idle_gov_update(&psci_idle_gov[parent_idx], residency);
+		spin_unlock(&psci_idle_gov[parent_idx].lock);
+#endif
+
 		parent_idx = psci_non_cpu_pd_nodes[parent_idx].parent_node;
 	}
 
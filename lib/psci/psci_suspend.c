@@ -138,11 +138,15 @@ static void psci_suspend_to_pwrdown_start(unsigned int end_pwrlvl,
  * All the required parameter checks are performed at the beginning and after
  * the state transition has been done, no further error is expected and it is
  * not possible to undo any of the actions taken beyond that point.
+ *
+ * 'is_sys_suspend' is set for SYSTEM_SUSPEND, whose requested states are not
+ * subject to the idle governor.
  ******************************************************************************/
 void psci_cpu_suspend_start(entry_point_info_t *ep,
 			    unsigned int end_pwrlvl,
 			    psci_power_state_t *state_info,
-			    unsigned int is_power_down_state)
+			    unsigned int is_power_down_state,
+			    unsigned int is_sys_suspend)
 {
 	int skip_wfi = 0;
 	unsigned int idx = plat_my_core_pos();
@@ -177,7 +181,7 @@ void psci_cpu_suspend_start(entry_point_info_t *ep,
 	 * it returns the negotiated state info for each power level upto
 	 * the end level specified.
 	 */
-	psci_do_state_coordination(end_pwrlvl, state_info);
+	psci_do_state_coordination(end_pwrlvl, state_info, !is_sys_suspend);
 
 #if ENABLE_PSCI_STAT
 	/* Update the last cpu for each level till end_pwrlvl */
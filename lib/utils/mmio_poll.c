@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <arch_helpers.h>
+#include <assert.h>
+#include <debug.h>
+#include <delay_timer.h>
+#include <errno.h>
+#include <mmio.h>
+#include <mmio_poll.h>
+
+/*
+ * The condition is checked MMIO_POLL_SPIN_COUNT times back to back, so that
+ * short waits aren't slowed down. Then the delay between two checks starts at
+ * MMIO_POLL_MIN_BACKOFF_NS and doubles up to MMIO_POLL_MAX_BACKOFF_NS, which
+ * bounds how late the end of a long wait is noticed.
+ *
+ * The delays are waited on the system counter. When it can't be used, they
+ * are waited with udelay() on the platform delay timer, rounded up to whole
+ * microseconds, and the timeout only accounts for them.
+ */
+#define MMIO_POLL_SPIN_COUNT		16
+#define MMIO_POLL_MIN_BACKOFF_NS	100
+#define MMIO_POLL_MAX_BACKOFF_NS	64000
+
+/* Call sites which have polled at least once, for mmio_poll_dump_stats() */
+static mmio_poll_stats_t *mmio_poll_sites;
+
+static uint64_t mmio_poll_now(mmio_poll_t *poll)
+{
+	return (poll->cnt_freq != 0) ? read_cntpct_el0() : poll->now;
+}
+
+static void mmio_poll_record(mmio_poll_t *poll)
+{
+	mmio_poll_stats_t *stats = poll->stats;
+	uint64_t us = mmio_poll_now(poll) - poll->start;
+
+	if (poll->cnt_freq != 0)
+		us = (us * 1000000) / poll->cnt_freq;
+	else
+		us /= 1000;
+
+	if (stats->calls == 0) {
+		stats->next = mmio_poll_sites;
+		mmio_poll_sites = stats;
+	}
+
+	stats->calls++;
+	stats->iterations += poll->iterations;
+	stats->total_us += us;
+	if (us > stats->max_us)
+		stats->max_us = us;
+}
+
+/*
+ * Start a poll which times out after 'timeout_us' microseconds, accounted in
+ * 'stats'.
+ */
+void mmio_poll_start(mmio_poll_t *poll, mmio_poll_stats_t *stats,
+		     uint32_t timeout_us)
+{
+	assert((poll != NULL) && (stats != NULL));
+
+	poll->stats = stats;
+	poll->cnt_freq = delay_counter_freq();
+	if (poll->cnt_freq != 0) {
+		poll->deadline = delay_deadline_ns((uint64_t)timeout_us * 1000);
+		poll->start = read_cntpct_el0();
+	} else {
+		poll->deadline = (uint64_t)timeout_us * 1000;
+		poll->start = 0;
+		poll->now = 0;
+	}
+	poll->backoff_ns = MMIO_POLL_MIN_BACKOFF_NS;
+	poll->iterations = 0;
+}
+
+/*
+ * Called each time the condition of the poll isn't met. Returns -ETIMEDOUT
+ * once the timeout has expired, which ends the poll. Otherwise it waits before
+ * the next check and returns 0.
+ */
+int mmio_poll_wait(mmio_poll_t *poll)
+{
+	uint64_t until;
+
+	poll->iterations++;
+	if (mmio_poll_now(poll) >= poll->deadline) {
+		poll->stats->timeouts++;
+		mmio_poll_record(poll);
+		return -ETIMEDOUT;
+	}
+
+	if (poll->iterations <= MMIO_POLL_SPIN_COUNT)
+		return 0;
+
+	if (poll->cnt_freq != 0) {
+		until = delay_deadline_ns(poll->backoff_ns);
+		if (until > poll->deadline)
+			until = poll->deadline;
+		delay_wait_until(until);
+	} else {
+		until = poll->now + ((poll->backoff_ns + 999) / 1000) * 1000;
+		if (until > poll->deadline)
+			until = poll->deadline;
+		udelay((uint32_t)((until - poll->now + 999) / 1000));
+		poll->now = until;
+	}
+
+	if (poll->backoff_ns < MMIO_POLL_MAX_BACKOFF_NS)
+		poll->backoff_ns <<= 1;
+	return 0;
+}
+
+/* Called once the condition of the poll is met */
+void mmio_poll_done(mmio_poll_t *poll)
+{
+	poll->iterations++;
+	mmio_poll_record(poll);
+}
+
+/*
+ * Wait until any bit of 'mask' is set in the 32-bit register at 'addr'.
+ * Returns 0 on success or -ETIMEDOUT. The last value read from the register is
+ * returned in 'val' if it isn't NULL.
+ */
+int mmio_poll_set_32(mmio_poll_stats_t *stats, uintptr_t addr, uint32_t mask,
+		     uint32_t timeout_us, uint32_t *val)
+{
+	mmio_poll_t poll;
+	uint32_t data;
+	int ret = 0;
+
+	mmio_poll_start(&poll, stats, timeout_us);
+	while (((data = mmio_read_32(addr)) & mask) == 0) {
+		ret = mmio_poll_wait(&poll);
+		if (ret != 0)
+			break;
+	}
+	if (ret == 0)
+		mmio_poll_done(&poll);
+
+	if (val != NULL)
+		*val = data;
+	return ret;
+}
+
+/*
+ * Wait until all the bits of 'mask' are clear in the 32-bit register at
+ * 'addr'. Returns 0 on success or -ETIMEDOUT. The last value read from the
+ * register is returned in 'val' if it isn't NULL.
+ */
+int mmio_poll_clr_32(mmio_poll_stats_t *stats, uintptr_t addr, uint32_t mask,
+		     uint32_t timeout_us, uint32_t *val)
+{
+	mmio_poll_t poll;
+	uint32_t data;
+	int ret = 0;
+
+	mmio_poll_start(&poll, stats, timeout_us);
+	while (((data = mmio_read_32(addr)) & mask) != 0) {
+		ret = mmio_poll_wait(&poll);
+		if (ret != 0)
+			break;
+	}
+	if (ret == 0)
+		mmio_poll_done(&poll);
+
+	if (val != NULL)
+		*val = data;
+	return ret;
+}
+
+/* Print the statistics of the call sites which have polled */
+void mmio_poll_dump_stats(void)
+{
+	mmio_poll_stats_t *stats;
+
+	for (stats = mmio_poll_sites; stats != NULL; stats = stats->next) {
+		INFO("poll %s: %u calls, %u timeouts, %llu iterations, "
+		     "%llu us total, %llu us max\n",
+		     stats->name, stats->calls, stats->timeouts,
+		     (unsigned long long)stats->iterations,
+		     (unsigned long long)stats->total_us,
+		     (unsigned long long)stats->max_us);
+	}
+}
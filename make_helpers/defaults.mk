@@ -47,12 +47,28 @@ CTX_INCLUDE_FPREGS		:= 0
 # Debug build
 DEBUG				:= 0
 
+# Measure the fixed cost of ndelay() and check the delay timer against the
+# system counter when the timer is initialised
+DELAY_TIMER_CALIBRATE		:= 0
+
 # Build platform
 DEFAULT_PLAT			:= fvp
 
+# Flag to enable the EL3 inter-processor calls in BL31
+EL3_IPI				:= 0
+
+# Flag to enable the EL3 timer service in BL31
+EL3_TIMER			:= 0
+
+# Flag to enable the boot profile log
+ENABLE_BOOT_PROFILE		:= 0
+
 # Flag to enable Performance Measurement Framework
 ENABLE_PMF			:= 0
 
+# Flag to enable the PMU instrumentation of EL3 code paths
+ENABLE_PMU_INSTRUMENTATION	:= 0
+
 # Flag to enable PSCI STATs functionality
 ENABLE_PSCI_STAT		:= 0
 
@@ -81,6 +97,14 @@ GENERATE_COT			:= 0
 # default, they are for Secure EL1.
 GICV2_G0_FOR_EL3		:= 0
 
+# Cache the Redistributor base, SGI target and routing value of each CPU in its
+# cpu_data when the GICv3 driver is initialised.
+GICV3_PCPU_CACHE		:= 0
+
+# Only save the GICv3 Distributor registers which can have changed since the
+# last save or restore, and skip restoring empty set-register words.
+GICV3_SPARSE_SAVE_RESTORE	:= 0
+
 # Whether system coherency is managed in hardware, without explicit software
 # operations.
 HW_ASSISTED_COHERENCY		:= 0
@@ -105,6 +129,22 @@ PROGRAMMABLE_RESET_ADDRESS	:= 0
 # Original format.
 PSCI_EXTENDED_STATE_ID		:= 0
 
+# Flag to demote the states of non-CPU power domains whose predicted residency
+# is below their break-even residency. Requires ENABLE_PSCI_STAT.
+PSCI_IDLE_GOVERNOR		:= 0
+
+# Flag to give each PSCI power domain node, lock and group of requested states
+# a cache line of its own.
+PSCI_CACHE_ALIGNED_PD_DATA	:= 0
+
+# Flag to coordinate power domain states from per-domain counts of the states
+# requested by their CPUs instead of querying the platform.
+PSCI_INCREMENTAL_COORDINATION	:= 0
+
+# Flag to only clean the data of the image by VA when powering down a CPU, and
+# leave the cleaning of the caches to the platform.
+PSCI_RANGE_CACHE_MAINTENANCE	:= 0
+
 # By default, BL1 acts as the reset handler, not BL31
 RESET_TO_BL31			:= 0
 
@@ -140,6 +180,10 @@ V				:= 0
 # platforms).
 WARMBOOT_ENABLE_DCACHE_EARLY	:= 0
 
+# Whether to restore the per-CPU GIC configuration computed on the first boot
+# of each CPU, instead of computing it again on every warm boot.
+WARMBOOT_FAST_RESUME		:= 0
+
 # By default, enable Statistical Profiling Extensions.
 # The top level Makefile will disable this feature depending on
 # the target architecture and version number.
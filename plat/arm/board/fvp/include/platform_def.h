@@ -145,4 +145,10 @@
 
 #define PLAT_ARM_G0_IRQ_PROPS(grp)	ARM_G0_IRQ_PROPS(grp)
 
+/* SGI signalling the EL3 inter-processor calls, one of the Group 0 SGIs */
+#define PLAT_EL3_IPI_SGI		ARM_IRQ_SEC_SGI_6
+
+/* Interrupt of the EL3 timers, a Group 0 interrupt with EL3_TIMER */
+#define PLAT_EL3_TIMER_IRQ		ARM_IRQ_SEC_PHY_TIMER
+
 #endif /* __PLATFORM_DEF_H__ */
@@ -72,6 +72,22 @@ else
 $(error "Incorrect GIC driver chosen on FVP port")
 endif
 
+# The EL3 inter-processor calls and timers need Group 0 interrupts to be taken
+# to EL3
+ifneq (${EL3_IPI}${EL3_TIMER},00)
+  ifeq (${FVP_USE_GIC_DRIVER}, FVP_GICV3_LEGACY)
+    $(error "EL3_IPI and EL3_TIMER are not supported with the GICv3 legacy driver")
+  endif
+  ifeq (${FVP_USE_GIC_DRIVER}-${GICV2_G0_FOR_EL3}, FVP_GICV2-0)
+    $(error "EL3_IPI and EL3_TIMER need GICV2_G0_FOR_EL3=1 with the GICv2 driver")
+  endif
+endif
+
+# The TSP uses the secure physical timer, which EL3_TIMER takes over
+ifeq (${EL3_TIMER}-${SPD},1-tspd)
+  $(error "EL3_TIMER is not supported with the TSP on FVP")
+endif
+
 ifeq (${FVP_INTERCONNECT_DRIVER}, FVP_CCI)
 FVP_INTERCONNECT_SOURCES	:= 	drivers/arm/cci/cci.c
 else ifeq (${FVP_INTERCONNECT_DRIVER}, FVP_CCN)
@@ -54,6 +54,13 @@
 					HIKEY_BL1_MMC_DATA_SIZE,	\
 					MT_DEVICE | MT_RW | MT_SECURE)
 
+#if ENABLE_BOOT_PROFILE
+/* Kept from BL1 to BL31, inside the memory given to BL1 and BL2 */
+#define MAP_BOOT_PROFILE	MAP_REGION_FLAT(PLAT_BOOT_PROFILE_BASE,	\
+					PLAT_BOOT_PROFILE_SIZE,		\
+					MT_MEMORY | MT_RW | MT_SECURE)
+#endif
+
 /*
  * Table of regions for different BL stages to map using the MMU.
  * This doesn't include Trusted RAM as the 'mem_layout' argument passed to
@@ -64,6 +71,9 @@ static const mmap_region_t hikey_mmap[] = {
 	MAP_DEVICE,
 	MAP_ROM_PARAM,
 	MAP_MMC_SRAM,
+#if ENABLE_BOOT_PROFILE
+	MAP_BOOT_PROFILE,
+#endif
 	{0}
 };
 #endif
@@ -77,6 +87,9 @@ static const mmap_region_t hikey_mmap[] = {
 #ifdef SPD_opteed
 	MAP_OPTEE_PAGEABLE,
 #endif
+#endif
+#if ENABLE_BOOT_PROFILE
+	MAP_BOOT_PROFILE,
 #endif
 	{0}
 };
@@ -87,6 +100,9 @@ static const mmap_region_t hikey_mmap[] = {
 	MAP_DEVICE,
 	MAP_SRAM,
 	MAP_TSP_MEM,
+#if ENABLE_BOOT_PROFILE
+	MAP_BOOT_PROFILE,
+#endif
 	{0}
 };
 #endif
@@ -154,6 +154,12 @@ static void hikey_sp804_init(void)
 	} while ((data & PCLK_TIMER1) || (data & PCLK_TIMER0));
 
 	sp804_timer_init(SP804_TIMER0_BASE, 10, 192);
+	delay_counter_init(plat_get_syscnt_freq2());
+
+#if DELAY_TIMER_CALIBRATE
+	/* Check the SP804 clock against the system counter */
+	delay_timer_calibrate();
+#endif
 }
 
 static void hikey_gpio_init(void)
@@ -521,7 +527,7 @@ void bl1_platform_setup(void)
 	memset(&params, 0, sizeof(dw_mmc_params_t));
 	params.reg_base = DWMMC0_BASE;
 	params.desc_base = HIKEY_BL1_MMC_DESC_BASE;
-	params.desc_size = 1 << 20;
+	params.desc_size = HIKEY_BL1_MMC_DESC_SIZE;
 	params.clk_rate = 24 * 1000 * 1000;
 	params.bus_width = EMMC_BUS_WIDTH_8;
 	params.flags = EMMC_FLAG_CMD23;
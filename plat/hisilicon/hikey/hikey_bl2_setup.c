@@ -7,6 +7,7 @@
 #include <arch_helpers.h>
 #include <assert.h>
 #include <bl_common.h>
+#include <boot_profile.h>
 #include <console.h>
 #include <debug.h>
 #include <desc_image_load.h>
@@ -20,6 +21,7 @@
 #if LOAD_IMAGE_V2
 #ifdef SPD_opteed
 #include <optee_utils.h>
+#include <platform.h>
 #endif
 #endif
 #include <platform_def.h>
@@ -456,8 +458,11 @@ void bl2_early_platform_setup(meminfo_t *mem_layout)
 	memset((void *)SRAM_BASE, 0, SRAM_SIZE);
 
 	sp804_timer_init(SP804_TIMER0_BASE, 10, 192);
+	delay_counter_init(plat_get_syscnt_freq2());
 	dsb();
+	BOOT_PROFILE_BEGIN("hikey_ddr_init", 0);
 	hikey_ddr_init();
+	BOOT_PROFILE_END("hikey_ddr_init", 0);
 
 	hikey_boardid_init();
 	init_acpu_dvfs();
@@ -468,7 +473,7 @@ void bl2_early_platform_setup(meminfo_t *mem_layout)
 	memset(&params, 0, sizeof(dw_mmc_params_t));
 	params.reg_base = DWMMC0_BASE;
 	params.desc_base = HIKEY_MMC_DESC_BASE;
-	params.desc_size = 1 << 20;
+	params.desc_size = HIKEY_MMC_DESC_SIZE;
 	params.clk_rate = 24 * 1000 * 1000;
 	params.bus_width = EMMC_BUS_WIDTH_8;
 	params.flags = EMMC_FLAG_CMD23;
@@ -248,7 +248,7 @@ int hikey_validate_power_state(unsigned int power_state,
 	return PSCI_E_SUCCESS;
 }
 
-static int hikey_validate_ns_entrypoint(uintptr_t entrypoint)
+int hikey_validate_ns_entrypoint(uintptr_t entrypoint)
 {
 	/*
 	 * Check if the non secure entrypoint lies within the non
@@ -51,4 +51,6 @@ int hikey_write_serialno(struct random_serial_num *serialno);
 
 void init_acpu_dvfs(void);
 
+int hikey_validate_ns_entrypoint(uintptr_t entrypoint);
+
 #endif /* __HIKEY_PRIVATE_H__ */
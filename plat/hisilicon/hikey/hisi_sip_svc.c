@@ -4,13 +4,18 @@
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
+#include <arch.h>
 #include <debug.h>
 #include <hisi_sip_svc.h>
+#include <platform_def.h>
 #include <pmf.h>
+#include <psci.h>
 #include <runtime_svc.h>
 #include <stdint.h>
 #include <uuid.h>
 
+#include "hikey_private.h"
+
 
 /* Hisi SiP Service UUID */
 DEFINE_SVC_UUID(hisi_sip_svc_uid,
@@ -24,6 +29,50 @@ static int hisi_sip_setup(void)
 	return 0;
 }
 
+/*
+ * Turn on the CPUs whose linear index is set in `cpu_mask`, all of them
+ * starting at `entrypoint`. The bitmap of the CPUs actually turned on is
+ * returned in `on_mask`. As for PSCI CPU_ON, `context_id` is passed as is to
+ * the targets and any value is valid.
+ */
+static int hisi_sip_cpu_on_mask(u_register_t cpu_mask, uintptr_t entrypoint,
+				u_register_t context_id, u_register_t *on_mask)
+{
+	u_register_t mpidr[PLATFORM_CORE_COUNT];
+	int results[PLATFORM_CORE_COUNT];
+	unsigned int i, num_cpus = 0;
+	int rc;
+
+	/* Validate all the arguments before using any of them */
+	*on_mask = 0;
+	if (cpu_mask == 0 || (cpu_mask >> PLATFORM_CORE_COUNT) != 0)
+		return PSCI_E_INVALID_PARAMS;
+	if (hikey_validate_ns_entrypoint(entrypoint) != PSCI_E_SUCCESS)
+		return PSCI_E_INVALID_ADDRESS;
+
+	for (i = 0; i < PLATFORM_CORE_COUNT; i++) {
+		if (!(cpu_mask & (1UL << i)))
+			continue;
+		mpidr[num_cpus++] =
+			((i / PLATFORM_CORE_COUNT_PER_CLUSTER) << MPIDR_AFF1_SHIFT) |
+			((i % PLATFORM_CORE_COUNT_PER_CLUSTER) << MPIDR_AFF0_SHIFT);
+	}
+
+	rc = psci_cpu_on_multi(mpidr, num_cpus, entrypoint, context_id,
+			       results);
+	if (rc == PSCI_E_INVALID_PARAMS || rc == PSCI_E_INVALID_ADDRESS)
+		return rc;
+
+	for (i = 0, num_cpus = 0; i < PLATFORM_CORE_COUNT; i++) {
+		if (!(cpu_mask & (1UL << i)))
+			continue;
+		if (results[num_cpus++] == PSCI_E_SUCCESS)
+			*on_mask |= 1UL << i;
+	}
+
+	return rc;
+}
+
 /*
  * This function handles Hisi defined SiP Calls
  */
@@ -37,6 +86,8 @@ static uintptr_t hisi_sip_handler(unsigned int smc_fid,
 			u_register_t flags)
 {
 	int call_count = 0;
+	u_register_t on_mask;
+	int rc;
 
 	/*
 	 * Dispatch PMF calls to PMF SMC handler and return its return
@@ -55,6 +106,9 @@ static uintptr_t hisi_sip_handler(unsigned int smc_fid,
 		/* State switch call */
 		call_count += 1;
 
+		/* CPU on mask call */
+		call_count += 1;
+
 		SMC_RET1(handle, call_count);
 
 	case HISI_SIP_SVC_UID:
@@ -65,6 +119,13 @@ static uintptr_t hisi_sip_handler(unsigned int smc_fid,
 		/* Return the version of current implementation */
 		SMC_RET2(handle, HISI_SIP_SVC_VERSION_MAJOR, HISI_SIP_SVC_VERSION_MINOR);
 
+	case HISI_SIP_CPU_ON_MASK:
+		/* Only the Normal world may turn CPUs on, as with PSCI */
+		if (is_caller_secure(flags))
+			SMC_RET1(handle, SMC_UNK);
+		rc = hisi_sip_cpu_on_mask(x1, x2, x3, &on_mask);
+		SMC_RET2(handle, rc, on_mask);
+
 	default:
 		WARN("Unimplemented HISI SiP Service Call: 0x%x \n", smc_fid);
 		SMC_RET1(handle, SMC_UNK);
@@ -14,8 +14,15 @@
 /*					0x8200ff02 is reserved */
 #define HISI_SIP_SVC_VERSION			0x8200ff03
 
+/*
+ * Turn on several CPUs at once: x1 holds a bitmap of the linear indices of the
+ * CPUs, x2 the entry point and x3 the context id. Returns the PSCI error code
+ * in x0 and the bitmap of the CPUs turned on in x1.
+ */
+#define HISI_SIP_CPU_ON_MASK			0xc2000020
+
 /* HISI SiP Service Calls version numbers */
 #define HISI_SIP_SVC_VERSION_MAJOR		0x0
-#define HISI_SIP_SVC_VERSION_MINOR		0x1
+#define HISI_SIP_SVC_VERSION_MINOR		0x2
 
 #endif /* __ARM_SIP_SVC_H__ */
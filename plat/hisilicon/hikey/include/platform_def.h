@@ -98,7 +98,19 @@
  * BL31 specific defines.
  */
 #define BL31_BASE			BL2_LIMIT /* 0xf985_8000 */
+#if ENABLE_BOOT_PROFILE
+#define BL31_LIMIT			PLAT_BOOT_PROFILE_BASE
+#else
 #define BL31_LIMIT			0xF9898000
+#endif
+
+/*
+ * The boot profile log takes the last page below 0xf989_8000, out of the
+ * memory of BL31. This is in XG2RAM0 like BL1, BL2 and BL31 themselves, and
+ * isn't used by BL1 or BL2 while they run.
+ */
+#define PLAT_BOOT_PROFILE_SIZE		0x1000
+#define PLAT_BOOT_PROFILE_BASE		(0xF9898000 - PLAT_BOOT_PROFILE_SIZE)
 
 /*
  * BL3-2 specific defines.
@@ -107,8 +119,8 @@
 /*
  * The TSP currently executes from TZC secured area of DRAM or SRAM.
  */
-#define BL32_SRAM_BASE			BL31_LIMIT
-#define BL32_SRAM_LIMIT			(BL31_LIMIT+0x80000) /* 512K */
+#define BL32_SRAM_BASE			0xF9898000
+#define BL32_SRAM_LIMIT			(BL32_SRAM_BASE+0x80000) /* 512K */
 
 #define BL32_DRAM_BASE			DDR_SEC_BASE
 #define BL32_DRAM_LIMIT			(DDR_SEC_BASE+DDR_SEC_SIZE)
@@ -41,6 +41,13 @@
 					TSP_SEC_MEM_SIZE,		\
 					MT_MEMORY | MT_RW | MT_SECURE)
 
+#if ENABLE_BOOT_PROFILE
+/* Kept from BL1 to BL31, inside the memory given to BL1 and BL2 */
+#define MAP_BOOT_PROFILE	MAP_REGION_FLAT(PLAT_BOOT_PROFILE_BASE,	\
+					PLAT_BOOT_PROFILE_SIZE,		\
+					MT_MEMORY | MT_RW | MT_SECURE)
+#endif
+
 #if LOAD_IMAGE_V2
 #ifdef SPD_opteed
 #define MAP_OPTEE_PAGEABLE	MAP_REGION_FLAT(		\
@@ -61,6 +68,9 @@ static const mmap_region_t hikey960_mmap[] = {
 	MAP_BL1_RW,
 	MAP_UFS_DESC,
 	MAP_DEVICE,
+#if ENABLE_BOOT_PROFILE
+	MAP_BOOT_PROFILE,
+#endif
 	{0}
 };
 #endif
@@ -74,6 +84,9 @@ static const mmap_region_t hikey960_mmap[] = {
 #ifdef SPD_opteed
 	MAP_OPTEE_PAGEABLE,
 #endif
+#endif
+#if ENABLE_BOOT_PROFILE
+	MAP_BOOT_PROFILE,
 #endif
 	{0}
 };
@@ -83,6 +96,9 @@ static const mmap_region_t hikey960_mmap[] = {
 static const mmap_region_t hikey960_mmap[] = {
 	MAP_DEVICE,
 	MAP_TSP_MEM,
+#if ENABLE_BOOT_PROFILE
+	MAP_BOOT_PROFILE,
+#endif
 	{0}
 };
 #endif
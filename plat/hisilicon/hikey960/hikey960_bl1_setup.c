@@ -593,7 +593,10 @@ static void hikey960_ufs_init(void)
 
 	if ((ufs_params.flags & UFS_FLAGS_SKIPINIT) == 0)
 		hikey960_ufs_reset();
-	dw_ufs_init(&ufs_params);
+	if (dw_ufs_init(&ufs_params) != 0) {
+		ERROR("failed to init UFS\n");
+		panic();
+	}
 }
 
 static void hikey960_tzc_init(void)
@@ -183,7 +183,10 @@ void hikey960_init_ufs(void)
 	ufs_params.desc_base = HIKEY960_UFS_DESC_BASE;
 	ufs_params.desc_size = HIKEY960_UFS_DESC_SIZE;
 	ufs_params.flags = UFS_FLAGS_SKIPINIT;
-	ufs_init(NULL, &ufs_params);
+	if (ufs_init(NULL, &ufs_params) != 0) {
+		ERROR("failed to init UFS\n");
+		panic();
+	}
 }
 
 /*******************************************************************************
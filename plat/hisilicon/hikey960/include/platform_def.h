@@ -63,7 +63,20 @@
  * BL31 specific defines.
  */
 #define BL31_BASE			(BL2_LIMIT)		/* 1AC5_8000 */
+#if ENABLE_BOOT_PROFILE
+#define BL31_LIMIT			PLAT_BOOT_PROFILE_BASE
+#else
 #define BL31_LIMIT			(BL31_BASE + 0x40000)	/* 1AC9_8000 */
+#endif
+
+/*
+ * The boot profile log takes the last page below 1AC9_8000, out of the
+ * memory of BL31. It is covered by the memory of BL1 and BL2, which don't
+ * use it while they run.
+ */
+#define PLAT_BOOT_PROFILE_SIZE		0x1000
+#define PLAT_BOOT_PROFILE_BASE		(BL31_BASE + 0x40000 -		\
+					 PLAT_BOOT_PROFILE_SIZE)	/* 1AC9_7000 */
 
 /*
  * BL3-2 specific defines.
@@ -101,7 +114,7 @@
 #endif /* SPD_none */
 #endif
 
-#define NS_BL1U_BASE			(BL31_LIMIT)		/* 1AC9_8000 */
+#define NS_BL1U_BASE			(BL31_BASE + 0x40000)	/* 1AC9_8000 */
 #define NS_BL1U_SIZE			(0x00100000)
 #define NS_BL1U_LIMIT			(NS_BL1U_BASE + NS_BL1U_SIZE)
 
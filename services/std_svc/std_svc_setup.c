@@ -8,6 +8,7 @@
 #include <cpu_data.h>
 #include <debug.h>
 #include <pmf.h>
+#include <pmu_instr.h>
 #include <psci.h>
 #include <runtime_instr.h>
 #include <runtime_svc.h>
@@ -68,8 +69,10 @@ uintptr_t std_svc_smc_handler(uint32_t smc_fid,
 		    get_cpu_data(cpu_data_pmf_ts[CPU_DATA_PMF_TS0_IDX]));
 #endif
 
+		PMU_INSTR_BEGIN(PMU_INSTR_PSCI);
 		ret = psci_smc_handler(smc_fid, x1, x2, x3, x4,
 		    cookie, handle, flags);
+		PMU_INSTR_END(PMU_INSTR_PSCI);
 
 #if ENABLE_RUNTIME_INSTRUMENTATION
 		PMF_CAPTURE_TIMESTAMP(rt_instr_svc,
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <debug.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <test.h>
+#include <utils.h>
+
+/*
+ * Host versions of the firmware services used by the code under test. Log
+ * messages go to the standard error and a panic aborts the test.
+ */
+unsigned int test_failures;
+
+void tf_log(const char *fmt, ...)
+{
+	va_list args;
+
+	/* Skip the log level marker */
+	va_start(args, fmt);
+	vfprintf(stderr, fmt + 1, args);
+	va_end(args);
+}
+
+void tf_printf(const char *fmt, ...)
+{
+	va_list args;
+
+	va_start(args, fmt);
+	vfprintf(stderr, fmt, args);
+	va_end(args);
+}
+
+void do_panic(void)
+{
+	fprintf(stderr, "PANIC\n");
+	abort();
+}
+
+void zeromem(void *mem, u_register_t length)
+{
+	memset(mem, 0, length);
+}
+
+int test_exit(void)
+{
+	if (test_failures != 0) {
+		printf("FAIL: %s (%u failed checks)\n", TEST_NAME,
+		       test_failures);
+		return 1;
+	}
+	printf("PASS: %s\n", TEST_NAME);
+	return 0;
+}
@@ -0,0 +1,21 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __ARCH_HELPERS_H__
+#define __ARCH_HELPERS_H__
+
+#include <types.h>
+
+/* The simulated CPUs are host threads, ordered by full host barriers */
+static inline void dmbish(void)
+{
+	__sync_synchronize();
+}
+
+/* Points to the per-CPU data of the calling thread, provided by the test */
+u_register_t read_tpidr_el3(void);
+
+#endif /* __ARCH_HELPERS_H__ */
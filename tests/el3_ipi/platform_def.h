@@ -0,0 +1,23 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __PLATFORM_DEF_H__
+#define __PLATFORM_DEF_H__
+
+/*
+ * A cluster of 4 CPUs, each simulated by a host thread. The SGI number is the
+ * one used by the FVP port.
+ */
+#define PLATFORM_CORE_COUNT		4
+#define PLAT_NUM_PWR_DOMAINS		(PLATFORM_CORE_COUNT + 1)
+#define PLAT_MAX_PWR_LVL		1
+#define PLAT_MAX_RET_STATE		1
+#define PLAT_MAX_OFF_STATE		2
+#define CACHE_WRITEBACK_SHIFT		6
+#define CACHE_WRITEBACK_GRANULE		(1 << CACHE_WRITEBACK_SHIFT)
+#define PLAT_EL3_IPI_SGI		14
+
+#endif /* __PLATFORM_DEF_H__ */
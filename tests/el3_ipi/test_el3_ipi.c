@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <cpu_data.h>
+#include <el3_ipi.h>
+#include <errno.h>
+#include <interrupt_mgmt.h>
+#include <platform.h>
+#include <psci.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <test.h>
+
+/*
+ * Runs the EL3 inter-processor calls between host threads, each standing in
+ * for a CPU. A CPU takes the SGI it was sent whenever it isn't making a call
+ * itself, as interrupts are masked in EL3. Every CPU calls random sets of
+ * CPUs, some of them waiting for the calls to complete, so that CPUs call
+ * each other at the same time. The test checks that each function runs once
+ * on each of its targets, and that a waiting call only returns once all of
+ * them have run it.
+ */
+#define NR_CALLS		200
+
+/* Argument of the functions called */
+typedef struct test_call {
+	unsigned int nr_run;
+} test_call_t;
+
+static __thread unsigned int test_cpu;
+static cpu_data_t test_cpu_data[PLATFORM_CORE_COUNT];
+static interrupt_type_handler_t test_sgi_handler;
+static volatile int test_sgi_pending[PLATFORM_CORE_COUNT];
+
+/* Number of functions each CPU was asked to run, and has run */
+static unsigned int test_nr_posted[PLATFORM_CORE_COUNT];
+static unsigned int test_nr_run[PLATFORM_CORE_COUNT];
+static unsigned int test_nr_finished;
+
+u_register_t read_tpidr_el3(void)
+{
+	return (u_register_t)&test_cpu_data[test_cpu];
+}
+
+struct cpu_data *_cpu_data_by_index(uint32_t cpu_index)
+{
+	return &test_cpu_data[cpu_index];
+}
+
+unsigned int plat_my_core_pos(void)
+{
+	return test_cpu;
+}
+
+u_register_t psci_get_cpu_mpidr_by_index(unsigned int cpu_idx)
+{
+	return cpu_idx;
+}
+
+int32_t register_el3_interrupt_handler(uint32_t id,
+				       interrupt_type_handler_t handler,
+				       uint32_t flags)
+{
+	CHECK_EQ(id, PLAT_EL3_IPI_SGI);
+	test_sgi_handler = handler;
+	return 0;
+}
+
+void plat_ic_raise_el3_sgi(int sgi_num, u_register_t target)
+{
+	CHECK_EQ(sgi_num, PLAT_EL3_IPI_SGI);
+	__atomic_store_n(&test_sgi_pending[target], 1, __ATOMIC_SEQ_CST);
+}
+
+/* Take the SGI if it is pending, as when the CPU unmasks interrupts */
+static void take_sgi(void)
+{
+	if (__atomic_exchange_n(&test_sgi_pending[test_cpu], 0,
+				__ATOMIC_SEQ_CST))
+		test_sgi_handler(PLAT_EL3_IPI_SGI, 0, NULL, NULL);
+}
+
+static void test_nop(void *arg)
+{
+}
+
+static void test_func(void *arg)
+{
+	test_call_t *call = arg;
+
+	/* A called function can't make calls */
+	CHECK_EQ(el3_ipi_call(0, test_nop, NULL, 0), -EBUSY);
+
+	test_nr_run[test_cpu]++;
+	__atomic_fetch_add(&call->nr_run, 1, __ATOMIC_SEQ_CST);
+}
+
+static void *test_cpu_main(void *arg)
+{
+	/* A call without waiting may still be running the previous one */
+	test_call_t calls[2];
+	unsigned int i, idx, nr_targets, flags;
+	uint64_t mask;
+	unsigned int seed;
+
+	test_cpu = (uintptr_t)arg;
+	seed = test_cpu;
+
+	for (i = 0; i < NR_CALLS; i++) {
+		test_call_t *call = &calls[i % 2];
+
+		mask = rand_r(&seed) % (1U << PLATFORM_CORE_COUNT);
+		if (mask == 0)
+			mask = 1ULL << ((test_cpu + 1) % PLATFORM_CORE_COUNT);
+		flags = (rand_r(&seed) % 2) ? EL3_IPI_WAIT : 0;
+
+		nr_targets = 0;
+		for (idx = 0; idx < PLATFORM_CORE_COUNT; idx++) {
+			if (!(mask & (1ULL << idx)))
+				continue;
+			__atomic_fetch_add(&test_nr_posted[idx], 1,
+					   __ATOMIC_SEQ_CST);
+			nr_targets++;
+		}
+
+		call->nr_run = 0;
+		CHECK_EQ(el3_ipi_call_mask(mask, test_func, call, flags), 0);
+		if (flags & EL3_IPI_WAIT)
+			CHECK_EQ(__atomic_load_n(&call->nr_run,
+						 __ATOMIC_SEQ_CST), nr_targets);
+
+		take_sgi();
+		sched_yield();
+	}
+
+	/* Wait for the last call, then serve the others until they finish */
+	CHECK_EQ(el3_ipi_call(test_cpu, test_nop, NULL, EL3_IPI_WAIT), 0);
+	__atomic_fetch_add(&test_nr_finished, 1, __ATOMIC_SEQ_CST);
+	while (__atomic_load_n(&test_nr_finished, __ATOMIC_SEQ_CST) !=
+			PLATFORM_CORE_COUNT) {
+		take_sgi();
+		sched_yield();
+	}
+
+	return NULL;
+}
+
+int main(void)
+{
+	pthread_t threads[PLATFORM_CORE_COUNT];
+	test_call_t call = { 0 };
+	uintptr_t idx;
+
+	el3_ipi_init();
+	CHECK(test_sgi_handler != NULL);
+
+	for (idx = 0; idx < PLATFORM_CORE_COUNT; idx++)
+		test_cpu_data[idx].psci_svc_cpu_data.aff_info_state =
+			AFF_STATE_ON;
+
+	/* Invalid calls, from CPU 0 */
+	CHECK_EQ(el3_ipi_call_mask(0, test_func, &call, 0), -EINVAL);
+	CHECK_EQ(el3_ipi_call_mask(1ULL << PLATFORM_CORE_COUNT, test_func,
+				   &call, 0), -EINVAL);
+	CHECK_EQ(el3_ipi_call(PLATFORM_CORE_COUNT, test_func, &call, 0),
+		 -EINVAL);
+	CHECK_EQ(el3_ipi_call(1, NULL, &call, 0), -EINVAL);
+	CHECK_EQ(el3_ipi_call(1, test_func, &call, ~EL3_IPI_WAIT), -EINVAL);
+	test_cpu_data[1].psci_svc_cpu_data.aff_info_state = AFF_STATE_OFF;
+	CHECK_EQ(el3_ipi_call(1, test_func, &call, 0), -EINVAL);
+	test_cpu_data[1].psci_svc_cpu_data.aff_info_state = AFF_STATE_ON;
+	CHECK_EQ(call.nr_run, 0);
+
+	/* A call to the calling CPU alone runs the function directly */
+	CHECK_EQ(el3_ipi_call(0, test_func, &call, 0), 0);
+	CHECK_EQ(call.nr_run, 1);
+	test_nr_run[0] = 0;
+
+	for (idx = 0; idx < PLATFORM_CORE_COUNT; idx++) {
+		if (pthread_create(&threads[idx], NULL, test_cpu_main,
+				   (void *)idx) != 0) {
+			perror("pthread_create");
+			return 1;
+		}
+	}
+	for (idx = 0; idx < PLATFORM_CORE_COUNT; idx++)
+		pthread_join(threads[idx], NULL);
+
+	for (idx = 0; idx < PLATFORM_CORE_COUNT; idx++)
+		CHECK_EQ(test_nr_run[idx], test_nr_posted[idx]);
+
+	return test_exit();
+}
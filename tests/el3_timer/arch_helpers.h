@@ -0,0 +1,25 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __ARCH_HELPERS_H__
+#define __ARCH_HELPERS_H__
+
+#include <arch.h>
+#include <types.h>
+
+/*
+ * System counter and secure physical timer of the CPU, provided by the EL3
+ * timer test.
+ */
+u_register_t read_cntpct_el0(void);
+void write_cntps_ctl_el1(u_register_t v);
+void write_cntps_cval_el1(u_register_t v);
+
+static inline void isb(void)
+{
+}
+
+#endif /* __ARCH_HELPERS_H__ */
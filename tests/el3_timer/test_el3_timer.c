@@ -0,0 +1,287 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <test.h>
+
+/* The wheel helpers under test are static */
+#include "../../bl31/el3_timer.c"
+
+/*
+ * Tests of the EL3 timer wheel. The helpers placing timers in the slots,
+ * collecting the expired ones and finding the next deadline are checked on
+ * wheels built by hand. Then timers are started and cancelled at random on a
+ * simulated system counter, including from the expiry functions, and the
+ * secure physical timer interrupt is taken when the programmed deadline is
+ * reached. The test checks that no timer expires early or is missed, and that
+ * the secure physical timer is always programmed no later than the earliest
+ * pending deadline.
+ */
+#define SLOT_TICKS		(1ULL << PLAT_EL3_TIMER_SLOT_SHIFT)
+#define REVOLUTION		(PLAT_EL3_TIMER_WHEEL_SLOTS * SLOT_TICKS)
+#define NR_TIMERS		64
+#define NR_OPS			200000
+
+static uint64_t test_cntpct;
+static uint64_t test_cntps_cval;
+static u_register_t test_cntps_ctl;
+static interrupt_type_handler_t test_handler;
+
+/* Simulated timers, with the deadline they are expected to expire at */
+static el3_timer_t test_timers[NR_TIMERS];
+static uint64_t test_deadlines[NR_TIMERS];
+static int test_started_by_expiry[NR_TIMERS];
+static int test_in_handler;
+static unsigned int test_nr_expired;
+
+u_register_t read_cntpct_el0(void)
+{
+	return test_cntpct;
+}
+
+void write_cntps_ctl_el1(u_register_t v)
+{
+	test_cntps_ctl = v;
+}
+
+void write_cntps_cval_el1(u_register_t v)
+{
+	test_cntps_cval = v;
+}
+
+unsigned int plat_my_core_pos(void)
+{
+	return 0;
+}
+
+int32_t register_el3_interrupt_handler(uint32_t id,
+				       interrupt_type_handler_t handler,
+				       uint32_t flags)
+{
+	CHECK_EQ(id, PLAT_EL3_TIMER_IRQ);
+	test_handler = handler;
+	return 0;
+}
+
+static int list_has(const el3_timer_t *list, const el3_timer_t *timer)
+{
+	for (; list; list = list->next) {
+		if (list == timer)
+			return 1;
+	}
+	return 0;
+}
+
+static void test_nop(el3_timer_t *timer, void *arg)
+{
+}
+
+static void set_deadline(el3_timer_t *timer, uint64_t deadline)
+{
+	el3_timer_setup(timer, test_nop, NULL);
+	timer->deadline = deadline;
+}
+
+/* Placement, collection and next deadline on wheels built by hand */
+static void test_wheel(void)
+{
+	el3_timer_wheel_t wheel = { .tick = 100, .next = NO_DEADLINE };
+	el3_timer_t a, b, c, d, *expired = NULL;
+	uint64_t base = 100 * SLOT_TICKS;
+
+	/* 'a' is due in the current revolution, 'b' in the next one */
+	set_deadline(&a, base + 20 * SLOT_TICKS + 5);
+	set_deadline(&b, base + REVOLUTION + 3 * SLOT_TICKS);
+	el3_timer_insert(&wheel, &a);
+	el3_timer_insert(&wheel, &b);
+	CHECK_EQ(a.slot, (100 + 20) & SLOT_MASK);
+	CHECK_EQ(b.slot, (100 + 3) & SLOT_MASK);
+	CHECK_EQ(wheel.busy, (1ULL << a.slot) | (1ULL << b.slot));
+
+	/* 'b' comes first in the slots, but 'a' is earlier */
+	CHECK_EQ(el3_timer_next_deadline(&wheel), a.deadline);
+
+	/* A past deadline goes in the slot processed next */
+	set_deadline(&c, base - 2 * REVOLUTION);
+	el3_timer_insert(&wheel, &c);
+	CHECK_EQ(c.slot, 100 & SLOT_MASK);
+	CHECK_EQ(el3_timer_next_deadline(&wheel), c.deadline);
+
+	/* 'd' shares the slot of 'a', one revolution later */
+	set_deadline(&d, a.deadline + REVOLUTION);
+	el3_timer_insert(&wheel, &d);
+	CHECK_EQ(d.slot, a.slot);
+
+	/* Only 'c' has expired at the start of the tick */
+	el3_timer_collect(&wheel, base, &expired);
+	CHECK(list_has(expired, &c));
+	CHECK(!list_has(expired, &a) && !list_has(expired, &b));
+	CHECK_EQ(wheel.tick, 100);
+	CHECK(!(wheel.busy & (1ULL << c.slot)));
+	el3_timer_unlink(&c);
+	CHECK(expired == NULL);
+
+	/* 'a' expires at its deadline, but not 'd' in the same slot */
+	el3_timer_collect(&wheel, a.deadline, &expired);
+	CHECK(list_has(expired, &a) && !list_has(expired, &d));
+	CHECK(wheel.busy & (1ULL << a.slot));
+	el3_timer_unlink(&a);
+
+	/* Only timers in later revolutions are left: 'b' is the earliest */
+	CHECK_EQ(el3_timer_next_deadline(&wheel), b.deadline);
+
+	/* After several revolutions, every slot is visited once */
+	el3_timer_collect(&wheel, d.deadline + 3 * REVOLUTION, &expired);
+	CHECK(list_has(expired, &b) && list_has(expired, &d));
+	CHECK_EQ(wheel.busy, 0);
+	CHECK_EQ(el3_timer_next_deadline(&wheel), NO_DEADLINE);
+
+	/* Removing the last timer of a slot clears its bit */
+	el3_timer_unlink(&b);
+	el3_timer_unlink(&d);
+	el3_timer_insert(&wheel, &a);
+	el3_timer_insert(&wheel, &d);
+	el3_timer_remove(&wheel, &a);
+	CHECK(wheel.busy & (1ULL << d.slot));
+	el3_timer_remove(&wheel, &d);
+	CHECK_EQ(wheel.busy, 0);
+	CHECK(!el3_timer_is_pending(&a) && !el3_timer_is_pending(&d));
+}
+
+static void random_start(unsigned int idx)
+{
+	el3_timer_t *timer = &test_timers[idx];
+	uint64_t deadline, period = 0;
+
+	/* Deadlines from the past to several revolutions ahead */
+	deadline = test_cntpct + rand() % (4 * REVOLUTION);
+	if (rand() % 8 == 0)
+		deadline -= rand() % (2 * SLOT_TICKS);
+	if (rand() % 4 == 0)
+		period = 1 + rand() % (2 * REVOLUTION);
+
+	el3_timer_start(timer, deadline, period);
+	test_deadlines[idx] = deadline;
+	test_started_by_expiry[idx] = test_in_handler;
+}
+
+static void random_op(void)
+{
+	unsigned int idx = rand() % NR_TIMERS;
+
+	if (rand() % 3 == 0) {
+		el3_timer_cancel(&test_timers[idx]);
+	} else {
+		random_start(idx);
+	}
+}
+
+/* Expiry function, which may start or cancel timers */
+static void test_expire(el3_timer_t *timer, void *arg)
+{
+	unsigned int idx = timer - test_timers;
+
+	CHECK(test_deadlines[idx] <= test_cntpct);
+	test_nr_expired++;
+
+	if (timer->period) {
+		CHECK(el3_timer_is_pending(timer));
+		CHECK(timer->deadline > test_cntpct);
+		test_deadlines[idx] = timer->deadline;
+	} else {
+		CHECK(!el3_timer_is_pending(timer));
+	}
+
+	if (rand() % 4 == 0)
+		random_op();
+}
+
+/*
+ * The secure physical timer must fire no later than the earliest pending
+ * deadline. After an interrupt, only the timers started by the expiry
+ * functions may be due.
+ */
+static void check_pending(int after_interrupt)
+{
+	unsigned int idx;
+
+	for (idx = 0; idx < NR_TIMERS; idx++) {
+		if (!el3_timer_is_pending(&test_timers[idx]))
+			continue;
+
+		CHECK_EQ(test_timers[idx].deadline, test_deadlines[idx]);
+		if (after_interrupt && !test_started_by_expiry[idx])
+			CHECK(test_deadlines[idx] > test_cntpct);
+		CHECK(test_cntps_ctl & (1U << CNTP_CTL_ENABLE_SHIFT));
+		CHECK(test_cntps_cval <= test_deadlines[idx]);
+		if (test_failures != 0) {
+			fprintf(stderr, "Timer %u due at 0x%llx missed\n", idx,
+				(unsigned long long)test_deadlines[idx]);
+			exit(test_exit());
+		}
+	}
+}
+
+static void test_random(void)
+{
+	unsigned int i, idx, nr_interrupts = 0;
+	int interrupt;
+	uint64_t step;
+
+	for (idx = 0; idx < NR_TIMERS; idx++)
+		el3_timer_setup(&test_timers[idx], test_expire, NULL);
+
+	for (i = 0; i < NR_OPS; i++) {
+		/* Time passes, unless the timer interrupt is taken first */
+		step = rand() % (REVOLUTION / 16);
+		if (rand() % 64 == 0)
+			step += rand() % (4 * REVOLUTION);
+
+		interrupt = (test_cntps_ctl & (1U << CNTP_CTL_ENABLE_SHIFT)) &&
+			test_cntps_cval <= test_cntpct + step;
+		if (interrupt) {
+			/* The interrupt is sometimes taken late */
+			if (test_cntps_cval > test_cntpct)
+				test_cntpct = test_cntps_cval;
+			if (rand() % 64 == 0)
+				test_cntpct += rand() % (4 * REVOLUTION);
+			for (idx = 0; idx < NR_TIMERS; idx++)
+				test_started_by_expiry[idx] = 0;
+			test_in_handler = 1;
+			test_handler(PLAT_EL3_TIMER_IRQ, 0, NULL, NULL);
+			test_in_handler = 0;
+			nr_interrupts++;
+		} else {
+			test_cntpct += step;
+			random_op();
+		}
+
+		check_pending(interrupt);
+	}
+
+	/* A CPU losing its timer state gets it back on resume */
+	write_cntps_ctl_el1(0);
+	el3_timer_resume();
+	check_pending(0);
+
+	printf("%s: %u expiries in %u interrupts\n", TEST_NAME,
+	       test_nr_expired, nr_interrupts);
+}
+
+int main(void)
+{
+	el3_timer_init();
+	CHECK(test_handler != NULL);
+
+	/* Start far from 0 to cover deadlines in the past */
+	test_cntpct = 1000 * REVOLUTION;
+
+	test_wheel();
+	test_random();
+
+	return test_exit();
+}
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __ARCH_HELPERS_H__
+#define __ARCH_HELPERS_H__
+
+#include <types.h>
+
+/*
+ * System register and barrier helpers used by the GICv3 driver, provided by
+ * gic_host.c. The system registers are plain variables, and the driver runs
+ * at EL3 on the CPU with MPIDR 0.
+ */
+#define DECLARE_HOST_SYSREG(_name)					\
+	u_register_t read_ ## _name(void);				\
+	void write_ ## _name(u_register_t v)
+
+DECLARE_HOST_SYSREG(icc_igrpen0_el1);
+DECLARE_HOST_SYSREG(icc_igrpen1_el3);
+DECLARE_HOST_SYSREG(icc_pmr_el1);
+DECLARE_HOST_SYSREG(icc_sre_el1);
+DECLARE_HOST_SYSREG(icc_sre_el2);
+DECLARE_HOST_SYSREG(icc_sre_el3);
+DECLARE_HOST_SYSREG(scr_el3);
+
+u_register_t read_icc_hppir0_el1(void);
+u_register_t read_icc_hppir1_el1(void);
+u_register_t read_icc_rpr_el1(void);
+u_register_t read_id_aa64pfr0_el1(void);
+u_register_t read_mpidr_el1(void);
+void write_icc_sgi0r_el1(u_register_t v);
+void flush_dcache_range(uintptr_t addr, size_t size);
+
+#define read_mpidr()		read_mpidr_el1()
+#define IS_IN_EL3()		1
+
+static inline void isb(void)
+{
+}
+
+static inline void dsbishst(void)
+{
+}
+
+#endif /* __ARCH_HELPERS_H__ */
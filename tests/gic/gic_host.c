@@ -0,0 +1,263 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <arch.h>
+#include <arch_helpers.h>
+#include <cassert.h>
+#include <gicv3.h>
+#include <mmio.h>
+#include <spinlock.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gic_host.h"
+
+#define GICD_NR_REGS		(GIC_HOST_GICD_SIZE >> 2)
+#define GICR_FRAME_SIZE		(1 << GICR_PCPUBASE_SHIFT)
+
+CASSERT(GIC_HOST_GICR_SIZE == GIC_HOST_NUM_CPUS * GICR_FRAME_SIZE,
+	assert_gic_host_gicr_size);
+
+static uint32_t gicd_regs[GICD_NR_REGS] __aligned(8);
+static uint32_t gicr_regs[GIC_HOST_NUM_CPUS][GICR_FRAME_SIZE >> 2]
+	__aligned(8);
+
+/* Access counts of each Distributor register */
+static unsigned int gicd_nr_reads[GICD_NR_REGS];
+static unsigned int gicd_nr_writes[GICD_NR_REGS];
+
+uintptr_t gic_host_gicd_base = (uintptr_t)gicd_regs;
+uintptr_t gic_host_gicr_base = (uintptr_t)gicr_regs;
+
+void gic_host_reset(unsigned int num_ints)
+{
+	uint64_t typer;
+	unsigned int cpu;
+
+	memset(gicd_regs, 0, sizeof(gicd_regs));
+	memset(gicr_regs, 0, sizeof(gicr_regs));
+	gic_host_clear_counts();
+
+	gicd_regs[GICD_TYPER >> 2] = (num_ints >> 5) - 1;
+	gicd_regs[GICD_PIDR2_GICV3 >> 2] =
+		ARCH_REV_GICV3 << PIDR2_ARCH_REV_SHIFT;
+
+	/* CPU n has the MPIDR n and is the processor number n */
+	for (cpu = 0; cpu < GIC_HOST_NUM_CPUS; cpu++) {
+		typer = ((uint64_t)cpu << 32) |
+			((uint64_t)cpu << TYPER_PROC_NUM_SHIFT);
+		if (cpu == GIC_HOST_NUM_CPUS - 1)
+			typer |= TYPER_LAST_BIT;
+		memcpy(&gicr_regs[cpu][GICR_TYPER >> 2], &typer, sizeof(typer));
+	}
+}
+
+uint32_t *gic_host_gicd_reg(unsigned int offset)
+{
+	return &gicd_regs[offset >> 2];
+}
+
+static unsigned int sum_counts(const unsigned int *counts, unsigned int offset,
+			       unsigned int nr_regs)
+{
+	unsigned int i, sum = 0;
+
+	for (i = 0; i < nr_regs; i++)
+		sum += counts[(offset >> 2) + i];
+	return sum;
+}
+
+unsigned int gic_host_gicd_reads(unsigned int offset, unsigned int nr_regs)
+{
+	return sum_counts(gicd_nr_reads, offset, nr_regs);
+}
+
+unsigned int gic_host_gicd_writes(unsigned int offset, unsigned int nr_regs)
+{
+	return sum_counts(gicd_nr_writes, offset, nr_regs);
+}
+
+void gic_host_clear_counts(void)
+{
+	memset(gicd_nr_reads, 0, sizeof(gicd_nr_reads));
+	memset(gicd_nr_writes, 0, sizeof(gicd_nr_writes));
+}
+
+/*
+ * Return the memory backing an access of 'size' bytes at 'addr', counting it
+ * against the Distributor register holding its first byte.
+ */
+static void *reg_addr(uintptr_t addr, size_t size, int write)
+{
+	uintptr_t gicd_end = gic_host_gicd_base + sizeof(gicd_regs);
+	uintptr_t gicr_end = gic_host_gicr_base + sizeof(gicr_regs);
+	unsigned int reg;
+
+	if ((addr & (size - 1)) != 0)
+		goto bad;
+
+	if (addr >= gic_host_gicd_base && addr + size <= gicd_end) {
+		reg = (addr - gic_host_gicd_base) >> 2;
+		if (write)
+			gicd_nr_writes[reg]++;
+		else
+			gicd_nr_reads[reg]++;
+		return (void *)addr;
+	}
+
+	if (addr >= gic_host_gicr_base && addr + size <= gicr_end)
+		return (void *)addr;
+
+bad:
+	fprintf(stderr, "Bad GIC access of %zu bytes at 0x%lx\n", size,
+		(unsigned long)addr);
+	abort();
+}
+
+/*
+ * If 'addr' is one of the GICD_IS*R, GICD_IC*R, GICR_IS*R0 or GICR_IC*R0
+ * registers, return the address of the set register it acts on, and whether
+ * it clears bits.
+ */
+static uintptr_t set_clear_reg(uintptr_t addr, int *clear)
+{
+	uintptr_t offset;
+
+	if (addr >= gic_host_gicd_base &&
+	    addr < gic_host_gicd_base + sizeof(gicd_regs)) {
+		offset = addr - gic_host_gicd_base;
+	} else {
+		offset = (addr - gic_host_gicr_base) % GICR_FRAME_SIZE;
+		if (offset < GICR_SGIBASE_OFFSET)
+			return 0;
+		offset -= GICR_SGIBASE_OFFSET;
+	}
+
+	if (offset < GICD_ISENABLER || offset >= GICD_IPRIORITYR)
+		return 0;
+
+	*clear = (offset & 0x80) != 0;
+	return addr - (offset & 0x80);
+}
+
+void mmio_write_8(uintptr_t addr, uint8_t value)
+{
+	*(uint8_t *)reg_addr(addr, sizeof(value), 1) = value;
+}
+
+uint8_t mmio_read_8(uintptr_t addr)
+{
+	return *(uint8_t *)reg_addr(addr, sizeof(uint8_t), 0);
+}
+
+void mmio_write_32(uintptr_t addr, uint32_t value)
+{
+	uint32_t *reg = reg_addr(addr, sizeof(value), 1);
+	uintptr_t set_reg;
+	int clear;
+
+	set_reg = set_clear_reg(addr, &clear);
+	if (set_reg == 0)
+		*reg = value;
+	else if (clear)
+		*(uint32_t *)set_reg &= ~value;
+	else
+		*(uint32_t *)set_reg |= value;
+}
+
+uint32_t mmio_read_32(uintptr_t addr)
+{
+	uint32_t *reg = reg_addr(addr, sizeof(uint32_t), 0);
+	uintptr_t set_reg;
+	int clear;
+
+	/* Both registers of a pair read as the state */
+	set_reg = set_clear_reg(addr, &clear);
+	if (set_reg != 0)
+		return *(uint32_t *)set_reg;
+	return *reg;
+}
+
+void mmio_write_64(uintptr_t addr, uint64_t value)
+{
+	*(uint64_t *)reg_addr(addr, sizeof(value), 1) = value;
+}
+
+uint64_t mmio_read_64(uintptr_t addr)
+{
+	return *(uint64_t *)reg_addr(addr, sizeof(uint64_t), 0);
+}
+
+/* System registers, which only hold the values written to them */
+#define DEFINE_HOST_SYSREG(_name)					\
+	static u_register_t _name;					\
+	u_register_t read_ ## _name(void)				\
+	{								\
+		return _name;						\
+	}								\
+	void write_ ## _name(u_register_t v)				\
+	{								\
+		_name = v;						\
+	}
+
+DEFINE_HOST_SYSREG(icc_igrpen0_el1)
+DEFINE_HOST_SYSREG(icc_igrpen1_el3)
+DEFINE_HOST_SYSREG(icc_pmr_el1)
+DEFINE_HOST_SYSREG(icc_sre_el1)
+DEFINE_HOST_SYSREG(icc_sre_el2)
+DEFINE_HOST_SYSREG(icc_sre_el3)
+DEFINE_HOST_SYSREG(scr_el3)
+
+u_register_t read_icc_hppir0_el1(void)
+{
+	return GIC_SPURIOUS_INTERRUPT;
+}
+
+u_register_t read_icc_hppir1_el1(void)
+{
+	return GIC_SPURIOUS_INTERRUPT;
+}
+
+u_register_t read_icc_rpr_el1(void)
+{
+	return GIC_PRI_MASK;
+}
+
+u_register_t read_id_aa64pfr0_el1(void)
+{
+	return (u_register_t)1 << ID_AA64PFR0_GIC_SHIFT;
+}
+
+u_register_t read_mpidr_el1(void)
+{
+	return 0;
+}
+
+void write_icc_sgi0r_el1(u_register_t v)
+{
+}
+
+void flush_dcache_range(uintptr_t addr, size_t size)
+{
+}
+
+/* The tests run on a single thread */
+void spin_lock(spinlock_t *lock)
+{
+}
+
+void spin_unlock(spinlock_t *lock)
+{
+}
+
+/* Platform hooks of the Redistributor save and restore */
+void gicv3_distif_pre_save(unsigned int proc_num)
+{
+}
+
+void gicv3_distif_post_restore(unsigned int proc_num)
+{
+}
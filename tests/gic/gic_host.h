@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __GIC_HOST_H__
+#define __GIC_HOST_H__
+
+#include <stdint.h>
+
+/*
+ * Memory standing in for a GICv3 Distributor and the Redistributors of
+ * GIC_HOST_NUM_CPUS CPUs. The set and clear registers of the enable, pending
+ * and active states act on the bits of the set register. The other registers
+ * keep the values written to them, with none of their side effects, and read
+ * as zero until then.
+ */
+#define GIC_HOST_NUM_CPUS	2
+#define GIC_HOST_GICD_SIZE	0x10000
+#define GIC_HOST_GICR_SIZE	(GIC_HOST_NUM_CPUS * 0x20000)
+
+extern uintptr_t gic_host_gicd_base;
+extern uintptr_t gic_host_gicr_base;
+
+/* Reset the registers and the access counts, with 'num_ints' interrupts */
+void gic_host_reset(unsigned int num_ints);
+
+/* Distributor register at 'offset', for the test to set up or check */
+uint32_t *gic_host_gicd_reg(unsigned int offset);
+
+/*
+ * Number of accesses to the 'nr_regs' 32-bit Distributor registers from
+ * 'offset', since the counts were last cleared.
+ */
+unsigned int gic_host_gicd_reads(unsigned int offset, unsigned int nr_regs);
+unsigned int gic_host_gicd_writes(unsigned int offset, unsigned int nr_regs);
+void gic_host_clear_counts(void);
+
+#endif /* __GIC_HOST_H__ */
@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <arch_helpers.h>
+#include <gic_common.h>
+#include <gicv3.h>
+#include <interrupt_props.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <test.h>
+#include "../../drivers/arm/gic/v3/gicv3_private.h"
+#include "gic_host.h"
+
+/*
+ * Configures the secure interrupts of random property tables through
+ * gicv3_secure_spis_configure_props() and
+ * gicv3_secure_ppi_sgi_configure_props(), which build the value of each
+ * register word from the table, and through a reference made of the
+ * per-interrupt accessors. Both start from the same random register values,
+ * and must leave the same Distributor and Redistributor register images.
+ */
+#define NUM_INTS		992
+#define NR_TABLES		2000
+#define MAX_PROPS		48
+
+/* Number of blocks of 32 SPIs the SPIs of a table are spread over */
+#define MAX_SPI_BLOCKS		4
+
+void gicr_set_icfgr1(uintptr_t base, unsigned int id, unsigned int cfg);
+
+static uint8_t test_gicd_image[GIC_HOST_GICD_SIZE];
+static uint8_t test_gicr_image[GIC_HOST_GICR_SIZE];
+static uint8_t ref_gicd_image[GIC_HOST_GICD_SIZE];
+static uint8_t ref_gicr_image[GIC_HOST_GICR_SIZE];
+
+static unsigned int ref_spis_configure_props(uintptr_t gicd_base,
+		const interrupt_prop_t *interrupt_props,
+		unsigned int interrupt_props_num)
+{
+	const interrupt_prop_t *current_prop;
+	unsigned int i, ctlr_enable = 0;
+
+	for (i = 0; i < interrupt_props_num; i++) {
+		current_prop = &interrupt_props[i];
+		if (current_prop->intr_num < MIN_SPI_ID)
+			continue;
+
+		gicd_clr_igroupr(gicd_base, current_prop->intr_num);
+		if (current_prop->intr_grp == INTR_GROUP1S) {
+			gicd_set_igrpmodr(gicd_base, current_prop->intr_num);
+			ctlr_enable |= CTLR_ENABLE_G1S_BIT;
+		} else {
+			gicd_clr_igrpmodr(gicd_base, current_prop->intr_num);
+			ctlr_enable |= CTLR_ENABLE_G0_BIT;
+		}
+		gicd_set_icfgr(gicd_base, current_prop->intr_num,
+				current_prop->intr_cfg);
+		gicd_set_ipriorityr(gicd_base, current_prop->intr_num,
+				current_prop->intr_pri);
+		gicd_write_irouter(gicd_base, current_prop->intr_num,
+				gicd_irouter_val_from_mpidr(read_mpidr(), 0));
+		gicd_set_isenabler(gicd_base, current_prop->intr_num);
+	}
+
+	return ctlr_enable;
+}
+
+static void ref_ppi_sgi_configure_props(uintptr_t gicr_base,
+		const interrupt_prop_t *interrupt_props,
+		unsigned int interrupt_props_num)
+{
+	const interrupt_prop_t *current_prop;
+	unsigned int i;
+
+	for (i = 0; i < interrupt_props_num; i++) {
+		current_prop = &interrupt_props[i];
+		if (current_prop->intr_num >= MIN_SPI_ID)
+			continue;
+
+		gicr_clr_igroupr0(gicr_base, current_prop->intr_num);
+		if (current_prop->intr_grp == INTR_GROUP1S)
+			gicr_set_igrpmodr0(gicr_base, current_prop->intr_num);
+		else
+			gicr_clr_igrpmodr0(gicr_base, current_prop->intr_num);
+		gicr_set_ipriorityr(gicr_base, current_prop->intr_num,
+				current_prop->intr_pri);
+		if (current_prop->intr_num >= MIN_PPI_ID)
+			gicr_set_icfgr1(gicr_base, current_prop->intr_num,
+					current_prop->intr_cfg);
+		gicr_set_isenabler0(gicr_base, current_prop->intr_num);
+	}
+}
+
+/* Random table, which may configure an interrupt more than once */
+static unsigned int make_table(interrupt_prop_t *props)
+{
+	unsigned int blocks[MAX_SPI_BLOCKS];
+	unsigned int i, num = 1 + rand() % MAX_PROPS;
+
+	for (i = 0; i < MAX_SPI_BLOCKS; i++)
+		blocks[i] = 1 + rand() % ((NUM_INTS >> 5) - 1);
+
+	for (i = 0; i < num; i++) {
+		if (rand() % 4 == 0)
+			props[i].intr_num = rand() % MIN_SPI_ID;
+		else
+			props[i].intr_num = (blocks[rand() % MAX_SPI_BLOCKS] << 5)
+					  + rand() % 32;
+		props[i].intr_pri = rand() & GIC_PRI_MASK;
+		props[i].intr_grp = rand() % 2 ? INTR_GROUP0 : INTR_GROUP1S;
+		props[i].intr_cfg = rand() % 2 ? GIC_INTR_CFG_EDGE :
+						 GIC_INTR_CFG_LEVEL;
+	}
+
+	return num;
+}
+
+/* Random values in all the registers, but the IDs */
+static void randomise_regs(void)
+{
+	uint32_t *reg;
+	unsigned int i;
+
+	gic_host_reset(NUM_INTS);
+	reg = (uint32_t *)gic_host_gicd_base;
+	for (i = GICD_IGROUPR >> 2; i < GICD_PIDR2_GICV3 >> 2; i++)
+		reg[i] = rand() ^ (rand() << 16);
+
+	/* Registers of the SGI frame of the first CPU */
+	reg = (uint32_t *)gic_host_gicr_base;
+	for (i = GICR_IGROUPR0 >> 2; i <= GICR_IGRPMODR0 >> 2; i++)
+		reg[i] = rand() ^ (rand() << 16);
+}
+
+int main(void)
+{
+	interrupt_prop_t props[MAX_PROPS];
+	unsigned int t, num, enable, ref_enable;
+	unsigned long test_accesses = 0, ref_accesses = 0;
+	unsigned int seed = 1;
+
+	for (t = 0; t < NR_TABLES; t++) {
+		num = make_table(props);
+
+		srand(seed + t);
+		randomise_regs();
+		ref_enable = ref_spis_configure_props(gic_host_gicd_base,
+				props, num);
+		ref_ppi_sgi_configure_props(gic_host_gicr_base, props, num);
+		ref_accesses += gic_host_gicd_reads(0, GIC_HOST_GICD_SIZE >> 2)
+			+ gic_host_gicd_writes(0, GIC_HOST_GICD_SIZE >> 2);
+		memcpy(ref_gicd_image, (void *)gic_host_gicd_base,
+		       sizeof(ref_gicd_image));
+		memcpy(ref_gicr_image, (void *)gic_host_gicr_base,
+		       sizeof(ref_gicr_image));
+
+		srand(seed + t);
+		randomise_regs();
+		enable = gicv3_secure_spis_configure_props(gic_host_gicd_base,
+				props, num);
+		gicv3_secure_ppi_sgi_configure_props(gic_host_gicr_base,
+				props, num);
+		test_accesses += gic_host_gicd_reads(0, GIC_HOST_GICD_SIZE >> 2)
+			+ gic_host_gicd_writes(0, GIC_HOST_GICD_SIZE >> 2);
+		memcpy(test_gicd_image, (void *)gic_host_gicd_base,
+		       sizeof(test_gicd_image));
+		memcpy(test_gicr_image, (void *)gic_host_gicr_base,
+		       sizeof(test_gicr_image));
+
+		CHECK_EQ(enable, ref_enable);
+		CHECK(memcmp(test_gicd_image, ref_gicd_image,
+			     sizeof(ref_gicd_image)) == 0);
+		CHECK(memcmp(test_gicr_image, ref_gicr_image,
+			     sizeof(ref_gicr_image)) == 0);
+		if (test_failures != 0) {
+			fprintf(stderr, "Table %u differs\n", t);
+			break;
+		}
+	}
+
+	printf("%s: GICD accesses per table: %lu by block, %lu by interrupt\n",
+	       TEST_NAME, test_accesses / NR_TABLES, ref_accesses / NR_TABLES);
+
+	return test_exit();
+}
@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <gic_common.h>
+#include <gicv3.h>
+#include <interrupt_props.h>
+#include <stdio.h>
+#include <string.h>
+#include <test.h>
+#include "gic_host.h"
+
+/*
+ * Saves and restores the Distributor context through the GICv3 driver, and
+ * counts the register accesses made. The contexts saved are checked against
+ * the registers, and the registers restored against the contexts. With
+ * GICV3_SPARSE_SAVE_RESTORE, only the blocks of 32 SPIs reconfigured since
+ * the last save or restore of the same context must be read back from
+ * GICD_IGROUPR, GICD_IGRPMODR and GICD_NSACR, and the zero words of the
+ * GICD_IS* registers must not be written back.
+ */
+#define NUM_INTS		992
+#define RECONFIGURED_SPI	300
+
+/* First register of a class holding the configuration of SPIs, and count */
+#define SPI_REG(REG)		(GICD_##REG + ((MIN_SPI_ID >> REG##_SHIFT) << 2))
+#define NR_SPI_REGS(REG)	((NUM_INTS - MIN_SPI_ID) >> REG##_SHIFT)
+#define SPI_READS(REG)		gic_host_gicd_reads(SPI_REG(REG), NR_SPI_REGS(REG))
+#define SPI_WRITES(REG)		gic_host_gicd_writes(SPI_REG(REG), NR_SPI_REGS(REG))
+
+/* Reads of the Secure-only classes */
+#define SECURE_READS()							\
+	(SPI_READS(IGROUPR) + SPI_READS(IGRPMODR) + SPI_READS(NSACR))
+#define ALL_SECURE_READS						\
+	(NR_SPI_REGS(IGROUPR) + NR_SPI_REGS(IGRPMODR) + NR_SPI_REGS(NSACR))
+
+#define CHECK_SPI_REGS(ctx, reg, REG)					\
+	do {								\
+		unsigned int _i;					\
+									\
+		for (_i = 0; _i < NR_SPI_REGS(REG); _i++)		\
+			CHECK_EQ((ctx)->gicd_##reg[_i],			\
+				 *gic_host_gicd_reg(SPI_REG(REG) + (_i << 2))); \
+	} while (0)
+
+static const interrupt_prop_t test_props[] = {
+	INTR_PROP_DESC(40, GIC_HIGHEST_SEC_PRIORITY, INTR_GROUP0,
+		       GIC_INTR_CFG_LEVEL),
+	INTR_PROP_DESC(100, GIC_HIGHEST_SEC_PRIORITY, INTR_GROUP1S,
+		       GIC_INTR_CFG_EDGE),
+	INTR_PROP_DESC(500, GIC_HIGHEST_SEC_PRIORITY, INTR_GROUP1S,
+		       GIC_INTR_CFG_LEVEL),
+};
+
+static uintptr_t test_rdistif_base_addrs[GIC_HOST_NUM_CPUS];
+
+static gicv3_driver_data_t test_driver_data = {
+	.interrupt_props = test_props,
+	.interrupt_props_num = ARRAY_SIZE(test_props),
+	.rdistif_num = GIC_HOST_NUM_CPUS,
+	.rdistif_base_addrs = test_rdistif_base_addrs,
+};
+
+static gicv3_dist_ctx_t test_ctx_a, test_ctx_b;
+
+static void check_saved(const gicv3_dist_ctx_t *ctx)
+{
+	CHECK_EQ(ctx->gicd_ctlr, *gic_host_gicd_reg(GICD_CTLR));
+	CHECK_SPI_REGS(ctx, igroupr, IGROUPR);
+	CHECK_SPI_REGS(ctx, isenabler, ISENABLER);
+	CHECK_SPI_REGS(ctx, ipriorityr, IPRIORITYR);
+	CHECK_SPI_REGS(ctx, icfgr, ICFGR);
+	CHECK_SPI_REGS(ctx, igrpmodr, IGRPMODR);
+	CHECK_SPI_REGS(ctx, nsacr, NSACR);
+}
+
+/* Save to 'ctx', and check the number of Secure-only registers read */
+static void save(gicv3_dist_ctx_t *ctx, unsigned int sparse_reads)
+{
+	gic_host_clear_counts();
+	gicv3_distif_save(ctx);
+	check_saved(ctx);
+#if GICV3_SPARSE_SAVE_RESTORE
+	CHECK_EQ(SECURE_READS(), sparse_reads);
+#else
+	CHECK_EQ(SECURE_READS(), ALL_SECURE_READS);
+#endif
+	CHECK_EQ(SPI_READS(ISENABLER), NR_SPI_REGS(ISENABLER));
+}
+
+int main(void)
+{
+	unsigned int i, nr_enabled = 0, save_reads, restore_writes;
+
+	test_driver_data.gicd_base = gic_host_gicd_base;
+	test_driver_data.gicr_base = gic_host_gicr_base;
+	gic_host_reset(NUM_INTS);
+
+	gicv3_driver_init(&test_driver_data);
+	gicv3_distif_init();
+
+	/* The Normal world enables an SPI of its own */
+	*gic_host_gicd_reg(SPI_REG(ISENABLER) + 4) |= 1U << 8;
+
+	/* All the blocks are read after the initialisation */
+	save(&test_ctx_a, ALL_SECURE_READS);
+
+	/* None are read if nothing changed since the last save */
+	save(&test_ctx_a, 0);
+	save_reads = gic_host_gicd_reads(0, GIC_HOST_GICD_SIZE >> 2);
+
+	/*
+	 * A reconfigured SPI causes the registers of its block to be read: one
+	 * GICD_IGROUPR, one GICD_IGRPMODR and two GICD_NSACR.
+	 */
+	gicv3_set_interrupt_type(RECONFIGURED_SPI, 0, INTR_GROUP0);
+	CHECK_EQ(gicv3_get_interrupt_type(RECONFIGURED_SPI, 0), INTR_GROUP0);
+	save(&test_ctx_a, 4);
+
+	/* A context other than the last one saved has to be read entirely */
+	save(&test_ctx_b, ALL_SECURE_READS);
+	save(&test_ctx_a, ALL_SECURE_READS);
+
+	/* The Distributor loses its context and gets it back */
+	for (i = 0; i < NR_SPI_REGS(ISENABLER); i++)
+		nr_enabled += test_ctx_a.gicd_isenabler[i] != 0U;
+	gic_host_reset(NUM_INTS);
+	gicv3_distif_init_restore(&test_ctx_a);
+	restore_writes = gic_host_gicd_writes(0, GIC_HOST_GICD_SIZE >> 2);
+	check_saved(&test_ctx_a);
+
+#if GICV3_SPARSE_SAVE_RESTORE
+	CHECK_EQ(SPI_WRITES(ISENABLER), nr_enabled);
+	CHECK_EQ(SPI_WRITES(ISPENDR), 0);
+	CHECK_EQ(SPI_WRITES(ISACTIVER), 0);
+#else
+	CHECK_EQ(SPI_WRITES(ISENABLER), NR_SPI_REGS(ISENABLER));
+	CHECK_EQ(SPI_WRITES(ISPENDR), NR_SPI_REGS(ISPENDR));
+	CHECK_EQ(SPI_WRITES(ISACTIVER), NR_SPI_REGS(ISACTIVER));
+#endif
+
+	/* The restored context is the one held by the registers */
+	save(&test_ctx_a, 0);
+
+	printf("%s: %u GICD reads per save, %u GICD writes per restore\n",
+	       TEST_NAME, save_reads, restore_writes);
+
+	return test_exit();
+}
@@ -0,0 +1,15 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __ARCH_HELPERS_H__
+#define __ARCH_HELPERS_H__
+
+/*
+ * The code under test is built without AARCH32 or AARCH64 defined, so it
+ * must not reach for system registers. This header only satisfies includes.
+ */
+
+#endif /* __ARCH_HELPERS_H__ */
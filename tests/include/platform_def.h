@@ -0,0 +1,23 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __PLATFORM_DEF_H__
+#define __PLATFORM_DEF_H__
+
+/*
+ * Platform definitions for the host tests. A test needing other values
+ * provides its own platform_def.h in its directory.
+ */
+#define PLATFORM_CORE_COUNT		8
+#define PLAT_NUM_PWR_DOMAINS		(PLATFORM_CORE_COUNT + 3)
+#define PLAT_MAX_PWR_LVL		2
+#define PLAT_MAX_RET_STATE		1
+#define PLAT_MAX_OFF_STATE		2
+#define CACHE_WRITEBACK_SHIFT		6
+#define CACHE_WRITEBACK_GRANULE		(1 << CACHE_WRITEBACK_SHIFT)
+#define PLAT_PARTITION_MAX_ENTRIES	128
+
+#endif /* __PLATFORM_DEF_H__ */
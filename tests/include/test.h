@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __TEST_H__
+#define __TEST_H__
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Number of failed checks, reported by test_exit() */
+extern unsigned int test_failures;
+
+/* Report a failed check without stopping the test */
+#define CHECK(cond)							\
+	do {								\
+		if (!(cond)) {						\
+			fprintf(stderr, "%s:%d: check failed: %s\n",	\
+				__FILE__, __LINE__, #cond);		\
+			test_failures++;				\
+		}							\
+	} while (0)
+
+#define CHECK_EQ(a, b)							\
+	do {								\
+		unsigned long long _a = (a), _b = (b);			\
+									\
+		if (_a != _b) {						\
+			fprintf(stderr, "%s:%d: check failed: %s == %s "\
+				"(0x%llx != 0x%llx)\n", __FILE__,	\
+				__LINE__, #a, #b, _a, _b);		\
+			test_failures++;				\
+		}							\
+	} while (0)
+
+/* Print the result of the test, named by TEST_NAME, and return its status */
+int test_exit(void);
+
+#endif /* __TEST_H__ */
@@ -0,0 +1,17 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __TYPES_H__
+#define __TYPES_H__
+
+/* Host version of the firmware's <types.h>, for an LP64 host */
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+typedef uint64_t u_register_t;
+
+#endif /* __TYPES_H__ */
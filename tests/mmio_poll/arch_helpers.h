@@ -0,0 +1,26 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __ARCH_HELPERS_H__
+#define __ARCH_HELPERS_H__
+
+#include <arch.h>
+#include <types.h>
+
+/*
+ * System counter and timer control of the CPU, provided by the polling test
+ * on a simulated clock.
+ */
+u_register_t read_cntpct_el0(void);
+u_register_t read_cntkctl_el1(void);
+void write_cntkctl_el1(u_register_t v);
+void wfe(void);
+
+static inline void isb(void)
+{
+}
+
+#endif /* __ARCH_HELPERS_H__ */
@@ -0,0 +1,15 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __MMIO_H__
+#define __MMIO_H__
+
+#include <stdint.h>
+
+/* MMIO read of the polling test, from a register set at a simulated time */
+uint32_t mmio_read_32(uintptr_t addr);
+
+#endif /* __MMIO_H__ */
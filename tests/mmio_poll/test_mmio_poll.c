@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <arch_helpers.h>
+#include <delay_timer.h>
+#include <errno.h>
+#include <mmio.h>
+#include <mmio_poll.h>
+#include <test.h>
+#include <unistd.h>
+
+/*
+ * Checks the timeouts of mmio_poll on a simulated clock, with the system
+ * counter running, stuck, or never set up. In the last two cases the polls
+ * must wait with udelay() on the delay timer instead of the counter.
+ */
+
+/* Frequency of the simulated system counter */
+#define CNT_FREQ		19200000ULL
+
+/* Simulated time taken by each counter, timer or register read */
+#define READ_NS			10
+
+/* Simulated time until the event stream wakes up a WFE */
+#define WFE_NS			500
+
+#define POLL_TIMEOUT_US		1000
+#define POLL_SET_US		50
+
+#define POLL_BIT		(1U << 3)
+
+static uint64_t now_ns;
+static int cnt_stuck;
+static uint64_t reg_set_ns;
+static u_register_t cntkctl;
+static unsigned int wfe_calls;
+
+MMIO_POLL_STATS(test_poll);
+
+u_register_t read_cntpct_el0(void)
+{
+	now_ns += READ_NS;
+	return cnt_stuck ? 0x1234 : (now_ns * CNT_FREQ) / 1000000000ULL;
+}
+
+u_register_t read_cntkctl_el1(void)
+{
+	return cntkctl;
+}
+
+void write_cntkctl_el1(u_register_t v)
+{
+	cntkctl = v;
+}
+
+void wfe(void)
+{
+	now_ns += WFE_NS;
+	wfe_calls++;
+}
+
+uint32_t mmio_read_32(uintptr_t addr)
+{
+	now_ns += READ_NS;
+	return (now_ns >= reg_set_ns) ? POLL_BIT : 0;
+}
+
+/* 1 MHz down counter standing in for the SP804 */
+static uint32_t get_timer_value(void)
+{
+	now_ns += READ_NS;
+	return (uint32_t)~(now_ns / 1000);
+}
+
+static const timer_ops_t test_timer_ops = {
+	.get_timer_value	= get_timer_value,
+	.clk_mult		= 1,
+	.clk_div		= 1,
+};
+
+/*
+ * Poll a bit which is set after POLL_SET_US, then one which is never set, and
+ * check how long each poll took on the simulated clock.
+ */
+static void test_polls(void)
+{
+	uint64_t start;
+	uint32_t val;
+
+	now_ns = 0;
+	reg_set_ns = POLL_SET_US * 1000;
+	CHECK_EQ(mmio_poll_set_32(&test_poll, 0, POLL_BIT, POLL_TIMEOUT_US,
+				  &val), 0);
+	CHECK_EQ(val, POLL_BIT);
+	/* Noticed at most one maximum backoff period late */
+	CHECK(now_ns >= reg_set_ns);
+	CHECK(now_ns <= reg_set_ns + 70000);
+
+	start = now_ns;
+	reg_set_ns = ~0ULL;
+	CHECK_EQ(mmio_poll_set_32(&test_poll, 0, POLL_BIT, POLL_TIMEOUT_US,
+				  &val), -ETIMEDOUT);
+	CHECK_EQ(val, 0);
+	CHECK(now_ns - start >= POLL_TIMEOUT_US * 1000);
+	CHECK(now_ns - start <= POLL_TIMEOUT_US * 1100);
+}
+
+int main(void)
+{
+	/* A wait on a counter which doesn't progress would never end */
+	alarm(10);
+
+	timer_init(&test_timer_ops);
+
+	/* The counter hasn't been set up */
+	CHECK_EQ(delay_counter_freq(), 0);
+	test_polls();
+	CHECK_EQ(wfe_calls, 0);
+
+	/* The counter doesn't progress */
+	cnt_stuck = 1;
+	delay_counter_init(CNT_FREQ);
+	CHECK_EQ(delay_counter_freq(), 0);
+	CHECK_EQ(delay_timer_calibrate(), -ENODEV);
+	test_polls();
+	CHECK_EQ(wfe_calls, 0);
+
+	/* The counter runs, so the polls wait on it */
+	cnt_stuck = 0;
+	delay_counter_init(CNT_FREQ);
+	CHECK_EQ(delay_counter_freq(), CNT_FREQ);
+	test_polls();
+	CHECK(wfe_calls != 0);
+	CHECK_EQ(cntkctl, 0);
+
+	CHECK_EQ(test_poll.calls, 6);
+	CHECK_EQ(test_poll.timeouts, 3);
+	CHECK(test_poll.max_us >= POLL_TIMEOUT_US);
+
+	return test_exit();
+}
@@ -0,0 +1,261 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <gpt.h>
+#include <io_storage.h>
+#include <mbr.h>
+#include <partition.h>
+#include <platform.h>
+#include <stdio.h>
+#include <string.h>
+#include <test.h>
+
+/*
+ * Host test of the GPT loader. It builds disk images in memory, with the
+ * CRCs computed by a plain bitwise CRC32 independent of the one under test,
+ * and serves them to load_partition_table() through the IO functions below.
+ */
+#define DISK_BLOCKS		64
+#define ENTRY_LBA		2
+#define MAX_ENTRIES		128
+
+static uint8_t disk[DISK_BLOCKS * PARTITION_BLOCK_SIZE];
+static size_t disk_pos;
+static unsigned int nr_reads, nr_opens, nr_closes;
+
+int plat_get_image_source(unsigned int image_id, uintptr_t *dev_handle,
+			  uintptr_t *image_spec)
+{
+	*dev_handle = 1;
+	*image_spec = image_id;
+	return 0;
+}
+
+int io_open(uintptr_t dev_handle, const uintptr_t spec, uintptr_t *handle)
+{
+	nr_opens++;
+	*handle = 2;
+	return 0;
+}
+
+int io_seek(uintptr_t handle, io_seek_mode_t mode, ssize_t offset)
+{
+	if ((mode != IO_SEEK_SET) || (offset < 0) ||
+	    ((size_t)offset > sizeof(disk))) {
+		return -EINVAL;
+	}
+	disk_pos = offset;
+	return 0;
+}
+
+int io_read(uintptr_t handle, uintptr_t buffer, size_t length,
+	    size_t *length_read)
+{
+	if (length > sizeof(disk) - disk_pos) {
+		length = sizeof(disk) - disk_pos;
+	}
+	memcpy((void *)buffer, disk + disk_pos, length);
+	disk_pos += length;
+	*length_read = length;
+	nr_reads++;
+	return 0;
+}
+
+int io_close(uintptr_t handle)
+{
+	nr_closes++;
+	return 0;
+}
+
+static uint32_t ref_crc32(const void *buf, size_t size)
+{
+	const uint8_t *p = buf;
+	uint32_t crc = ~0U;
+	int bit;
+
+	while (size-- != 0) {
+		crc ^= *p++;
+		for (bit = 0; bit < 8; bit++) {
+			crc = (crc >> 1) ^ (0xedb88320U & -(crc & 1));
+		}
+	}
+	return ~crc;
+}
+
+static gpt_entry_t *disk_entry(unsigned int i)
+{
+	return (gpt_entry_t *)(disk + ENTRY_LBA * PARTITION_BLOCK_SIZE) + i;
+}
+
+static gpt_header_t *disk_header(void)
+{
+	return (gpt_header_t *)(disk + GPT_HEADER_OFFSET);
+}
+
+static void set_entry_name(gpt_entry_t *entry, const char *name)
+{
+	unsigned int i;
+
+	memset(entry->name, 0, sizeof(entry->name));
+	for (i = 0; name[i] != '\0'; i++) {
+		entry->name[i] = (unsigned char)name[i];
+	}
+}
+
+/* Recompute the CRCs of the entry array and of the header */
+static void seal_disk(void)
+{
+	gpt_header_t *header = disk_header();
+
+	header->part_crc = ref_crc32(disk_entry(0),
+				     header->list_num * sizeof(gpt_entry_t));
+	header->header_crc = 0;
+	header->header_crc = ref_crc32(header, header->size);
+}
+
+/*
+ * Build a disk with a protective MBR and a GPT of list_num entries, the first
+ * nr_used of them named "partNNN".
+ */
+static void make_disk(unsigned int list_num, unsigned int nr_used)
+{
+	gpt_header_t *header = disk_header();
+	mbr_entry_t *mbr_entry;
+	gpt_entry_t *entry;
+	char name[EFI_NAMELEN];
+	unsigned int i;
+
+	memset(disk, 0, sizeof(disk));
+	mbr_entry = (mbr_entry_t *)(disk + MBR_PRIMARY_ENTRY_OFFSET);
+	mbr_entry->type = PARTITION_TYPE_GPT;
+	mbr_entry->first_lba = 1;
+	mbr_entry->sector_nums = DISK_BLOCKS - 1;
+	disk[PARTITION_BLOCK_SIZE - 2] = MBR_SIGNATURE_FIRST;
+	disk[PARTITION_BLOCK_SIZE - 1] = MBR_SIGNATURE_SECOND;
+
+	memcpy(header->signature, GPT_SIGNATURE, sizeof(header->signature));
+	header->revision = 0x10000;
+	header->size = 92;
+	header->current_lba = 1;
+	header->part_lba = ENTRY_LBA;
+	header->list_num = list_num;
+	header->part_size = sizeof(gpt_entry_t);
+
+	for (i = 0; i < nr_used; i++) {
+		entry = disk_entry(i);
+		entry->first_lba = 0x1000 + i * 0x100;
+		entry->last_lba = entry->first_lba + 0xff;
+		snprintf(name, sizeof(name), "part%03u", i);
+		set_entry_name(entry, name);
+	}
+	seal_disk();
+}
+
+static int load(void)
+{
+	nr_reads = 0;
+	return load_partition_table(0);
+}
+
+/* Check that every one of the nr_used entries is found */
+static void check_lookups(unsigned int nr_used)
+{
+	const partition_entry_t *entry;
+	char name[EFI_NAMELEN];
+	unsigned int i;
+
+	CHECK_EQ(get_partition_entry_list()->entry_count, nr_used);
+	for (i = 0; i < nr_used; i++) {
+		snprintf(name, sizeof(name), "part%03u", i);
+		entry = get_partition_entry(name);
+		CHECK(entry != NULL);
+		if (entry != NULL) {
+			CHECK(strcmp(entry->name, name) == 0);
+			CHECK_EQ(entry->start,
+				 (0x1000 + i * 0x100) * PARTITION_BLOCK_SIZE);
+			CHECK_EQ(entry->length, 0x100 * PARTITION_BLOCK_SIZE);
+		}
+	}
+	CHECK(get_partition_entry("missing") == NULL);
+	CHECK(get_partition_entry("") == NULL);
+	CHECK(get_partition_entry("part") == NULL);
+}
+
+static void test_full_table(void)
+{
+	make_disk(MAX_ENTRIES, MAX_ENTRIES);
+	CHECK_EQ(load(), 0);
+	/* MBR, GPT header and 16KB of entries in four 4KB chunks */
+	CHECK_EQ(nr_reads, 2 + 4);
+	check_lookups(MAX_ENTRIES);
+}
+
+static void test_sparse_table(void)
+{
+	make_disk(MAX_ENTRIES, 20);
+	CHECK_EQ(load(), 0);
+	CHECK_EQ(nr_reads, 2 + 4);
+	check_lookups(20);
+}
+
+/* The last chunk of the entry array is shorter than the buffer */
+static void test_partial_chunk(void)
+{
+	make_disk(100, 100);
+	CHECK_EQ(load(), 0);
+	CHECK_EQ(nr_reads, 2 + 4);
+	check_lookups(100);
+}
+
+static void test_duplicate_names(void)
+{
+	const partition_entry_t *entry;
+
+	make_disk(MAX_ENTRIES, 40);
+	set_entry_name(disk_entry(30), "part010");
+	seal_disk();
+	CHECK_EQ(load(), 0);
+	entry = get_partition_entry("part010");
+	CHECK(entry == &get_partition_entry_list()->list[10]);
+	CHECK(get_partition_entry("part030") == NULL);
+}
+
+static void test_corruption(void)
+{
+	/* A bad header CRC also clears the previously loaded table */
+	make_disk(MAX_ENTRIES, MAX_ENTRIES);
+	CHECK_EQ(load(), 0);
+	disk_header()->header_crc ^= 1;
+	CHECK(load() != 0);
+	CHECK_EQ(get_partition_entry_list()->entry_count, 0);
+	CHECK(get_partition_entry("part000") == NULL);
+
+	/* A flipped bit in the last chunk of the entry array */
+	make_disk(MAX_ENTRIES, MAX_ENTRIES);
+	disk_entry(MAX_ENTRIES - 1)->attr ^= 1ULL << 63;
+	CHECK(load() != 0);
+	CHECK_EQ(get_partition_entry_list()->entry_count, 0);
+
+	make_disk(MAX_ENTRIES, MAX_ENTRIES);
+	disk[PARTITION_BLOCK_SIZE - 1] = 0;
+	CHECK(load() != 0);
+
+	make_disk(MAX_ENTRIES, MAX_ENTRIES);
+	disk_header()->part_size = 256;
+	seal_disk();
+	CHECK(load() != 0);
+}
+
+int main(void)
+{
+	test_full_table();
+	test_sparse_table();
+	test_partial_chunk();
+	test_duplicate_names();
+	test_corruption();
+	CHECK_EQ(nr_opens, nr_closes);
+	return test_exit();
+}
@@ -0,0 +1,23 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __ARCH_HELPERS_H__
+#define __ARCH_HELPERS_H__
+
+#include <types.h>
+
+/*
+ * System register and cache maintenance helpers used by the PSCI library,
+ * provided by the PSCI test. TPIDR_EL3 points to the per-CPU data of the
+ * simulated CPU that currently runs.
+ */
+u_register_t read_tpidr_el3(void);
+u_register_t read_scr_el3(void);
+u_register_t read_sctlr_el1(void);
+u_register_t read_sctlr_el2(void);
+void flush_dcache_range(uintptr_t addr, size_t size);
+
+#endif /* __ARCH_HELPERS_H__ */
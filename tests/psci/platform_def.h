@@ -0,0 +1,28 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __PLATFORM_DEF_H__
+#define __PLATFORM_DEF_H__
+
+/*
+ * A system power domain with clusters of 16 CPUs. The number of CPUs is
+ * given by the build of each variant of the test.
+ */
+#ifndef PLATFORM_CORE_COUNT
+#define PLATFORM_CORE_COUNT		64
+#endif
+#define PLATFORM_CLUSTER_CORE_COUNT	16
+#define PLATFORM_CLUSTER_COUNT		(PLATFORM_CORE_COUNT /		\
+					 PLATFORM_CLUSTER_CORE_COUNT)
+#define PLAT_NUM_PWR_DOMAINS		(PLATFORM_CORE_COUNT +		\
+					 PLATFORM_CLUSTER_COUNT + 1)
+#define PLAT_MAX_PWR_LVL		2
+#define PLAT_MAX_RET_STATE		1
+#define PLAT_MAX_OFF_STATE		2
+#define CACHE_WRITEBACK_SHIFT		6
+#define CACHE_WRITEBACK_GRANULE		(1 << CACHE_WRITEBACK_SHIFT)
+
+#endif /* __PLATFORM_DEF_H__ */
@@ -0,0 +1,285 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <arch_helpers.h>
+#include <bakery_lock.h>
+#include <cpu_data.h>
+#include <debug.h>
+#include <platform.h>
+#include <psci.h>
+#include <stdio.h>
+#include <test.h>
+#include <time.h>
+#include "../../lib/psci/psci_private.h"
+
+/*
+ * Host simulation of the PSCI state coordination. CPUs of the power domain
+ * tree described by platform_def.h suspend and wake up in a random order.
+ * The states coordinated by psci_do_state_coordination() after each suspend
+ * are checked against the shallowest states requested by the CPUs of each
+ * domain, tracked here independently. The time taken by a CPU to wake up
+ * and suspend again while all the others are off, when every level is
+ * coordinated, is reported.
+ */
+#define SYSTEM_NODE		0
+#define NR_OPS			200000
+#define NR_IDLE_CYCLES		1000000
+
+static unsigned int test_cpu;
+static cpu_data_t test_cpu_data[PLATFORM_CORE_COUNT];
+
+/* Requests of each CPU at the cluster and system levels, and CPUs running */
+static plat_local_state_t test_req[PLATFORM_CORE_COUNT][PLAT_MAX_PWR_LVL + 1];
+static int test_running[PLATFORM_CORE_COUNT];
+
+unsigned int psci_caps;
+
+u_register_t read_tpidr_el3(void)
+{
+	return (u_register_t)&test_cpu_data[test_cpu];
+}
+
+u_register_t read_scr_el3(void)
+{
+	return 0;
+}
+
+u_register_t read_sctlr_el1(void)
+{
+	return 0;
+}
+
+u_register_t read_sctlr_el2(void)
+{
+	return 0;
+}
+
+void flush_dcache_range(uintptr_t addr, size_t size)
+{
+}
+
+struct cpu_data *_cpu_data_by_index(uint32_t cpu_index)
+{
+	return &test_cpu_data[cpu_index];
+}
+
+unsigned int plat_my_core_pos(void)
+{
+	return test_cpu;
+}
+
+int plat_core_pos_by_mpidr(u_register_t mpidr)
+{
+	return (mpidr < PLATFORM_CORE_COUNT) ? (int)mpidr : -1;
+}
+
+/* The simulated CPUs run one at a time, as if under the domain locks */
+void bakery_lock_get(bakery_lock_t *bakery)
+{
+}
+
+void bakery_lock_release(bakery_lock_t *bakery)
+{
+}
+
+/* Not reached by the coordination */
+void psci_cpu_on_finish(unsigned int cpu_idx, psci_power_state_t *state_info)
+{
+	panic();
+}
+
+void psci_cpu_suspend_finish(unsigned int cpu_idx,
+			     psci_power_state_t *state_info)
+{
+	panic();
+}
+
+void psci_do_pwrdown_cache_maintenance(unsigned int pwr_level)
+{
+	panic();
+}
+
+static unsigned long long now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static unsigned int rand_state = 1;
+
+static unsigned int test_rand(void)
+{
+	rand_state ^= rand_state << 13;
+	rand_state ^= rand_state >> 17;
+	rand_state ^= rand_state << 5;
+	return rand_state;
+}
+
+static unsigned int cluster_node(unsigned int cpu)
+{
+	return 1 + cpu / PLATFORM_CLUSTER_CORE_COUNT;
+}
+
+/* Build the power domain tree the way psci_setup() would */
+static void setup_topology(void)
+{
+	non_cpu_pd_node_t *node;
+	unsigned int i;
+
+	node = &psci_non_cpu_pd_nodes[SYSTEM_NODE];
+	node->level = 2;
+	node->parent_node = PSCI_NUM_NON_CPU_PWR_DOMAINS;
+	node->cpu_start_idx = 0;
+	node->ncpus = PLATFORM_CORE_COUNT;
+	node->local_state = PLAT_MAX_OFF_STATE;
+	for (i = 0; i < PLATFORM_CLUSTER_COUNT; i++) {
+		node = &psci_non_cpu_pd_nodes[1 + i];
+		node->level = 1;
+		node->parent_node = SYSTEM_NODE;
+		node->cpu_start_idx = i * PLATFORM_CLUSTER_CORE_COUNT;
+		node->ncpus = PLATFORM_CLUSTER_CORE_COUNT;
+		node->local_state = PLAT_MAX_OFF_STATE;
+		node->lock_index = 1 + i;
+	}
+	for (i = 0; i < PLATFORM_CORE_COUNT; i++) {
+		psci_cpu_pd_nodes[i].mpidr = i;
+		psci_cpu_pd_nodes[i].parent_node = cluster_node(i);
+	}
+	psci_init_req_local_pwr_states();
+}
+
+static void wake_cpu(unsigned int cpu)
+{
+	unsigned int lvl;
+
+	test_cpu = cpu;
+	psci_set_pwr_domains_to_run(PLAT_MAX_PWR_LVL);
+	for (lvl = 1; lvl <= PLAT_MAX_PWR_LVL; lvl++)
+		test_req[cpu][lvl] = PSCI_LOCAL_STATE_RUN;
+	test_running[cpu] = 1;
+}
+
+/* Shallowest state requested at 'lvl' by the CPUs first..first+n-1 */
+static plat_local_state_t min_req(unsigned int first, unsigned int n,
+				  unsigned int lvl)
+{
+	plat_local_state_t state = PLAT_MAX_OFF_STATE;
+	unsigned int i;
+
+	for (i = first; i < first + n; i++) {
+		if (test_req[i][lvl] < state)
+			state = test_req[i][lvl];
+	}
+	return state;
+}
+
+static void suspend_cpu(unsigned int cpu, plat_local_state_t cluster_state,
+			plat_local_state_t system_state)
+{
+	psci_power_state_t info;
+	plat_local_state_t expected[PLAT_MAX_PWR_LVL + 1];
+	unsigned int first;
+
+	info.pwr_domain_state[0] = PLAT_MAX_OFF_STATE;
+	info.pwr_domain_state[1] = cluster_state;
+	info.pwr_domain_state[2] = system_state;
+
+	test_cpu = cpu;
+	psci_do_state_coordination(PLAT_MAX_PWR_LVL, &info, 0);
+
+	test_req[cpu][1] = cluster_state;
+	test_req[cpu][2] = system_state;
+	test_running[cpu] = 0;
+
+	first = cpu - cpu % PLATFORM_CLUSTER_CORE_COUNT;
+	expected[1] = min_req(first, PLATFORM_CLUSTER_CORE_COUNT, 1);
+	expected[2] = PSCI_LOCAL_STATE_RUN;
+	if (expected[1] != PSCI_LOCAL_STATE_RUN)
+		expected[2] = min_req(0, PLATFORM_CORE_COUNT, 2);
+	CHECK_EQ(info.pwr_domain_state[1], expected[1]);
+	CHECK_EQ(info.pwr_domain_state[2], expected[2]);
+	CHECK_EQ(psci_non_cpu_pd_nodes[cluster_node(cpu)].local_state,
+		 expected[1]);
+}
+
+/* Suspend and wake up random CPUs with random requests */
+static void test_random(void)
+{
+	plat_local_state_t cluster_state;
+	unsigned int i, cpu;
+
+	for (i = 0; i < NR_OPS; i++) {
+		cpu = test_rand() % PLATFORM_CORE_COUNT;
+		if (!test_running[cpu]) {
+			wake_cpu(cpu);
+			continue;
+		}
+		/* No level is shallower than the one above it */
+		cluster_state = test_rand() % (PLAT_MAX_OFF_STATE + 1);
+		suspend_cpu(cpu, cluster_state,
+			    test_rand() % (cluster_state + 1));
+	}
+}
+
+/* Only the last CPU of the system to suspend powers the system off */
+static void test_last_cpu(void)
+{
+	unsigned int cpu;
+
+	for (cpu = 0; cpu < PLATFORM_CORE_COUNT; cpu++) {
+		if (!test_running[cpu])
+			wake_cpu(cpu);
+	}
+	for (cpu = 0; cpu < PLATFORM_CORE_COUNT; cpu++)
+		suspend_cpu(cpu, PLAT_MAX_OFF_STATE, PLAT_MAX_OFF_STATE);
+	CHECK_EQ(psci_non_cpu_pd_nodes[SYSTEM_NODE].local_state,
+		 PLAT_MAX_OFF_STATE);
+}
+
+/*
+ * With all the CPUs off, wake up each CPU in turn and power it off again.
+ * The whole system is powered off after each cycle.
+ */
+static void time_idle_cycles(void)
+{
+	psci_power_state_t info;
+	unsigned long long start, ns;
+	unsigned int i, lvl, nr_wrong = 0;
+
+	start = now_ns();
+	for (i = 0; i < NR_IDLE_CYCLES; i++) {
+		test_cpu = i % PLATFORM_CORE_COUNT;
+		psci_set_pwr_domains_to_run(PLAT_MAX_PWR_LVL);
+		for (lvl = 0; lvl <= PLAT_MAX_PWR_LVL; lvl++)
+			info.pwr_domain_state[lvl] = PLAT_MAX_OFF_STATE;
+		psci_do_state_coordination(PLAT_MAX_PWR_LVL, &info, 0);
+		if (info.pwr_domain_state[PLAT_MAX_PWR_LVL] !=
+		    PLAT_MAX_OFF_STATE)
+			nr_wrong++;
+	}
+	ns = now_ns() - start;
+	CHECK_EQ(nr_wrong, 0);
+
+	printf("%s: %u CPUs, %s coordination: %llu ns per idle cycle\n",
+	       TEST_NAME, PLATFORM_CORE_COUNT,
+	       PSCI_INCREMENTAL_COORDINATION ? "incremental" : "scanning",
+	       ns / NR_IDLE_CYCLES);
+}
+
+int main(void)
+{
+	unsigned int cpu;
+
+	setup_topology();
+	for (cpu = 0; cpu < PLATFORM_CORE_COUNT; cpu++)
+		wake_cpu(cpu);
+	test_random();
+	test_last_cpu();
+	time_idle_cycles();
+	return test_exit();
+}
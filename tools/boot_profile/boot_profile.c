@@ -0,0 +1,329 @@
+/*
+ * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "boot_profile_log.h"
+
+#define MAX_DEPTH	64
+
+/* Offsets of the fields of the log, which is decoded byte by byte */
+#define LOG_MAGIC_OFF		0
+#define LOG_VERSION_OFF		4
+#define LOG_NUM_ENTRIES_OFF	8
+#define LOG_MAX_ENTRIES_OFF	12
+#define LOG_DROPPED_OFF		16
+#define LOG_CNT_FREQ_OFF	24
+#define LOG_HEADER_SIZE		32
+
+#define ENTRY_TIMESTAMP_OFF	0
+#define ENTRY_ARG_OFF		8
+#define ENTRY_STAGE_OFF		12
+#define ENTRY_TYPE_OFF		14
+#define ENTRY_NAME_OFF		16
+#define ENTRY_SIZE		(ENTRY_NAME_OFF + BOOT_PROFILE_NAME_LEN)
+
+typedef struct entry {
+	uint64_t timestamp;
+	uint32_t arg;
+	unsigned int stage;
+	unsigned int type;
+	char name[BOOT_PROFILE_NAME_LEN];
+} entry_t;
+
+typedef struct stage_span {
+	unsigned int stage;
+	uint64_t first;
+	uint64_t last;
+} stage_span_t;
+
+static uint64_t cnt_freq;
+
+static void log_err(const char *msg, ...)
+{
+	va_list ap;
+
+	va_start(ap, msg);
+	fprintf(stderr, "ERROR: ");
+	vfprintf(stderr, msg, ap);
+	fputc('\n', stderr);
+	va_end(ap);
+	exit(1);
+}
+
+static uint16_t get_le16(const unsigned char *p)
+{
+	return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_le32(const unsigned char *p)
+{
+	return (uint32_t)get_le16(p) | ((uint32_t)get_le16(p + 2) << 16);
+}
+
+static uint64_t get_le64(const unsigned char *p)
+{
+	return (uint64_t)get_le32(p) | ((uint64_t)get_le32(p + 4) << 32);
+}
+
+static double ticks_to_us(uint64_t ticks)
+{
+	return (double)ticks * 1000000.0 / (double)cnt_freq;
+}
+
+static const char *stage_name(unsigned int stage)
+{
+	static char buf[16];
+
+	switch (stage) {
+	case BOOT_PROFILE_STAGE_BL1:
+		return "BL1";
+	case BOOT_PROFILE_STAGE_BL2:
+		return "BL2";
+	case BOOT_PROFILE_STAGE_BL31:
+		return "BL31";
+	case BOOT_PROFILE_STAGE_BL32:
+		return "BL32";
+	default:
+		snprintf(buf, sizeof(buf), "?%u", stage);
+		return buf;
+	}
+}
+
+static unsigned char *read_file(const char *filename, long offset,
+				size_t *size)
+{
+	unsigned char *buf;
+	FILE *fp;
+	long len;
+
+	fp = fopen(filename, "rb");
+	if (fp == NULL)
+		log_err("fopen %s: %s", filename, strerror(errno));
+
+	if ((fseek(fp, 0, SEEK_END) != 0) || ((len = ftell(fp)) < 0))
+		log_err("ftell %s: %s", filename, strerror(errno));
+	if (len < offset + LOG_HEADER_SIZE)
+		log_err("%s is too small to hold a boot profile log", filename);
+	len -= offset;
+
+	buf = malloc(len);
+	if (buf == NULL)
+		log_err("malloc: %s", strerror(errno));
+
+	if ((fseek(fp, offset, SEEK_SET) != 0) ||
+	    (fread(buf, 1, len, fp) != (size_t)len))
+		log_err("Failed to read %s", filename);
+	fclose(fp);
+
+	*size = len;
+	return buf;
+}
+
+static void decode_entry(const unsigned char *p, entry_t *entry)
+{
+	entry->timestamp = get_le64(p + ENTRY_TIMESTAMP_OFF);
+	entry->arg = get_le32(p + ENTRY_ARG_OFF);
+	entry->stage = get_le16(p + ENTRY_STAGE_OFF);
+	entry->type = get_le16(p + ENTRY_TYPE_OFF);
+	memcpy(entry->name, p + ENTRY_NAME_OFF, BOOT_PROFILE_NAME_LEN);
+	entry->name[BOOT_PROFILE_NAME_LEN - 1] = '\0';
+}
+
+static void print_label(const entry_t *entry, const char *prefix)
+{
+	printf("%s%s", prefix, entry->name);
+	if (entry->arg != 0)
+		printf("(%u)", entry->arg);
+}
+
+/*
+ * Print the entries in order. The beginning of a span increases the
+ * indentation of the following entries, until the end of the span which shows
+ * its duration.
+ */
+static void print_timeline(const entry_t *entries, unsigned int num)
+{
+	const entry_t *open[MAX_DEPTH];
+	unsigned int depth = 0;
+	unsigned int i;
+	int j;
+
+	printf("%12s %12s  %-5s %s\n", "time (us)", "delta (us)", "stage",
+	       "event");
+
+	for (i = 0; i < num; i++) {
+		const entry_t *entry = &entries[i];
+		uint64_t prev = (i == 0) ? entry->timestamp :
+					   entries[i - 1].timestamp;
+		unsigned int indent = depth;
+
+		j = -1;
+		if (entry->type == BOOT_PROFILE_TYPE_END) {
+			/* Find the beginning of the span, innermost first */
+			for (j = (int)depth - 1; j >= 0; j--) {
+				if ((open[j]->stage == entry->stage) &&
+				    (open[j]->arg == entry->arg) &&
+				    (strcmp(open[j]->name, entry->name) == 0))
+					break;
+			}
+			if (j >= 0) {
+				depth = j;
+				indent = depth;
+			}
+		}
+
+		printf("%12.3f %12.3f  %-5s %*s",
+		       ticks_to_us(entry->timestamp - entries[0].timestamp),
+		       ticks_to_us(entry->timestamp - prev),
+		       stage_name(entry->stage), 2 * indent, "");
+
+		switch (entry->type) {
+		case BOOT_PROFILE_TYPE_BEGIN:
+			print_label(entry, "> ");
+			if (depth < MAX_DEPTH)
+				open[depth++] = entry;
+			break;
+		case BOOT_PROFILE_TYPE_END:
+			print_label(entry, "< ");
+			if (j >= 0)
+				printf(": %.3f us", ticks_to_us(
+				       entry->timestamp - open[j]->timestamp));
+			else
+				printf(": no beginning");
+			break;
+		case BOOT_PROFILE_TYPE_MARK:
+			print_label(entry, "");
+			break;
+		default:
+			print_label(entry, "? ");
+			break;
+		}
+		putchar('\n');
+	}
+
+	for (i = 0; i < depth; i++)
+		printf("WARNING: %s %s(%u) has no end\n",
+		       stage_name(open[i]->stage), open[i]->name,
+		       open[i]->arg);
+}
+
+/* Print the time spent in each stage, from its first to its last entry */
+static void print_stages(const entry_t *entries, unsigned int num)
+{
+	stage_span_t stages[8];
+	unsigned int num_stages = 0;
+	unsigned int i, s;
+
+	for (i = 0; i < num; i++) {
+		for (s = 0; s < num_stages; s++) {
+			if (stages[s].stage == entries[i].stage)
+				break;
+		}
+		if (s == num_stages) {
+			if (num_stages == sizeof(stages) / sizeof(stages[0]))
+				continue;
+			stages[s].stage = entries[i].stage;
+			stages[s].first = entries[i].timestamp;
+			num_stages++;
+		}
+		stages[s].last = entries[i].timestamp;
+	}
+
+	printf("\n%-5s %12s %12s\n", "stage", "start (us)", "time (us)");
+	for (s = 0; s < num_stages; s++)
+		printf("%-5s %12.3f %12.3f\n", stage_name(stages[s].stage),
+		       ticks_to_us(stages[s].first - entries[0].timestamp),
+		       ticks_to_us(stages[s].last - stages[s].first));
+	printf("%-5s %12s %12.3f\n", "total", "",
+	       ticks_to_us(entries[num - 1].timestamp - entries[0].timestamp));
+}
+
+static void usage(void)
+{
+	printf("boot_profile [-o offset] [-f freq] <log file>\n\n");
+	printf("Print the boot profile log in <log file>, which is a dump of "
+	       "the memory region\nholding the log.\n\n");
+	printf("  -o offset\tOffset of the log in the file.\n");
+	printf("  -f freq\tSystem counter frequency in Hz, overriding the "
+	       "one in the log.\n");
+	exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned int num_entries, max_entries, dropped, i;
+	unsigned char *buf;
+	entry_t *entries;
+	long offset = 0;
+	size_t size;
+	int opt;
+
+	cnt_freq = 0;
+	while ((opt = getopt(argc, argv, "o:f:h")) != -1) {
+		switch (opt) {
+		case 'o':
+			offset = strtol(optarg, NULL, 0);
+			if (offset < 0)
+				usage();
+			break;
+		case 'f':
+			cnt_freq = strtoull(optarg, NULL, 0);
+			break;
+		default:
+			usage();
+		}
+	}
+	if (optind + 1 != argc)
+		usage();
+
+	buf = read_file(argv[optind], offset, &size);
+
+	if (get_le32(buf + LOG_MAGIC_OFF) != BOOT_PROFILE_MAGIC)
+		log_err("No boot profile log found");
+	if (get_le32(buf + LOG_VERSION_OFF) != BOOT_PROFILE_VERSION)
+		log_err("Unsupported boot profile log version %u",
+			get_le32(buf + LOG_VERSION_OFF));
+
+	num_entries = get_le32(buf + LOG_NUM_ENTRIES_OFF);
+	max_entries = get_le32(buf + LOG_MAX_ENTRIES_OFF);
+	dropped = get_le32(buf + LOG_DROPPED_OFF);
+	if (cnt_freq == 0)
+		cnt_freq = get_le64(buf + LOG_CNT_FREQ_OFF);
+	if (cnt_freq == 0)
+		log_err("Unknown counter frequency, use -f");
+
+	if (num_entries > max_entries)
+		log_err("Corrupted log: %u entries out of %u", num_entries,
+			max_entries);
+	if ((size - LOG_HEADER_SIZE) / ENTRY_SIZE < num_entries)
+		log_err("Truncated log: %u entries expected", num_entries);
+
+	printf("%u entries, %u dropped, counter at %llu Hz\n\n", num_entries,
+	       dropped, (unsigned long long)cnt_freq);
+	if (num_entries == 0)
+		return 0;
+
+	entries = calloc(num_entries, sizeof(entry_t));
+	if (entries == NULL)
+		log_err("calloc: %s", strerror(errno));
+	for (i = 0; i < num_entries; i++)
+		decode_entry(buf + LOG_HEADER_SIZE + i * ENTRY_SIZE,
+			     &entries[i]);
+
+	print_timeline(entries, num_entries);
+	print_stages(entries, num_entries);
+
+	free(entries);
+	free(buf);
+	return 0;
+}
@@ -7,13 +7,16 @@
 #include <assert.h>
 #include <ctype.h>
 #include <getopt.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 #include <openssl/conf.h>
 #include <openssl/engine.h>
 #include <openssl/err.h>
+#include <openssl/opensslv.h>
 #include <openssl/pem.h>
 #include <openssl/sha.h>
 #include <openssl/x509v3.h>
@@ -65,12 +68,31 @@
 #define ID_TO_BIT_MASK(id)		(1 << id)
 #define NUM_ELEM(x)			((sizeof(x)) / (sizeof(x[0])))
 #define HELP_OPT_MAX_LEN		128
+#define BATCH_LINE_MAX_LEN		4096
+#define BATCH_MAX_ARGS			(CMD_OPT_MAX_NUM * 2 + 1)
 
 /* Global options */
 static int key_alg;
 static int new_keys;
 static int save_keys;
 static int print_cert;
+static int num_jobs = 1;
+static const char *batch_fn;
+
+/* Status of the keys and certificates to create */
+enum {
+	JOB_NONE,		/* Nothing to do */
+	JOB_PENDING,		/* Waiting to be picked up by a worker */
+	JOB_RUNNING,		/* Being created by a worker */
+	JOB_DONE		/* Created */
+};
+
+static int *key_job;
+static int *cert_job;
+static unsigned int num_pending_jobs;
+static unsigned int num_running_jobs;
+static pthread_mutex_t job_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t job_cond = PTHREAD_COND_INITIALIZER;
 
 /* Info messages created in the Makefile */
 extern const char build_msg[];
@@ -216,8 +238,530 @@ static void check_cmd_params(void)
 	}
 }
 
+static int get_num_jobs(const char *str)
+{
+	char *end;
+	long n;
+
+	n = strtol(str, &end, 0);
+	if (*str == '\0' || *end != '\0' || n < 0 || n > 1024) {
+		return -1;
+	}
+	if (n == 0) {
+		n = sysconf(_SC_NPROCESSORS_ONLN);
+	}
+
+	return (n < 1) ? 1 : n;
+}
+
+/*
+ * Create a certificate. The keys it refers to must have been created and
+ * its issuer certificate (if different) must have been processed already.
+ */
+static void create_cert(cert_t *cert)
+{
+	STACK_OF(X509_EXTENSION) * sk;
+	X509_EXTENSION *cert_ext = NULL;
+	ext_t *ext;
+	int j, ext_nid, nvctr;
+	unsigned char md[SHA256_DIGEST_LENGTH];
+	const EVP_MD *md_info;
+
+	/* Indicate SHA256 as image hash algorithm in the certificate
+	 * extension */
+	md_info = EVP_sha256();
+
+	/* Create a new stack of extensions. This stack will be used
+	 * to create the certificate */
+	CHECK_NULL(sk, sk_X509_EXTENSION_new_null());
+
+	for (j = 0 ; j < cert->num_ext ; j++) {
+
+		ext = &extensions[cert->ext[j]];
+
+		/* Get OpenSSL internal ID for this extension */
+		CHECK_OID(ext_nid, ext->oid);
+
+		/*
+		 * Three types of extensions are currently supported:
+		 *     - EXT_TYPE_NVCOUNTER
+		 *     - EXT_TYPE_HASH
+		 *     - EXT_TYPE_PKEY
+		 */
+		switch (ext->type) {
+		case EXT_TYPE_NVCOUNTER:
+			if (ext->arg) {
+				nvctr = atoi(ext->arg);
+				CHECK_NULL(cert_ext, ext_new_nvcounter(ext_nid,
+					EXT_CRIT, nvctr));
+			}
+			break;
+		case EXT_TYPE_HASH:
+			if (ext->arg == NULL) {
+				if (ext->optional) {
+					/* Include a hash filled with zeros */
+					memset(md, 0x0, SHA256_DIGEST_LENGTH);
+				} else {
+					/* Do not include this hash in the certificate */
+					break;
+				}
+			} else {
+				/* Calculate the hash of the file */
+				if (!sha_file(ext->arg, md)) {
+					ERROR("Cannot calculate hash of %s\n",
+						ext->arg);
+					exit(1);
+				}
+			}
+			CHECK_NULL(cert_ext, ext_new_hash(ext_nid,
+					EXT_CRIT, md_info, md,
+					SHA256_DIGEST_LENGTH));
+			break;
+		case EXT_TYPE_PKEY:
+			CHECK_NULL(cert_ext, ext_new_key(ext_nid,
+				EXT_CRIT, keys[ext->attr.key].key));
+			break;
+		default:
+			ERROR("Unknown extension type '%d' in %s\n",
+					ext->type, cert->cn);
+			exit(1);
+		}
+
+		/* Push the extension into the stack */
+		sk_X509_EXTENSION_push(sk, cert_ext);
+	}
+
+	/* Create certificate. Signed with corresponding key */
+	if (cert->fn && !cert_new(key_alg, cert, VAL_DAYS, 0, sk)) {
+		ERROR("Cannot create %s\n", cert->cn);
+		exit(1);
+	}
+
+	sk_X509_EXTENSION_free(sk);
+}
+
+static int key_job_done(int key)
+{
+	return (key_job[key] == JOB_NONE) || (key_job[key] == JOB_DONE);
+}
+
+/*
+ * A certificate can be created once the keys it is signed with or carries
+ * are available, and once its issuer certificate has been created.
+ */
+static int cert_job_ready(const cert_t *cert)
+{
+	const cert_t *issuer = &certs[cert->issuer];
+	const ext_t *ext;
+	int j;
+
+	if ((issuer != cert) && (cert_job[cert->issuer] != JOB_DONE)) {
+		return 0;
+	}
+	if (!key_job_done(cert->key) || !key_job_done(issuer->key)) {
+		return 0;
+	}
+	for (j = 0 ; j < cert->num_ext ; j++) {
+		ext = &extensions[cert->ext[j]];
+		if ((ext->type == EXT_TYPE_PKEY) &&
+		    !key_job_done(ext->attr.key)) {
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+/*
+ * Worker thread. Keys are independent from each other and are handed out
+ * first, then each certificate as soon as its dependencies are satisfied.
+ * With a single worker, keys and certificates are created in table order.
+ */
+static void *job_worker(void *arg)
+{
+	int i, *job;
+
+	pthread_mutex_lock(&job_lock);
+	while (num_pending_jobs > 0) {
+		job = NULL;
+		for (i = 0 ; (job == NULL) && (i < num_keys) ; i++) {
+			if (key_job[i] == JOB_PENDING) {
+				job = &key_job[i];
+			}
+		}
+		for (i = 0 ; (job == NULL) && (i < num_certs) ; i++) {
+			if ((cert_job[i] == JOB_PENDING) &&
+			    cert_job_ready(&certs[i])) {
+				job = &cert_job[i];
+			}
+		}
+		if (job == NULL) {
+			if (num_running_jobs == 0) {
+				ERROR("Unsatisfiable certificate dependencies\n");
+				exit(1);
+			}
+			/* Wait for another worker to satisfy a dependency */
+			pthread_cond_wait(&job_cond, &job_lock);
+			continue;
+		}
+
+		*job = JOB_RUNNING;
+		num_running_jobs++;
+		pthread_mutex_unlock(&job_lock);
+
+		if ((job >= key_job) && (job < key_job + num_keys)) {
+			i = job - key_job;
+			NOTICE("Creating new key for '%s'\n", keys[i].desc);
+			if (!key_create(&keys[i], key_alg)) {
+				ERROR("Error creating key '%s'\n", keys[i].desc);
+				exit(1);
+			}
+		} else {
+			create_cert(&certs[job - cert_job]);
+		}
+
+		pthread_mutex_lock(&job_lock);
+		*job = JOB_DONE;
+		num_pending_jobs--;
+		num_running_jobs--;
+		pthread_cond_broadcast(&job_cond);
+	}
+	pthread_mutex_unlock(&job_lock);
+
+	return NULL;
+}
+
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+/* OpenSSL versions before 1.1.0 rely on the application for locking */
+static pthread_mutex_t *openssl_locks;
+
+static void openssl_lock_cb(int mode, int n, const char *file, int line)
+{
+	if (mode & CRYPTO_LOCK) {
+		pthread_mutex_lock(&openssl_locks[n]);
+	} else {
+		pthread_mutex_unlock(&openssl_locks[n]);
+	}
+}
+
+static unsigned long openssl_thread_id_cb(void)
+{
+	return (unsigned long)pthread_self();
+}
+
+static void openssl_thread_setup(void)
+{
+	int i;
+
+	if (openssl_locks != NULL) {
+		return;
+	}
+
+	openssl_locks = calloc(CRYPTO_num_locks(), sizeof(*openssl_locks));
+	if (openssl_locks == NULL) {
+		ERROR("Cannot allocate memory for OpenSSL locks\n");
+		exit(1);
+	}
+	for (i = 0 ; i < CRYPTO_num_locks() ; i++) {
+		pthread_mutex_init(&openssl_locks[i], NULL);
+	}
+	CRYPTO_set_id_callback(openssl_thread_id_cb);
+	CRYPTO_set_locking_callback(openssl_lock_cb);
+}
+#else
+static void openssl_thread_setup(void)
+{
+}
+#endif
+
+/* Create all pending keys and certificates using 'num_jobs' threads */
+static void run_jobs(void)
+{
+	pthread_t *threads;
+	int i;
+
+	if (num_jobs == 1) {
+		job_worker(NULL);
+		return;
+	}
+
+	openssl_thread_setup();
+
+	threads = calloc(num_jobs, sizeof(*threads));
+	if (threads == NULL) {
+		ERROR("Cannot allocate memory for %d threads\n", num_jobs);
+		exit(1);
+	}
+	for (i = 0 ; i < num_jobs ; i++) {
+		if (pthread_create(&threads[i], NULL, job_worker, NULL) != 0) {
+			ERROR("Cannot create worker thread\n");
+			exit(1);
+		}
+	}
+	for (i = 0 ; i < num_jobs ; i++) {
+		pthread_join(threads[i], NULL);
+	}
+	free(threads);
+}
+
+/* Schedule the creation of every certificate in the chain of trust */
+static void queue_certs(void)
+{
+	int i;
+
+	for (i = 0 ; i < num_certs ; i++) {
+		cert_job[i] = JOB_PENDING;
+		num_pending_jobs++;
+	}
+}
+
+/* Print the created certificates and save them to files */
+static void output_certs(void)
+{
+	FILE *file;
+	int i;
+
+	/* Print the certificates */
+	if (print_cert) {
+		for (i = 0 ; i < num_certs ; i++) {
+			if (!certs[i].x) {
+				continue;
+			}
+			printf("\n\n=====================================\n\n");
+			X509_print_fp(stdout, certs[i].x);
+		}
+	}
+
+	/* Save created certificates to files */
+	for (i = 0 ; i < num_certs ; i++) {
+		if (certs[i].x && certs[i].fn) {
+			file = fopen(certs[i].fn, "w");
+			if (file != NULL) {
+				i2d_X509_fp(file, certs[i].x);
+				fclose(file);
+			} else {
+				ERROR("Cannot create file %s\n", certs[i].fn);
+			}
+		}
+	}
+}
+
+/*
+ * Split a line of the batch manifest into arguments, in place. Arguments are
+ * separated by spaces and tabs, and may be quoted to hold spaces: nothing is
+ * special between single quotes, and a backslash escapes the next character
+ * outside them. Returns the number of arguments stored after argv[0].
+ */
+static int split_batch_line(char *buf, char *argv[], int line)
+{
+	char *src = buf, *dst = buf;
+	char quote;
+	int argc = 1;
+
+	while (1) {
+		while (*src == ' ' || *src == '\t' || *src == '\r' ||
+		       *src == '\n') {
+			src++;
+		}
+		if (*src == '\0') {
+			break;
+		}
+		if (argc == BATCH_MAX_ARGS - 1) {
+			ERROR("%s:%d: too many arguments\n", batch_fn, line);
+			exit(1);
+		}
+
+		/* Unquote the argument, which can only get shorter */
+		argv[argc++] = dst;
+		quote = '\0';
+		while (*src != '\0') {
+			if (quote == '\0' && (*src == ' ' || *src == '\t' ||
+			    *src == '\r' || *src == '\n')) {
+				break;
+			}
+			if ((quote == '\0' && (*src == '\'' || *src == '"')) ||
+			    *src == quote) {
+				quote = (quote == '\0') ? *src : '\0';
+				src++;
+				continue;
+			}
+			if (*src == '\\' && quote != '\'' && src[1] != '\0' &&
+			    src[1] != '\n') {
+				src++;
+			}
+			*dst++ = *src++;
+		}
+		if (quote != '\0') {
+			ERROR("%s:%d: missing closing quote\n", batch_fn, line);
+			exit(1);
+		}
+		if (*src != '\0') {
+			src++;
+		}
+		*dst++ = '\0';
+	}
+
+	argv[argc] = NULL;
+	return argc;
+}
+
+/*
+ * Parse the options of one certificate set in the batch manifest. Only
+ * image, counter and certificate options are accepted: keys and global
+ * options apply to the whole batch and come from the command line. The
+ * values are copied, and a value given twice replaces the first copy.
+ */
+static void parse_batch_opts(int argc, char *argv[],
+			     const struct option *cmd_opt, int line,
+			     const char **ext_args, const char **cert_fns)
+{
+	const char *cur_opt;
+	ext_t *ext;
+	cert_t *cert;
+	int c, opt_idx = 0;
+
+	/* Restart the scan of a new argument vector */
+	optind = 0;
+
+	while (1) {
+		c = getopt_long(argc, argv, "", cmd_opt, &opt_idx);
+		if (c == -1) {
+			break;
+		}
+
+		switch (c) {
+		case CMD_OPT_EXT:
+			cur_opt = cmd_opt_get_name(opt_idx);
+			ext = ext_get_by_opt(cur_opt);
+			if (ext->arg != ext_args[ext - extensions]) {
+				free((void *)ext->arg);
+			}
+			ext->arg = strdup(optarg);
+			break;
+		case CMD_OPT_CERT:
+			cur_opt = cmd_opt_get_name(opt_idx);
+			cert = cert_get_by_opt(cur_opt);
+			if (cert->fn != cert_fns[cert - certs]) {
+				free((void *)cert->fn);
+			}
+			cert->fn = strdup(optarg);
+			break;
+		default:
+			ERROR("%s:%d: option not allowed in a batch manifest\n",
+			      batch_fn, line);
+			exit(1);
+		}
+	}
+
+	if (optind != argc) {
+		ERROR("%s:%d: unexpected argument '%s'\n", batch_fn, line,
+		      argv[optind]);
+		exit(1);
+	}
+}
+
+/*
+ * Free the values given by a line of the batch manifest, and go back to the
+ * values shared by all the sets.
+ */
+static void reset_batch_set(const char **ext_args, const char **cert_fns)
+{
+	int i;
+
+	for (i = 0 ; i < num_extensions ; i++) {
+		if (extensions[i].arg != ext_args[i]) {
+			free((void *)extensions[i].arg);
+			extensions[i].arg = ext_args[i];
+		}
+	}
+	for (i = 0 ; i < num_certs ; i++) {
+		if (certs[i].fn != cert_fns[i]) {
+			free((void *)certs[i].fn);
+			certs[i].fn = cert_fns[i];
+		}
+		X509_free(certs[i].x);
+		certs[i].x = NULL;
+	}
+}
+
+/*
+ * Create the certificate sets listed in the batch manifest, one set per
+ * line, reusing the keys loaded or created once for the whole batch. Each
+ * line holds the image, counter and certificate options of one set, as
+ * they would be given on the command line. Values given on the command
+ * line are used by every set unless a line overrides them. Empty lines
+ * and lines starting with '#' are ignored.
+ */
+static void run_batch(const struct option *cmd_opt)
+{
+	char buf[BATCH_LINE_MAX_LEN];
+	char *argv[BATCH_MAX_ARGS];
+	const char **ext_args, **cert_fns;
+	FILE *fp;
+	int i, argc, line = 0, num_sets = 0;
+
+	fp = fopen(batch_fn, "r");
+	if (fp == NULL) {
+		ERROR("Cannot open batch manifest %s\n", batch_fn);
+		exit(1);
+	}
+
+	/* Remember the values shared by all the sets */
+	ext_args = calloc(num_extensions, sizeof(*ext_args));
+	cert_fns = calloc(num_certs, sizeof(*cert_fns));
+	if (ext_args == NULL || cert_fns == NULL) {
+		ERROR("Cannot allocate memory for the batch defaults\n");
+		exit(1);
+	}
+	for (i = 0 ; i < num_extensions ; i++) {
+		ext_args[i] = extensions[i].arg;
+	}
+	for (i = 0 ; i < num_certs ; i++) {
+		cert_fns[i] = certs[i].fn;
+	}
+
+	while (fgets(buf, sizeof(buf), fp) != NULL) {
+		line++;
+		if (strchr(buf, '\n') == NULL && !feof(fp)) {
+			ERROR("%s:%d: line too long\n", batch_fn, line);
+			exit(1);
+		}
+
+		argv[0] = (char *)batch_fn;
+		argc = split_batch_line(buf, argv, line);
+		if (argc == 1 || argv[1][0] == '#') {
+			continue;
+		}
+
+		/* Start from the shared values */
+		reset_batch_set(ext_args, cert_fns);
+
+		parse_batch_opts(argc, argv, cmd_opt, line, ext_args,
+				 cert_fns);
+		check_cmd_params();
+
+		INFO("Creating certificate set from %s:%d\n", batch_fn, line);
+		queue_certs();
+		run_jobs();
+		output_certs();
+		num_sets++;
+	}
+
+	reset_batch_set(ext_args, cert_fns);
+	fclose(fp);
+	free(ext_args);
+	free(cert_fns);
+
+	NOTICE("Created %d certificate sets\n", num_sets);
+}
+
 /* Common command line options */
 static const cmd_opt_t common_cmd_opt[] = {
+	{
+		{ "batch", required_argument, NULL, 'b' },
+		"Create the certificate sets listed in a manifest file, one \
+set of image and certificate options per line"
+	},
 	{
 		{ "help", no_argument, NULL, 'h' },
 		"Print this message and exit"
@@ -226,6 +770,11 @@ static const cmd_opt_t common_cmd_opt[] = {
 		{ "key-alg", required_argument, NULL, 'a' },
 		"Key algorithm: 'rsa' (default) - RSAPSS scheme as per \
 PKCS#1 v2.1, 'rsa_1_5' - RSA PKCS#1 v1.5, 'ecdsa'"
+	},
+	{
+		{ "jobs", required_argument, NULL, 'j' },
+		"Number of threads creating keys and certificates in parallel \
+(default: 1, 0 - one per online CPU)"
 	},
 	{
 		{ "save-keys", no_argument, NULL, 'k' },
@@ -243,19 +792,14 @@ PKCS#1 v2.1, 'rsa_1_5' - RSA PKCS#1 v1.5, 'ecdsa'"
 
 int main(int argc, char *argv[])
 {
-	STACK_OF(X509_EXTENSION) * sk;
-	X509_EXTENSION *cert_ext = NULL;
 	ext_t *ext;
 	key_t *key;
 	cert_t *cert;
-	FILE *file;
-	int i, j, ext_nid, nvctr;
+	int i;
 	int c, opt_idx = 0;
 	const struct option *cmd_opt;
 	const char *cur_opt;
 	unsigned int err_code;
-	unsigned char md[SHA256_DIGEST_LENGTH];
-	const EVP_MD *md_info;
 
 	NOTICE("CoT Generation Tool: %s\n", build_msg);
 	NOTICE("Target platform: %s\n", platform_msg);
@@ -291,7 +835,7 @@ int main(int argc, char *argv[])
 
 	while (1) {
 		/* getopt_long stores the option index here. */
-		c = getopt_long(argc, argv, "a:hknp", cmd_opt, &opt_idx);
+		c = getopt_long(argc, argv, "a:b:hj:knp", cmd_opt, &opt_idx);
 
 		/* Detect the end of the options. */
 		if (c == -1) {
@@ -306,9 +850,19 @@ int main(int argc, char *argv[])
 				exit(1);
 			}
 			break;
+		case 'b':
+			batch_fn = strdup(optarg);
+			break;
 		case 'h':
 			print_help(argv[0], cmd_opt);
 			break;
+		case 'j':
+			num_jobs = get_num_jobs(optarg);
+			if (num_jobs < 1) {
+				ERROR("Invalid number of jobs '%s'\n", optarg);
+				exit(1);
+			}
+			break;
 		case 'k':
 			save_keys = 1;
 			break;
@@ -343,9 +897,12 @@ int main(int argc, char *argv[])
 	/* Check command line arguments */
 	check_cmd_params();
 
-	/* Indicate SHA256 as image hash algorithm in the certificate
-	 * extension */
-	md_info = EVP_sha256();
+	key_job = calloc(num_keys, sizeof(*key_job));
+	cert_job = calloc(num_certs, sizeof(*cert_job));
+	if (key_job == NULL || cert_job == NULL) {
+		ERROR("Cannot allocate memory for the job table\n");
+		exit(1);
+	}
 
 	/* Load private keys from files (or generate new ones) */
 	for (i = 0 ; i < num_keys ; i++) {
@@ -371,12 +928,9 @@ int main(int argc, char *argv[])
 		/* File does not exist, could not be opened or no filename was
 		 * given */
 		if (new_keys) {
-			/* Try to create a new key */
-			NOTICE("Creating new key for '%s'\n", keys[i].desc);
-			if (!key_create(&keys[i], key_alg)) {
-				ERROR("Error creating key '%s'\n", keys[i].desc);
-				exit(1);
-			}
+			/* Create a new key along with the certificates */
+			key_job[i] = JOB_PENDING;
+			num_pending_jobs++;
 		} else {
 			if (err_code == KEY_ERR_OPEN) {
 				ERROR("Error opening '%s'\n", keys[i].fn);
@@ -387,103 +941,15 @@ int main(int argc, char *argv[])
 		}
 	}
 
-	/* Create the certificates */
-	for (i = 0 ; i < num_certs ; i++) {
-
-		cert = &certs[i];
-
-		/* Create a new stack of extensions. This stack will be used
-		 * to create the certificate */
-		CHECK_NULL(sk, sk_X509_EXTENSION_new_null());
-
-		for (j = 0 ; j < cert->num_ext ; j++) {
-
-			ext = &extensions[cert->ext[j]];
-
-			/* Get OpenSSL internal ID for this extension */
-			CHECK_OID(ext_nid, ext->oid);
-
-			/*
-			 * Three types of extensions are currently supported:
-			 *     - EXT_TYPE_NVCOUNTER
-			 *     - EXT_TYPE_HASH
-			 *     - EXT_TYPE_PKEY
-			 */
-			switch (ext->type) {
-			case EXT_TYPE_NVCOUNTER:
-				if (ext->arg) {
-					nvctr = atoi(ext->arg);
-					CHECK_NULL(cert_ext, ext_new_nvcounter(ext_nid,
-						EXT_CRIT, nvctr));
-				}
-				break;
-			case EXT_TYPE_HASH:
-				if (ext->arg == NULL) {
-					if (ext->optional) {
-						/* Include a hash filled with zeros */
-						memset(md, 0x0, SHA256_DIGEST_LENGTH);
-					} else {
-						/* Do not include this hash in the certificate */
-						break;
-					}
-				} else {
-					/* Calculate the hash of the file */
-					if (!sha_file(ext->arg, md)) {
-						ERROR("Cannot calculate hash of %s\n",
-							ext->arg);
-						exit(1);
-					}
-				}
-				CHECK_NULL(cert_ext, ext_new_hash(ext_nid,
-						EXT_CRIT, md_info, md,
-						SHA256_DIGEST_LENGTH));
-				break;
-			case EXT_TYPE_PKEY:
-				CHECK_NULL(cert_ext, ext_new_key(ext_nid,
-					EXT_CRIT, keys[ext->attr.key].key));
-				break;
-			default:
-				ERROR("Unknown extension type '%d' in %s\n",
-						ext->type, cert->cn);
-				exit(1);
-			}
-
-			/* Push the extension into the stack */
-			sk_X509_EXTENSION_push(sk, cert_ext);
-		}
-
-		/* Create certificate. Signed with corresponding key */
-		if (cert->fn && !cert_new(key_alg, cert, VAL_DAYS, 0, sk)) {
-			ERROR("Cannot create %s\n", cert->cn);
-			exit(1);
-		}
-
-		sk_X509_EXTENSION_free(sk);
-	}
-
-
-	/* Print the certificates */
-	if (print_cert) {
-		for (i = 0 ; i < num_certs ; i++) {
-			if (!certs[i].x) {
-				continue;
-			}
-			printf("\n\n=====================================\n\n");
-			X509_print_fp(stdout, certs[i].x);
-		}
-	}
-
-	/* Save created certificates to files */
-	for (i = 0 ; i < num_certs ; i++) {
-		if (certs[i].x && certs[i].fn) {
-			file = fopen(certs[i].fn, "w");
-			if (file != NULL) {
-				i2d_X509_fp(file, certs[i].x);
-				fclose(file);
-			} else {
-				ERROR("Cannot create file %s\n", certs[i].fn);
-			}
-		}
+	if (batch_fn != NULL) {
+		/* Create the new keys, then every set in the manifest */
+		run_jobs();
+		run_batch(cmd_opt);
+	} else {
+		/* Create the new keys and the certificates */
+		queue_certs();
+		run_jobs();
+		output_certs();
 	}
 
 	/* Save keys */
@@ -1,40 +1,74 @@
 /*
- * Copyright (c) 2015, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2015-2017, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
+#include <fcntl.h>
 #include <openssl/sha.h>
-#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "debug.h"
 
-#define BUFFER_SIZE	256
+#define BUFFER_SIZE	(1024 * 1024)
 
+/*
+ * Calculate the SHA256 of a file. Regular files are mapped into memory and
+ * hashed in one go; anything that cannot be mapped is read through a large
+ * buffer instead. This function may be called from several threads.
+ */
 int sha_file(const char *filename, unsigned char *md)
 {
-	FILE *inFile;
+	int fd;
 	SHA256_CTX shaContext;
-	int bytes;
-	unsigned char data[BUFFER_SIZE];
+	struct stat st;
+	void *map;
+	ssize_t bytes;
+	unsigned char *data;
 
 	if ((filename == NULL) || (md == NULL)) {
 		ERROR("%s(): NULL argument\n", __FUNCTION__);
 		return 0;
 	}
 
-	inFile = fopen(filename, "rb");
-	if (inFile == NULL) {
+	fd = open(filename, O_RDONLY);
+	if (fd < 0) {
 		ERROR("Cannot read %s\n", filename);
 		return 0;
 	}
 
+	if ((fstat(fd, &st) == 0) && S_ISREG(st.st_mode) &&
+	    (st.st_size > 0)) {
+		map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (map != MAP_FAILED) {
+			SHA256(map, st.st_size, md);
+			munmap(map, st.st_size);
+			close(fd);
+			return 1;
+		}
+	}
+
+	data = malloc(BUFFER_SIZE);
+	if (data == NULL) {
+		ERROR("Cannot allocate memory to read %s\n", filename);
+		close(fd);
+		return 0;
+	}
+
 	SHA256_Init(&shaContext);
-	while ((bytes = fread(data, 1, BUFFER_SIZE, inFile)) != 0) {
+	while ((bytes = read(fd, data, BUFFER_SIZE)) > 0) {
 		SHA256_Update(&shaContext, data, bytes);
 	}
 	SHA256_Final(md, &shaContext);
 
-	fclose(inFile);
+	free(data);
+	close(fd);
+	if (bytes < 0) {
+		ERROR("Cannot read %s\n", filename);
+		return 0;
+	}
 	return 1;
 }
@@ -22,6 +22,8 @@
 #define OPT_TOC_ENTRY 0
 #define OPT_PLAT_TOC_FLAGS 1
 #define OPT_ALIGN 2
+#define OPT_RESERVE 3
+#define OPT_IN_PLACE 4
 
 static int info_cmd(int argc, char *argv[]);
 static void info_usage(void);
@@ -51,6 +53,7 @@ static cmd_t cmds[] = {
 
 static image_desc_t *image_desc_head;
 static size_t nr_image_descs;
+static file_map_t *file_maps;
 static uuid_t uuid_null = { 0 };
 static int verbose;
 
@@ -128,10 +131,172 @@ static void *xzalloc(size_t size, const char *msg)
 	return memset(xmalloc(size, msg), 0, size);
 }
 
-static void xfwrite(void *buf, size_t size, FILE *fp, const char *filename)
+/*
+ * Load a file into memory and return its contents. On Posix hosts the
+ * file is mapped rather than read, so that large images are never copied.
+ * The memory stays valid until unmap_files() is called.
+ */
+static void *map_file(const char *filename, size_t *size)
 {
-	if (fwrite(buf, 1, size, fp) != size)
-		log_errx("Failed to write %s", filename);
+	struct BLD_PLAT_STAT st;
+	file_map_t *map;
+	FILE *fp;
+
+	fp = fopen(filename, "rb");
+	if (fp == NULL)
+		log_err("fopen %s", filename);
+
+	if (fstat(fileno(fp), &st) == -1)
+		log_err("fstat %s", filename);
+
+	map = xzalloc(sizeof(*map), "failed to allocate memory for file map");
+	map->size = st.st_size;
+	map->dev = st.st_dev;
+	map->ino = st.st_ino;
+#ifndef _MSC_VER
+	if (map->size != 0) {
+		map->addr = mmap(NULL, map->size, PROT_READ, MAP_PRIVATE,
+		    fileno(fp), 0);
+		if (map->addr == MAP_FAILED)
+			log_err("mmap %s", filename);
+		map->mapped = 1;
+	}
+#else
+	map->addr = xmalloc(map->size, "failed to load file into memory");
+	if (fread(map->addr, 1, map->size, fp) != map->size)
+		log_errx("Failed to read %s", filename);
+#endif
+	fclose(fp);
+
+	map->next = file_maps;
+	file_maps = map;
+	*size = map->size;
+	return map->addr;
+}
+
+static void unmap_files(void)
+{
+	file_map_t *map = file_maps, *tmp;
+
+	while (map != NULL) {
+		tmp = map->next;
+#ifndef _MSC_VER
+		if (map->mapped)
+			munmap(map->addr, map->size);
+		else
+			free(map->addr);
+#else
+		free(map->addr);
+#endif
+		free(map);
+		map = tmp;
+	}
+	file_maps = NULL;
+}
+
+#ifndef _MSC_VER
+/*
+ * Copy a mapped file to memory and point the image buffers taken from the
+ * mapping to the copy, so that the file can be truncated and rewritten.
+ */
+static void detach_map(file_map_t *map)
+{
+	image_desc_t *desc;
+	char *copy, *addr = map->addr;
+
+	copy = xmalloc(map->size, "failed to allocate memory for file copy");
+	memcpy(copy, addr, map->size);
+
+	for (desc = image_desc_head; desc != NULL; desc = desc->next) {
+		image_t *image = desc->image;
+		char *buf;
+
+		if (image == NULL)
+			continue;
+		buf = image->buffer;
+		if (buf >= addr && buf <= addr + map->size)
+			image->buffer = copy + (buf - addr);
+	}
+
+	munmap(map->addr, map->size);
+	map->addr = copy;
+	map->mapped = 0;
+}
+
+/*
+ * Image buffers may point into the mapping of the file about to be written,
+ * so move them to a copy of the file first. The file is then truncated and
+ * written in place like any other, which follows symbolic links and keeps
+ * hard links, owner, mode and extended attributes.
+ */
+static void detach_output(const char *filename)
+{
+	struct stat st;
+	file_map_t *map;
+
+	if (stat(filename, &st) != 0)
+		return;
+
+	for (map = file_maps; map != NULL; map = map->next) {
+		if (map->mapped && map->dev == st.st_dev &&
+		    map->ino == st.st_ino)
+			detach_map(map);
+	}
+}
+
+static void xwritev(int fd, struct iovec *iov, size_t iovcnt,
+    const char *filename)
+{
+	while (iovcnt > 0) {
+		ssize_t n;
+
+		n = writev(fd, iov, iovcnt > IOV_MAX ? IOV_MAX : iovcnt);
+		if (n == -1) {
+			if (errno == EINTR)
+				continue;
+			log_err("writev %s", filename);
+		}
+
+		/* Skip the vectors written in full, trim a partial one. */
+		while (iovcnt > 0 && (size_t)n >= iov->iov_len) {
+			n -= iov->iov_len;
+			iov++;
+			iovcnt--;
+		}
+		if (iovcnt > 0) {
+			iov->iov_base = (char *)iov->iov_base + n;
+			iov->iov_len -= n;
+		}
+	}
+}
+#endif
+
+/* Write out a list of buffers back to back, in a single pass. */
+static void write_iov_to_file(struct iovec *iov, size_t iovcnt,
+    const char *filename)
+{
+#ifndef _MSC_VER
+	int fd;
+
+	fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+	if (fd == -1)
+		log_err("open %s", filename);
+	xwritev(fd, iov, iovcnt, filename);
+	if (close(fd) == -1)
+		log_err("close %s", filename);
+#else
+	FILE *fp;
+	size_t i;
+
+	fp = fopen(filename, "wb");
+	if (fp == NULL)
+		log_err("fopen %s", filename);
+	for (i = 0; i < iovcnt; i++)
+		if (fwrite(iov[i].iov_base, 1, iov[i].iov_len, fp) !=
+		    iov[i].iov_len)
+			log_errx("Failed to write %s", filename);
+	fclose(fp);
+#endif
 }
 
 static image_desc_t *new_image_desc(const uuid_t *uuid,
@@ -272,27 +437,16 @@ static void uuid_from_str(uuid_t *u, const char *s)
 
 static int parse_fip(const char *filename, fip_toc_header_t *toc_header_out)
 {
-	struct BLD_PLAT_STAT st;
-	FILE *fp;
+	size_t size;
 	char *buf, *bufend;
 	fip_toc_header_t *toc_header;
 	fip_toc_entry_t *toc_entry;
 	int terminated = 0;
 
-	fp = fopen(filename, "rb");
-	if (fp == NULL)
-		log_err("fopen %s", filename);
-
-	if (fstat(fileno(fp), &st) == -1)
-		log_err("fstat %s", filename);
-
-	buf = xmalloc(st.st_size, "failed to load file into memory");
-	if (fread(buf, 1, st.st_size, fp) != st.st_size)
-		log_errx("Failed to read %s", filename);
-	bufend = buf + st.st_size;
-	fclose(fp);
+	buf = map_file(filename, &size);
+	bufend = buf + size;
 
-	if (st.st_size < sizeof(fip_toc_header_t))
+	if (size < sizeof(fip_toc_header_t))
 		log_errx("FIP %s is truncated", filename);
 
 	toc_header = (fip_toc_header_t *)buf;
@@ -323,16 +477,14 @@ static int parse_fip(const char *filename, fip_toc_header_t *toc_header_out)
 		image = xzalloc(sizeof(*image),
 		    "failed to allocate memory for image");
 		image->toc_e = *toc_entry;
-		image->buffer = xmalloc(toc_entry->size,
-		    "failed to allocate image buffer, is FIP file corrupted?");
-		/* Overflow checks before memory copy. */
+		/* Overflow checks before referencing the payload. */
 		if (toc_entry->size > (uint64_t)-1 - toc_entry->offset_address)
 			log_errx("FIP %s is corrupted", filename);
-		if (toc_entry->size + toc_entry->offset_address > st.st_size)
+		if (toc_entry->size + toc_entry->offset_address > size)
 			log_errx("FIP %s is corrupted", filename);
 
-		memcpy(image->buffer, buf + toc_entry->offset_address,
-		    toc_entry->size);
+		/* The payload is used in place, it is not copied. */
+		image->buffer = buf + toc_entry->offset_address;
 
 		/* If this is an unknown image, create a descriptor for it. */
 		desc = lookup_image_desc_from_uuid(&toc_entry->uuid);
@@ -358,46 +510,31 @@ static int parse_fip(const char *filename, fip_toc_header_t *toc_header_out)
 	if (terminated == 0)
 		log_errx("FIP %s does not have a ToC terminator entry",
 		    filename);
-	free(buf);
 	return 0;
 }
 
 static image_t *read_image_from_file(const uuid_t *uuid, const char *filename)
 {
-	struct BLD_PLAT_STAT st;
 	image_t *image;
-	FILE *fp;
+	size_t size;
 
 	assert(uuid != NULL);
 	assert(filename != NULL);
 
-	fp = fopen(filename, "rb");
-	if (fp == NULL)
-		log_err("fopen %s", filename);
-
-	if (fstat(fileno(fp), &st) == -1)
-		log_errx("fstat %s", filename);
-
 	image = xzalloc(sizeof(*image), "failed to allocate memory for image");
 	image->toc_e.uuid = *uuid;
-	image->buffer = xmalloc(st.st_size, "failed to allocate image buffer");
-	if (fread(image->buffer, 1, st.st_size, fp) != st.st_size)
-		log_errx("Failed to read %s", filename);
-	image->toc_e.size = st.st_size;
-
-	fclose(fp);
+	image->buffer = map_file(filename, &size);
+	image->toc_e.size = size;
 	return image;
 }
 
 static int write_image_to_file(const image_t *image, const char *filename)
 {
-	FILE *fp;
+	struct iovec iov;
 
-	fp = fopen(filename, "wb");
-	if (fp == NULL)
-		log_err("fopen");
-	xfwrite(image->buffer, image->toc_e.size, fp, filename);
-	fclose(fp);
+	iov.iov_base = image->buffer;
+	iov.iov_len = image->toc_e.size;
+	write_iov_to_file(&iov, 1, filename);
 	return 0;
 }
 
@@ -434,10 +571,77 @@ static void md_print(const unsigned char *md, size_t len)
 		printf("%02x", md[i]);
 }
 
+#ifndef _MSC_VER	/* We don't have SHA256 for Visual Studio. */
+typedef struct hash_job {
+	image_t        **images;
+	unsigned char  (*md)[SHA256_DIGEST_LENGTH];
+	size_t           nr_images;
+	size_t           next;
+	pthread_mutex_t  lock;
+} hash_job_t;
+
+static void *hash_worker(void *arg)
+{
+	hash_job_t *job = arg;
+
+	while (1) {
+		size_t i;
+
+		pthread_mutex_lock(&job->lock);
+		i = job->next++;
+		pthread_mutex_unlock(&job->lock);
+		if (i >= job->nr_images)
+			break;
+		SHA256(job->images[i]->buffer, job->images[i]->toc_e.size,
+		    job->md[i]);
+	}
+	return NULL;
+}
+
+/*
+ * Compute the SHA256 digest of every image in the table. Images are
+ * handed out one at a time to a pool of threads, one per online CPU.
+ */
+static void hash_images(image_t **images, size_t nr_images,
+    unsigned char (*md)[SHA256_DIGEST_LENGTH])
+{
+	hash_job_t job = { .images = images, .md = md,
+	    .nr_images = nr_images };
+	pthread_t *threads;
+	long nr_cpus;
+	size_t i, nr_threads;
+
+	nr_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	nr_threads = nr_cpus > 1 ? (size_t)nr_cpus : 1;
+	if (nr_threads > nr_images)
+		nr_threads = nr_images;
+	if (nr_threads <= 1) {
+		hash_worker(&job);
+		return;
+	}
+
+	pthread_mutex_init(&job.lock, NULL);
+	threads = xmalloc(nr_threads * sizeof(*threads),
+	    "failed to allocate memory for hash threads");
+	for (i = 0; i < nr_threads; i++)
+		if (pthread_create(&threads[i], NULL, hash_worker, &job) != 0)
+			log_errx("Failed to create hash thread");
+	for (i = 0; i < nr_threads; i++)
+		pthread_join(threads[i], NULL);
+	free(threads);
+	pthread_mutex_destroy(&job.lock);
+}
+#endif
+
 static int info_cmd(int argc, char *argv[])
 {
 	image_desc_t *desc;
 	fip_toc_header_t toc_header;
+#ifndef _MSC_VER
+	unsigned char (*md)[SHA256_DIGEST_LENGTH] = NULL;
+	image_t **images = NULL;
+	size_t nr_images = 0;
+#endif
 
 	if (argc != 2)
 		info_usage();
@@ -454,6 +658,20 @@ static int info_cmd(int argc, char *argv[])
 		    (unsigned long long)toc_header.flags);
 	}
 
+#ifndef _MSC_VER
+	if (verbose) {
+		images = xmalloc(nr_image_descs * sizeof(*images),
+		    "failed to allocate memory for image table");
+		md = xmalloc(nr_image_descs * sizeof(*md),
+		    "failed to allocate memory for image digests");
+		for (desc = image_desc_head; desc != NULL; desc = desc->next)
+			if (desc->image != NULL)
+				images[nr_images++] = desc->image;
+		hash_images(images, nr_images, md);
+		nr_images = 0;
+	}
+#endif
+
 	for (desc = image_desc_head; desc != NULL; desc = desc->next) {
 		image_t *image = desc->image;
 
@@ -466,16 +684,17 @@ static int info_cmd(int argc, char *argv[])
 		       desc->cmdline_name);
 #ifndef _MSC_VER	/* We don't have SHA256 for Visual Studio. */
 		if (verbose) {
-			unsigned char md[SHA256_DIGEST_LENGTH];
-
-			SHA256(image->buffer, image->toc_e.size, md);
 			printf(", sha256=");
-			md_print(md, sizeof(md));
+			md_print(md[nr_images++], SHA256_DIGEST_LENGTH);
 		}
 #endif
 		putchar('\n');
 	}
 
+#ifndef _MSC_VER
+	free(images);
+	free(md);
+#endif
 	return 0;
 }
 
@@ -485,16 +704,49 @@ static void info_usage(void)
 	exit(1);
 }
 
-static int pack_images(const char *filename, uint64_t toc_flags, unsigned long align)
+/* Zero-filled chunk used to pad images up to the requested alignment. */
+static char pad_buf[4096];
+
+static struct iovec *add_iov(struct iovec *iov, size_t *iovcnt,
+    void *base, size_t len)
+{
+	iov = realloc(iov, (*iovcnt + 1) * sizeof(*iov));
+	if (iov == NULL)
+		log_err("realloc");
+	iov[*iovcnt].iov_base = base;
+	iov[*iovcnt].iov_len = len;
+	++*iovcnt;
+	return iov;
+}
+
+static struct iovec *add_padding(struct iovec *iov, size_t *iovcnt,
+    uint64_t len)
+{
+	while (len > 0) {
+		size_t n = len > sizeof(pad_buf) ? sizeof(pad_buf) : len;
+
+		iov = add_iov(iov, iovcnt, pad_buf, n);
+		len -= n;
+	}
+	return iov;
+}
+
+static int pack_images(const char *filename, uint64_t toc_flags,
+    unsigned long align, unsigned long reserve)
 {
-	FILE *fp;
 	image_desc_t *desc;
 	fip_toc_header_t *toc_header;
 	fip_toc_entry_t *toc_entry;
+	struct iovec *iov = NULL;
+	size_t iovcnt = 0;
 	char *buf;
-	uint64_t entry_offset, buf_size, payload_size = 0;
+	uint64_t entry_offset, end_offset, buf_size, payload_size = 0;
 	size_t nr_images = 0;
 
+#ifndef _MSC_VER
+	detach_output(filename);
+#endif
+
 	for (desc = image_desc_head; desc != NULL; desc = desc->next)
 		if (desc->image != NULL)
 			nr_images++;
@@ -523,39 +775,41 @@ static int pack_images(const char *filename, uint64_t toc_flags, unsigned long a
 		entry_offset = (entry_offset + align - 1) & ~(align - 1);
 		image->toc_e.offset_address = entry_offset;
 		*toc_entry++ = image->toc_e;
-		entry_offset += image->toc_e.size;
+		/* Leave room for the image to grow on in-place updates. */
+		entry_offset += image->toc_e.size + reserve;
 	}
+	end_offset = entry_offset;
 
 	/* Append a null uuid entry to mark the end of ToC entries. */
 	memset(toc_entry, 0, sizeof(*toc_entry));
-	toc_entry->offset_address = entry_offset;
-
-	/* Generate the FIP file. */
-	fp = fopen(filename, "wb");
-	if (fp == NULL)
-		log_err("fopen %s", filename);
+	toc_entry->offset_address = end_offset;
 
 	if (verbose)
 		log_dbgx("Metadata size: %zu bytes", buf_size);
-
-	xfwrite(buf, buf_size, fp, filename);
-	free(buf);
-
 	if (verbose)
 		log_dbgx("Payload size: %zu bytes", payload_size);
 
+	/*
+	 * Gather the ToC, the alignment padding and the image payloads
+	 * and generate the FIP file with a single write.
+	 */
+	iov = add_iov(iov, &iovcnt, buf, buf_size);
+	entry_offset = buf_size;
 	for (desc = image_desc_head; desc != NULL; desc = desc->next) {
 		image_t *image = desc->image;
 
 		if (image == NULL)
 			continue;
-		if (fseek(fp, image->toc_e.offset_address, SEEK_SET))
-			log_errx("Failed to set file position");
-
-		xfwrite(image->buffer, image->toc_e.size, fp, filename);
+		iov = add_padding(iov, &iovcnt,
+		    image->toc_e.offset_address - entry_offset);
+		iov = add_iov(iov, &iovcnt, image->buffer, image->toc_e.size);
+		entry_offset = image->toc_e.offset_address + image->toc_e.size;
 	}
+	iov = add_padding(iov, &iovcnt, end_offset - entry_offset);
 
-	fclose(fp);
+	write_iov_to_file(iov, iovcnt, filename);
+	free(iov);
+	free(buf);
 	return 0;
 }
 
@@ -596,6 +850,232 @@ static void update_fip(void)
 	}
 }
 
+static void xfwrite_at(void *buf, size_t size, uint64_t offset, FILE *fp,
+    const char *filename)
+{
+	if (fseek(fp, offset, SEEK_SET))
+		log_errx("Failed to set file position");
+	if (fwrite(buf, 1, size, fp) != size)
+		log_errx("Failed to write %s", filename);
+}
+
+/*
+ * Find the end of the space available to the image at the given offset:
+ * the start of the next image in the file, or the end of the file for the
+ * last image, which is free to grow.
+ */
+static uint64_t get_image_slot_end(uint64_t offset)
+{
+	image_desc_t *desc;
+	uint64_t end = UINT64_MAX;
+
+	for (desc = image_desc_head; desc != NULL; desc = desc->next) {
+		image_t *image = desc->image;
+
+		if (image == NULL)
+			continue;
+		if (image->toc_e.offset_address > offset &&
+		    image->toc_e.offset_address < end)
+			end = image->toc_e.offset_address;
+	}
+	return end;
+}
+
+/*
+ * Find the alignment of the images of an existing FIP file: the largest
+ * power of two all their offsets are a multiple of.
+ */
+static unsigned long get_fip_align(void)
+{
+	image_desc_t *desc;
+	uint64_t offsets = 0;
+
+	for (desc = image_desc_head; desc != NULL; desc = desc->next)
+		if (desc->image != NULL)
+			offsets |= desc->image->toc_e.offset_address;
+	if (offsets == 0)
+		return 1;
+	return (unsigned long)(offsets & -offsets);
+}
+
+/*
+ * Find the space reserved after the images of an existing FIP file packed
+ * with the given alignment, so that a repack after a failed in-place update
+ * keeps room for the next one.
+ *
+ * The space after the last image is the reserved space, unless an update in
+ * place made the last image grow. The space before the next image also
+ * holds the alignment padding, so it only tells that the reserved space was
+ * larger than that space minus the alignment. An update in place can only
+ * shrink these spaces, so the largest of these lower bounds is used.
+ */
+static unsigned long get_fip_reserve(const char *filename,
+    unsigned long align)
+{
+	struct BLD_PLAT_STAT st;
+	image_desc_t *desc;
+	uint64_t reserve = 0;
+
+	if (stat(filename, &st) == -1)
+		log_err("stat %s", filename);
+
+	for (desc = image_desc_head; desc != NULL; desc = desc->next) {
+		image_t *image = desc->image;
+		uint64_t image_end, slot_end, padding = 0;
+
+		if (image == NULL)
+			continue;
+		image_end = image->toc_e.offset_address + image->toc_e.size;
+		slot_end = get_image_slot_end(image->toc_e.offset_address);
+		if (slot_end == UINT64_MAX)
+			slot_end = st.st_size;
+		else
+			padding = align - 1;
+		if (slot_end < image_end + padding)
+			continue;
+		if (slot_end - image_end - padding > reserve)
+			reserve = slot_end - image_end - padding;
+	}
+	return reserve;
+}
+
+/* Free the images read for an in-place update that did not happen. */
+static void free_new_images(image_t **new_images, size_t nr)
+{
+	size_t i;
+
+	for (i = 0; i < nr; i++)
+		free(new_images[i]);
+	free(new_images);
+}
+
+/*
+ * Update the FIP file without repacking it. This only works when every
+ * image to pack replaces an existing one and fits in the space that image
+ * occupies, including any alignment padding or space reserved with
+ * --reserve. Only the ToC and the new payloads are written, and all image
+ * offsets are preserved. Returns -1 without touching the file when the
+ * images do not fit, in which case the caller should repack the FIP.
+ */
+static int update_fip_in_place(const char *filename, uint64_t toc_flags)
+{
+	struct BLD_PLAT_STAT st;
+	image_desc_t *desc;
+	image_t **new_images;
+	fip_toc_header_t *toc_header;
+	fip_toc_entry_t *toc_entry;
+	FILE *fp;
+	char *buf;
+	uint64_t buf_size, end_offset;
+	size_t i, nr_images = 0;
+
+	new_images = xzalloc(nr_image_descs * sizeof(*new_images),
+	    "failed to allocate memory for image table");
+
+	/* Check that all the new images fit before modifying anything. */
+	for (desc = image_desc_head, i = 0; desc != NULL;
+	     desc = desc->next, i++) {
+		uint64_t offset, slot_end;
+		image_t *image;
+
+		if (desc->image != NULL)
+			nr_images++;
+		if (desc->action != DO_PACK)
+			continue;
+
+		if (desc->image == NULL) {
+			if (verbose)
+				log_dbgx("%s is not in %s, cannot add it in place",
+				    desc->cmdline_name, filename);
+			free_new_images(new_images, i);
+			return -1;
+		}
+
+		image = read_image_from_file(&desc->uuid, desc->action_arg);
+		offset = desc->image->toc_e.offset_address;
+		slot_end = get_image_slot_end(offset);
+		if (image->toc_e.size > slot_end - offset) {
+			if (verbose)
+				log_dbgx("%s does not fit in place (0x%llX > 0x%llX bytes)",
+				    desc->action_arg,
+				    (unsigned long long)image->toc_e.size,
+				    (unsigned long long)(slot_end - offset));
+			free(image);
+			free_new_images(new_images, i);
+			return -1;
+		}
+		image->toc_e.offset_address = offset;
+		new_images[i] = image;
+	}
+
+	fp = fopen(filename, "r+b");
+	if (fp == NULL)
+		log_err("fopen %s", filename);
+
+	if (fstat(fileno(fp), &st) == -1)
+		log_err("fstat %s", filename);
+	end_offset = st.st_size;
+
+	/* Write the new payloads, clearing what is left of the old ones. */
+	for (desc = image_desc_head, i = 0; desc != NULL;
+	     desc = desc->next, i++) {
+		image_t *image = new_images[i];
+		uint64_t offset, len;
+
+		if (image == NULL)
+			continue;
+
+		if (verbose)
+			log_dbgx("Replacing %s with %s in place",
+			    desc->cmdline_name, desc->action_arg);
+
+		offset = image->toc_e.offset_address;
+		xfwrite_at(image->buffer, image->toc_e.size, offset, fp,
+		    filename);
+
+		for (len = image->toc_e.size; len < desc->image->toc_e.size;
+		     len += sizeof(pad_buf)) {
+			uint64_t n = desc->image->toc_e.size - len;
+
+			if (n > sizeof(pad_buf))
+				n = sizeof(pad_buf);
+			xfwrite_at(pad_buf, n, offset + len, fp, filename);
+		}
+
+		free(desc->image);
+		desc->image = image;
+		if (offset + image->toc_e.size > end_offset)
+			end_offset = offset + image->toc_e.size;
+	}
+	free(new_images);
+
+	/* Rewrite the ToC, which keeps the same number of entries. */
+	buf_size = sizeof(fip_toc_header_t) +
+	    sizeof(fip_toc_entry_t) * (nr_images + 1);
+	buf = xzalloc(buf_size, "failed to allocate memory for ToC");
+
+	toc_header = (fip_toc_header_t *)buf;
+	toc_header->name = TOC_HEADER_NAME;
+	toc_header->serial_number = TOC_HEADER_SERIAL_NUMBER;
+	toc_header->flags = toc_flags;
+
+	toc_entry = (fip_toc_entry_t *)(toc_header + 1);
+	for (desc = image_desc_head; desc != NULL; desc = desc->next)
+		if (desc->image != NULL)
+			*toc_entry++ = desc->image->toc_e;
+	toc_entry->offset_address = end_offset;
+
+	if (verbose)
+		log_dbgx("Metadata size: %zu bytes", buf_size);
+
+	xfwrite_at(buf, buf_size, 0, fp, filename);
+	free(buf);
+
+	if (fclose(fp) != 0)
+		log_err("fclose %s", filename);
+	return 0;
+}
+
 static void parse_plat_toc_flags(const char *arg, unsigned long long *toc_flags)
 {
 	unsigned long long flags;
@@ -627,6 +1107,19 @@ static unsigned long get_image_align(char *arg)
 	return align;
 }
 
+static unsigned long get_image_reserve(char *arg)
+{
+	char *endptr;
+	unsigned long reserve;
+
+	errno = 0;
+	reserve = strtoul(arg, &endptr, 0);
+	if (*endptr != '\0' || errno != 0)
+		log_errx("Invalid reserve size: %s", arg);
+
+	return reserve;
+}
+
 static void parse_blob_opt(char *arg, uuid_t *uuid, char *filename, size_t len)
 {
 	char *p;
@@ -648,6 +1141,7 @@ static int create_cmd(int argc, char *argv[])
 	size_t nr_opts = 0;
 	unsigned long long toc_flags = 0;
 	unsigned long align = 1;
+	unsigned long reserve = 0;
 
 	if (argc < 2)
 		create_usage();
@@ -656,6 +1150,8 @@ static int create_cmd(int argc, char *argv[])
 	opts = add_opt(opts, &nr_opts, "plat-toc-flags", required_argument,
 	    OPT_PLAT_TOC_FLAGS);
 	opts = add_opt(opts, &nr_opts, "align", required_argument, OPT_ALIGN);
+	opts = add_opt(opts, &nr_opts, "reserve", required_argument,
+	    OPT_RESERVE);
 	opts = add_opt(opts, &nr_opts, "blob", required_argument, 'b');
 	opts = add_opt(opts, &nr_opts, NULL, 0, 0);
 
@@ -680,6 +1176,9 @@ static int create_cmd(int argc, char *argv[])
 		case OPT_ALIGN:
 			align = get_image_align(optarg);
 			break;
+		case OPT_RESERVE:
+			reserve = get_image_reserve(optarg);
+			break;
 		case 'b': {
 			char name[_UUID_STR_LEN + 1];
 			char filename[PATH_MAX] = { 0 };
@@ -715,7 +1214,7 @@ static int create_cmd(int argc, char *argv[])
 
 	update_fip();
 
-	pack_images(argv[0], toc_flags, align);
+	pack_images(argv[0], toc_flags, align, reserve);
 	return 0;
 }
 
@@ -729,6 +1228,7 @@ static void create_usage(void)
 	printf("  --align <value>\t\tEach image is aligned to <value> (default: 1).\n");
 	printf("  --blob uuid=...,file=...\tAdd an image with the given UUID pointed to by file.\n");
 	printf("  --plat-toc-flags <value>\t16-bit platform specific flag field occupying bits 32-47 in 64-bit ToC header.\n");
+	printf("  --reserve <value>\t\tReserve <value> bytes after each image for in-place updates (default: 0).\n");
 	printf("\n");
 	printf("Specific images are packed with the following options:\n");
 	for (; toc_entry->cmdline_name != NULL; toc_entry++)
@@ -745,7 +1245,11 @@ static int update_cmd(int argc, char *argv[])
 	fip_toc_header_t toc_header = { 0 };
 	unsigned long long toc_flags = 0;
 	unsigned long align = 1;
+	unsigned long reserve = 0;
 	int pflag = 0;
+	int aflag = 0;
+	int iflag = 0;
+	int rflag = 0;
 
 	if (argc < 2)
 		update_usage();
@@ -753,9 +1257,12 @@ static int update_cmd(int argc, char *argv[])
 	opts = fill_common_opts(opts, &nr_opts, required_argument);
 	opts = add_opt(opts, &nr_opts, "align", required_argument, OPT_ALIGN);
 	opts = add_opt(opts, &nr_opts, "blob", required_argument, 'b');
+	opts = add_opt(opts, &nr_opts, "in-place", no_argument, OPT_IN_PLACE);
 	opts = add_opt(opts, &nr_opts, "out", required_argument, 'o');
 	opts = add_opt(opts, &nr_opts, "plat-toc-flags", required_argument,
 	    OPT_PLAT_TOC_FLAGS);
+	opts = add_opt(opts, &nr_opts, "reserve", required_argument,
+	    OPT_RESERVE);
 	opts = add_opt(opts, &nr_opts, NULL, 0, 0);
 
 	while (1) {
@@ -801,6 +1308,14 @@ static int update_cmd(int argc, char *argv[])
 		}
 		case OPT_ALIGN:
 			align = get_image_align(optarg);
+			aflag = 1;
+			break;
+		case OPT_IN_PLACE:
+			iflag = 1;
+			break;
+		case OPT_RESERVE:
+			reserve = get_image_reserve(optarg);
+			rflag = 1;
 			break;
 		case 'o':
 			snprintf(outfile, sizeof(outfile), "%s", optarg);
@@ -816,19 +1331,35 @@ static int update_cmd(int argc, char *argv[])
 	if (argc == 0)
 		update_usage();
 
+	if (iflag && outfile[0] != '\0')
+		log_errx("--in-place cannot be used with --out");
+
 	if (outfile[0] == '\0')
 		snprintf(outfile, sizeof(outfile), "%s", argv[0]);
 
 	if (access(argv[0], F_OK) == 0)
 		parse_fip(argv[0], &toc_header);
+	else if (iflag)
+		log_errx("%s must exist to be updated in place", argv[0]);
 
 	if (pflag)
 		toc_header.flags &= ~(0xffffULL << 32);
 	toc_flags = (toc_header.flags |= toc_flags);
 
+	if (iflag) {
+		/* Keep the existing layout unless told otherwise. */
+		if (!aflag)
+			align = get_fip_align();
+		if (!rflag)
+			reserve = get_fip_reserve(outfile, align);
+		if (update_fip_in_place(outfile, toc_flags) == 0)
+			return 0;
+		log_warnx("Images do not fit in %s, repacking it", outfile);
+	}
+
 	update_fip();
 
-	pack_images(outfile, toc_flags, align);
+	pack_images(outfile, toc_flags, align, reserve);
 	return 0;
 }
 
@@ -839,10 +1370,12 @@ static void update_usage(void)
 	printf("fiptool update [opts] FIP_FILENAME\n");
 	printf("\n");
 	printf("Options:\n");
-	printf("  --align <value>\t\tEach image is aligned to <value> (default: 1).\n");
+	printf("  --align <value>\t\tEach image is aligned to <value> (default: 1, or the existing alignment with --in-place).\n");
 	printf("  --blob uuid=...,file=...\tAdd or update an image with the given UUID pointed to by file.\n");
+	printf("  --in-place\t\t\tOnly rewrite the ToC and the updated images if they fit, repack otherwise.\n");
 	printf("  --out FIP_FILENAME\t\tSet an alternative output FIP file.\n");
 	printf("  --plat-toc-flags <value>\t16-bit platform specific flag field occupying bits 32-47 in 64-bit ToC header.\n");
+	printf("  --reserve <value>\t\tReserve <value> bytes after each image when repacking (default: 0, or the space already reserved with --in-place).\n");
 	printf("\n");
 	printf("Specific images are packed with the following options:\n");
 	for (; toc_entry->cmdline_name != NULL; toc_entry++)
@@ -1087,7 +1620,7 @@ static int remove_cmd(int argc, char *argv[])
 		}
 	}
 
-	pack_images(outfile, toc_header.flags, align);
+	pack_images(outfile, toc_header.flags, align, 0);
 	return 0;
 }
 
@@ -1207,5 +1740,6 @@ int main(int argc, char *argv[])
 	if (i == NELEM(cmds))
 		usage();
 	free_image_descs();
+	unmap_files();
 	return ret;
 }
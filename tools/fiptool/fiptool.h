@@ -7,6 +7,8 @@
 #ifndef __FIPTOOL_H__
 #define __FIPTOOL_H__
 
+#include <sys/types.h>
+
 #include <stddef.h>
 #include <stdint.h>
 
@@ -45,6 +47,19 @@ typedef struct image {
 	void                *buffer;
 } image_t;
 
+/*
+ * A file loaded into memory. On Posix hosts the file is mapped read-only
+ * and image buffers point straight into the mapping.
+ */
+typedef struct file_map {
+	void               *addr;
+	size_t              size;
+	int                 mapped;
+	dev_t               dev;
+	ino_t               ino;
+	struct file_map    *next;
+} file_map_t;
+
 typedef struct cmd {
 	char              *name;
 	int              (*handler)(int, char **);
@@ -0,0 +1,133 @@
+#!/bin/sh
+#
+# Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+#
+# SPDX-License-Identifier: BSD-3-Clause
+#
+# This script times the fiptool create, update and info commands on a
+# synthetic FIP made of large images. When a second fiptool is given,
+# both are timed on the same images, so that the two can be compared.
+#
+
+usage() {
+    cat << EOF
+Time fiptool on a synthetic FIP made of large images.
+
+Usage:
+	fiptool_bench.sh [options]
+
+Options:
+	-h,--help: Print this help message and exit
+	-f,--fiptool FIPTOOL: fiptool to time (default: next to this script)
+	-r,--ref FIPTOOL: Reference fiptool to time on the same images
+	-n,--images N: Number of images in the FIP (default: 8)
+	-s,--size MB: Size of each image in MB (default: 256)
+	-i,--iterations N: Number of runs of each command (default: 3)
+	-d,--dir DIR: Directory for the images and the FIP (default: mktemp)
+EOF
+    exit
+}
+
+fiptool="$(dirname $0)/fiptool"
+ref=
+nr_images=8
+size_mb=256
+iterations=3
+dir=
+
+while test $# -gt 0; do
+    case "$1" in
+	-h | --help )
+	    usage ;;
+	-f | --fiptool )
+	    fiptool="$2"
+	    shift 2 ;;
+	-r | --ref )
+	    ref="$2"
+	    shift 2 ;;
+	-n | --images )
+	    nr_images="$2"
+	    shift 2 ;;
+	-s | --size )
+	    size_mb="$2"
+	    shift 2 ;;
+	-i | --iterations )
+	    iterations="$2"
+	    shift 2 ;;
+	-d | --dir )
+	    dir="$2"
+	    shift 2 ;;
+	* )
+	    usage ;;
+    esac
+done
+
+# The images are packed under the first options known to fiptool
+options="tb-fw scp-fw soc-fw tos-fw tos-fw-extra1 tos-fw-extra2 nt-fw \
+rot-cert trusted-key-cert scp-fw-key-cert soc-fw-key-cert tos-fw-key-cert \
+nt-fw-key-cert tb-fw-cert scp-fw-cert soc-fw-cert tos-fw-cert nt-fw-cert"
+max_images=$(echo $options | wc -w)
+if test "$nr_images" -lt 1 || test "$nr_images" -gt "$max_images"; then
+    echo "The number of images must be between 1 and $max_images" >&2
+    exit 1
+fi
+
+if test -z "$dir"; then
+    dir=$(mktemp -d) || exit 1
+    trap 'rm -rf "$dir"' EXIT
+fi
+
+echo "Creating $nr_images images of $size_mb MB in $dir"
+image_args=
+update_arg=
+i=0
+for opt in $options; do
+    test $i -eq $nr_images && break
+    dd if=/dev/urandom of="$dir/image$i.bin" bs=1M count="$size_mb" \
+	2> /dev/null || exit 1
+    image_args="$image_args --$opt $dir/image$i.bin"
+    # The update replaces the last image with a small one
+    update_arg="--$opt $dir/small.bin"
+    i=$((i + 1))
+done
+dd if=/dev/urandom of="$dir/small.bin" bs=1K count=64 2> /dev/null || exit 1
+
+now() {
+    date +%s.%N
+}
+
+# Print the average time of the given fiptool command over the iterations
+time_cmd() {
+    name="$1"
+    shift
+    total=0
+    i=0
+    while test $i -lt $iterations; do
+	start=$(now)
+	if ! "$@" > /dev/null 2>&1; then
+	    echo "$name failed: $*" >&2
+	    exit 1
+	fi
+	end=$(now)
+	total=$(awk "BEGIN { printf \"%.6f\", $total + $end - $start }")
+	i=$((i + 1))
+    done
+    awk "BEGIN { printf \"  %-12s %8.3f s\\n\", \"$name\", $total / $iterations }"
+}
+
+bench() {
+    tool="$1"
+    fip="$dir/fip.bin"
+
+    echo "$tool:"
+    time_cmd create "$tool" create $image_args "$fip"
+    time_cmd update "$tool" update $update_arg "$fip"
+    time_cmd info "$tool" info "$fip"
+    time_cmd "info -v" "$tool" --verbose info "$fip"
+    rm -f "$fip"
+}
+
+bench "$fiptool"
+if test -n "$ref"; then
+    bench "$ref"
+fi
@@ -14,8 +14,12 @@
 #	ifndef _MSC_VER
 
 		/* Not Visual Studio, so include Posix Headers. */
+#		include <sys/mman.h>
+#		include <sys/uio.h>
+#		include <fcntl.h>
 #		include <getopt.h>
 #		include <openssl/sha.h>
+#		include <pthread.h>
 #		include <unistd.h>
 
 #		define  BLD_PLAT_STAT stat
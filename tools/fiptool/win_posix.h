@@ -54,6 +54,12 @@
 /* Define flag values for _access. */
 #	define F_OK	0
 
+/* Scatter/gather element, as used by writev() on Posix platforms. */
+struct iovec {
+	void	*iov_base;
+	size_t	iov_len;
+};
+
 
 /* getopt implementation for Windows: Data. */
 